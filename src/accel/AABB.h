@@ -3,6 +3,7 @@
 #include "core/Ray.h"
 #include <iostream>
 #include <atomic>
+#include <algorithm>
 
 /**
  * Axis-Aligned Bounding Box
@@ -15,6 +16,16 @@ struct AABB {
     AABB() = default;
     AABB(const Vec3& minCorner, const Vec3& maxCorner) : min(minCorner), max(maxCorner) {}
 
+    // Inverted box that any surroundingBox() call will replace
+    static AABB empty() {
+        return AABB{Vec3{INFINITY}, Vec3{-INFINITY}};
+    }
+
+    float surfaceArea() const {
+        Vec3 extent = max - min;
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
     bool hit(const Ray& ray, float tMin, float tMax) const {
         constexpr float EPS = 1e-5f;
 
@@ -43,6 +54,26 @@ struct AABB {
         return true;
     }
 
+    // Branchless slab test using the ray's precomputed inverse direction
+    bool hit(const TraversalRay& ray, float tMin, float tMax) const {
+        float tEntry;
+        return hit(ray, tMin, tMax, tEntry);
+    }
+
+    // Also reports where the ray enters the box (clamped to tMin), for front-to-back ordering
+    bool hit(const TraversalRay& ray, float tMin, float tMax, float& tEntry) const {
+        const Vec3& o = ray.ray.origin;
+        const Vec3& inv = ray.invDirection;
+
+        float tx0 = (min.x - o.x) * inv.x, tx1 = (max.x - o.x) * inv.x;
+        float ty0 = (min.y - o.y) * inv.y, ty1 = (max.y - o.y) * inv.y;
+        float tz0 = (min.z - o.z) * inv.z, tz1 = (max.z - o.z) * inv.z;
+
+        float tNear = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), tMin));
+        float tFar = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), tMax));
+        tEntry = tNear;
+        return tNear <= tFar;
+    }
 };
 
 static AABB surroundingBox(const AABB& box0, const AABB& box1) {
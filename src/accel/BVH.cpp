@@ -1,64 +1,453 @@
 #include "accel/BVH.h"
+#include "renderer/PagedGeometry.h"
 #include "renderer/Scene.h"
+#include "renderer/SceneObject.h"
+#include "util/Parallel.h"
 #include <memory>
 #include <stack>
 #include <iostream>
 #include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
 
-void BVHTree::build(const Scene& scene) {
-    const auto& primitives = scene.getPrimitives();
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
 
-    size_t n = primitives.size();
-    if (n == 0) return;
+static constexpr int MaxBins = 32;
+
+// Ranges at least this large are binned and partitioned by every build thread
+static constexpr size_t MinParallelRange = 1 << 14;
+
+template <typename Geometry>
+void BVHTree::build(const Geometry& scene, const BVHBuildOptions& options) {
+    options_ = options;
+    options_.binCount = std::clamp(options.binCount, 2, MaxBins);
+    options_.maxLeafSize = std::clamp(options.maxLeafSize, 1, 255);
+    int threads = resolveThreadCount(options.threadCount);
 
     nodes_.clear();
-    nodes_.reserve(n * 2);
+    primitiveIndices_.clear();
+    rootIndex_ = InvalidNode;
 
-    // Precompute primitive AABBs
-    std::vector<BVHBuildEntry> entries;
-    entries.reserve(n);
+    size_t n = scene.primitiveCount();
+    if (n == 0) return;
 
-    for (size_t i = 0; i < n; ++i) {
-        const auto& prim = primitives[i];
+    // Precompute primitive AABBs
+    std::vector<BVHBuildEntry> entries(n);
+    std::vector<BVHBuildEntry> scratch(n); // Partition buffer, indexed like entries so disjoint ranges can share it
+    parallelChunks(n, threads, [&](int, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            AABB box = scene.primitiveBounds(static_cast<int>(i));
+            Point3 centroid = (box.min + box.max) * 0.5f;
 
-        AABB box;
-        switch (prim.type) {
-            case Scene::PrimitiveType::Sphere:
-                box = sphereBounds(scene.getSpheres()[prim.index]);
+            entries[i] = {static_cast<int>(i), box, centroid};
         }
-        Point3 centroid = (box.min + box.max) * 0.5f;
-        
-        entries.push_back({static_cast<int>(i), box, centroid});
-    }
+    });
     
-    rootIndex_ = buildTree(entries, 0, n);
+    rootIndex_ = 0;
+    if (options_.method == BVHBuildMethod::LBVH) {
+        buildLinear(entries, scratch, threads);
+    } else if (threads > 1 && n >= MinParallelRange) {
+        buildParallel(entries, scratch, threads);
+    } else {
+        nodes_.reserve(2 * n);
+        nodes_.emplace_back();
+        buildTree(nodes_, entries, scratch, rootIndex_, 0, n);
+    }
+
+    primitiveIndices_.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        primitiveIndices_[i] = entries[i].primitiveIndex;
+
+    builtSahCost_ = sahCost();
 }
 
-int BVHTree::buildTree(
+void BVHTree::buildTree(
+    std::vector<BVHNode>& nodes,
     std::vector<BVHBuildEntry>& entries,
+    std::vector<BVHBuildEntry>& scratch,
+    int nodeIndex,
     size_t start,
-    size_t end)
+    size_t end) const
 {
-    int index = static_cast<int>(nodes_.size());
-    nodes_.emplace_back();
+    AABB bounds = rangeBounds(entries, start, end, false, 1);
 
-    size_t n = end - start;
-    
-    if (n == 1) {
-        nodes_[index].left = InvalidNode;
-        nodes_[index].right = InvalidNode;
-        nodes_[index].primitiveIndex = entries[start].primitiveIndex;
-        nodes_[index].box = entries[start].box;
+    size_t mid = start;
+    int axis = 0;
+    if (end - start > 1) {
+        mid = options_.method == BVHBuildMethod::SAH
+            ? splitSAH(entries, scratch, start, end, bounds, axis)
+            : splitMedian(entries, start, end, bounds, axis);
+    }
+
+    if (mid == start) {
+        nodes[nodeIndex].box = bounds;
+        nodes[nodeIndex].offset = static_cast<int>(start);
+        nodes[nodeIndex].primitiveCount = static_cast<uint16_t>(end - start);
+        nodes[nodeIndex].axis = 0;
+        return;
+    }
+
+    // Allocate both children together so the right child is always left + 1
+    int left = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+    nodes.emplace_back();
+
+    nodes[nodeIndex].box = bounds;
+    nodes[nodeIndex].offset = left;
+    nodes[nodeIndex].primitiveCount = 0;
+    nodes[nodeIndex].axis = static_cast<uint8_t>(axis);
+
+    buildTree(nodes, entries, scratch, left, start, mid);
+    buildTree(nodes, entries, scratch, left + 1, mid, end);
+}
+
+void BVHTree::buildParallel(
+    std::vector<BVHBuildEntry>& entries,
+    std::vector<BVHBuildEntry>& scratch,
+    int threads)
+{
+    // Top levels are split in the same order buildTree would, stopping at ranges small enough to be tasks
+    std::vector<BuildTopNode> top;
+    std::vector<BuildSubtree> subtrees;
+    size_t taskSize = std::max<size_t>(entries.size() / (threads * 16), 256);
+
+    auto splitTop = [&](auto& self, size_t start, size_t end) -> int {
+        int index = static_cast<int>(top.size());
+        top.emplace_back();
+
+        if (end - start > taskSize) {
+            int rangeThreads = end - start >= MinParallelRange ? threads : 1;
+            AABB bounds = rangeBounds(entries, start, end, false, rangeThreads);
+
+            int axis = 0;
+            size_t mid = options_.method == BVHBuildMethod::SAH
+                ? splitSAH(entries, scratch, start, end, bounds, axis, rangeThreads)
+                : splitMedian(entries, start, end, bounds, axis);
+
+            if (mid != start) {
+                top[index].box = bounds;
+                top[index].axis = axis;
+                int left = self(self, start, mid);
+                int right = self(self, mid, end);
+                top[index].left = left;
+                top[index].right = right;
+                return index;
+            }
+        }
+
+        top[index].subtree = static_cast<int>(subtrees.size());
+        subtrees.push_back({start, end, {}});
         return index;
+    };
+    splitTop(splitTop, 0, entries.size());
+
+    parallelTasks(subtrees.size(), threads, [&](size_t i) {
+        BuildSubtree& subtree = subtrees[i];
+        subtree.nodes.reserve(2 * (subtree.end - subtree.start));
+        subtree.nodes.emplace_back();
+        buildTree(subtree.nodes, entries, scratch, 0, subtree.start, subtree.end);
+    });
+
+    assembleSubtrees(top, subtrees, threads);
+}
+
+void BVHTree::assembleSubtrees(
+    const std::vector<BuildTopNode>& top,
+    std::vector<BuildSubtree>& subtrees,
+    int threads)
+{
+    // Assign final indices exactly as the serial depth-first allocation would
+    size_t total = 1;
+    for (const BuildTopNode& node : top)
+        if (node.subtree == InvalidNode) total += 2;
+    for (const BuildSubtree& subtree : subtrees)
+        total += subtree.nodes.size() - 1;
+    nodes_.resize(total);
+
+    int next = 1;
+    auto place = [&](auto& self, int topIndex, int slot) -> void {
+        const BuildTopNode& node = top[topIndex];
+        if (node.subtree != InvalidNode) {
+            BuildSubtree& subtree = subtrees[node.subtree];
+            subtree.slot = slot;
+            subtree.base = next;
+            next += static_cast<int>(subtree.nodes.size()) - 1;
+            return;
+        }
+
+        int left = next;
+        next += 2;
+        nodes_[slot].box = node.box;
+        nodes_[slot].offset = left;
+        nodes_[slot].primitiveCount = 0;
+        nodes_[slot].axis = static_cast<uint8_t>(node.axis);
+        self(self, node.left, left);
+        self(self, node.right, left + 1);
+    };
+    place(place, 0, rootIndex_);
+
+    // Copy every subtree into its preallocated range, relocating child offsets
+    parallelTasks(subtrees.size(), threads, [&](size_t i) {
+        const BuildSubtree& subtree = subtrees[i];
+        for (size_t j = 0; j < subtree.nodes.size(); ++j) {
+            BVHNode node = subtree.nodes[j];
+            if (!node.isLeaf())
+                node.offset = subtree.base + node.offset - 1;
+            nodes_[j == 0 ? subtree.slot : subtree.base + j - 1] = node;
+        }
+    });
+}
+
+// Spreads the low 10 (or 21) bits of v so there are two zero bits between each
+static uint64_t expandBits30(uint64_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+static uint64_t expandBits63(uint64_t v) {
+    v &= 0x1FFFFF;
+    v = (v | v << 32) & 0x1F00000000FFFFull;
+    v = (v | v << 16) & 0x1F0000FF0000FFull;
+    v = (v | v << 8)  & 0x100F00F00F00F00Full;
+    v = (v | v << 4)  & 0x10C30C30C30C30C3ull;
+    v = (v | v << 2)  & 0x1249249249249249ull;
+    return v;
+}
+
+// Finds the split of a sorted Morton range at its highest differing bit. Returns start to signal identical codes
+static size_t mortonSplit(const std::vector<uint64_t>& codes, size_t start, size_t end, int& axis) {
+    uint64_t first = codes[start];
+    uint64_t last = codes[end - 1];
+    if (first == last) return start;
+
+    int common = std::countl_zero(first ^ last);
+    int bit = 63 - common;
+    axis = 2 - bit % 3; // x occupies bit 3i + 2, y 3i + 1, z 3i
+
+    // Binary search for the last code that still has a 0 at that bit
+    size_t split = start;
+    size_t step = end - 1 - start;
+    do {
+        step = (step + 1) >> 1;
+        size_t candidate = split + step;
+        if (candidate < end - 1 && std::countl_zero(first ^ codes[candidate]) > common)
+            split = candidate;
+    } while (step > 1);
+
+    return split + 1;
+}
+
+void BVHTree::buildLinear(
+    std::vector<BVHBuildEntry>& entries,
+    std::vector<BVHBuildEntry>& scratch,
+    int threads)
+{
+    size_t n = entries.size();
+
+    // Quantize centroids to a grid over the centroid bounds. 10 bits per axis is plenty below ~1M primitives
+    AABB centroidBounds = rangeBounds(entries, 0, n, true, threads);
+    int bitsPerAxis = n < (size_t{1} << 20) ? 10 : 21;
+    float gridMax = static_cast<float>((1u << bitsPerAxis) - 1);
+    Vec3 scale;
+    for (int a = 0; a < 3; ++a) {
+        float extent = centroidBounds.max[a] - centroidBounds.min[a];
+        scale[a] = extent > 0.0f ? gridMax / extent : 0.0f;
     }
 
-    // Compute bounds
-    AABB bounds = entries[start].box;
-    for (size_t i = start + 1; i < end; ++i)
-        bounds = surroundingBox(bounds, entries[i].box);
+    std::vector<uint64_t> codes(n);
+    std::vector<uint32_t> order(n);
+    parallelChunks(n, threads, [&](int, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Vec3 cell = (entries[i].centroid - centroidBounds.min) * scale;
+            auto expand = bitsPerAxis == 10 ? expandBits30 : expandBits63;
+            codes[i] = (expand(static_cast<uint64_t>(cell.x)) << 2)
+                     | (expand(static_cast<uint64_t>(cell.y)) << 1)
+                     |  expand(static_cast<uint64_t>(cell.z));
+            order[i] = static_cast<uint32_t>(i);
+        }
+    });
 
-    Vec3 extent = bounds.max - bounds.min;
+    radixSort(codes, order, 3 * bitsPerAxis, threads);
+
+    parallelChunks(n, threads, [&](int, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            scratch[i] = entries[order[i]];
+    });
+    entries.swap(scratch);
+
+    // Emit the hierarchy from the sorted codes. Top splits are serial binary searches, subtrees are tasks
+    std::vector<BuildTopNode> top;
+    std::vector<BuildSubtree> subtrees;
+    size_t taskSize = std::max<size_t>(n / (threads * 16), 256);
+
+    auto splitTop = [&](auto& self, size_t start, size_t end) -> int {
+        int index = static_cast<int>(top.size());
+        top.emplace_back();
+
+        int axis = 0;
+        size_t mid = end - start > taskSize ? mortonSplit(codes, start, end, axis) : start;
+        if (mid == start) {
+            top[index].subtree = static_cast<int>(subtrees.size());
+            subtrees.push_back({start, end, {}});
+            return index;
+        }
+
+        top[index].axis = axis;
+        int left = self(self, start, mid);
+        int right = self(self, mid, end);
+        top[index].left = left;
+        top[index].right = right;
+        return index;
+    };
+    splitTop(splitTop, 0, n);
+
+    parallelTasks(subtrees.size(), threads, [&](size_t i) {
+        BuildSubtree& subtree = subtrees[i];
+        subtree.nodes.reserve(2 * (subtree.end - subtree.start) / options_.maxLeafSize + 1);
+        subtree.nodes.emplace_back();
+        buildLinearTree(subtree.nodes, entries, codes, 0, subtree.start, subtree.end);
+    });
+
+    // Top nodes were created parent first, so a reverse sweep sees children before parents
+    for (int i = static_cast<int>(top.size()) - 1; i >= 0; --i) {
+        BuildTopNode& node = top[i];
+        if (node.subtree != InvalidNode)
+            node.box = subtrees[node.subtree].nodes[0].box;
+        else
+            node.box = surroundingBox(top[node.left].box, top[node.right].box);
+    }
+
+    assembleSubtrees(top, subtrees, threads);
+}
+
+AABB BVHTree::buildLinearTree(
+    std::vector<BVHNode>& nodes,
+    const std::vector<BVHBuildEntry>& entries,
+    const std::vector<uint64_t>& codes,
+    int nodeIndex,
+    size_t start,
+    size_t end) const
+{
     int axis = 0;
+    size_t mid = start;
+    if (end - start > static_cast<size_t>(options_.maxLeafSize)) {
+        mid = mortonSplit(codes, start, end, axis);
+        if (mid == start) mid = start + (end - start) / 2; // Identical codes: split by count
+    }
+
+    if (mid == start) {
+        AABB bounds = rangeBounds(entries, start, end, false, 1);
+        nodes[nodeIndex].box = bounds;
+        nodes[nodeIndex].offset = static_cast<int>(start);
+        nodes[nodeIndex].primitiveCount = static_cast<uint16_t>(end - start);
+        nodes[nodeIndex].axis = 0;
+        return bounds;
+    }
+
+    int left = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+    nodes.emplace_back();
+
+    // Bounds are gathered bottom-up, so each primitive box is read once
+    AABB leftBox = buildLinearTree(nodes, entries, codes, left, start, mid);
+    AABB rightBox = buildLinearTree(nodes, entries, codes, left + 1, mid, end);
+
+    AABB bounds = surroundingBox(leftBox, rightBox);
+    nodes[nodeIndex].box = bounds;
+    nodes[nodeIndex].offset = left;
+    nodes[nodeIndex].primitiveCount = 0;
+    nodes[nodeIndex].axis = static_cast<uint8_t>(axis);
+    return bounds;
+}
+
+void BVHTree::radixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int bits, int threads) {
+    constexpr int DigitBits = 8;
+    constexpr int Buckets = 1 << DigitBits;
+
+    size_t n = keys.size();
+    std::vector<uint64_t> keysOut(n);
+    std::vector<uint32_t> valuesOut(n);
+    std::vector<size_t> offsets(static_cast<size_t>(threads) * Buckets);
+
+    // Least significant digit first. Each pass is stable, and chunk c writes after chunks < c within a bucket
+    for (int shift = 0; shift < bits; shift += DigitBits) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        parallelChunks(n, threads, [&](int chunk, size_t begin, size_t end) {
+            size_t* histogram = &offsets[static_cast<size_t>(chunk) * Buckets];
+            for (size_t i = begin; i < end; ++i)
+                histogram[(keys[i] >> shift) & (Buckets - 1)]++;
+        });
+
+        size_t sum = 0;
+        for (int bucket = 0; bucket < Buckets; ++bucket) {
+            for (int chunk = 0; chunk < threads; ++chunk) {
+                size_t& slot = offsets[static_cast<size_t>(chunk) * Buckets + bucket];
+                size_t count = slot;
+                slot = sum;
+                sum += count;
+            }
+        }
+
+        parallelChunks(n, threads, [&](int chunk, size_t begin, size_t end) {
+            size_t* next = &offsets[static_cast<size_t>(chunk) * Buckets];
+            for (size_t i = begin; i < end; ++i) {
+                size_t dest = next[(keys[i] >> shift) & (Buckets - 1)]++;
+                keysOut[dest] = keys[i];
+                valuesOut[dest] = values[i];
+            }
+        });
+
+        keys.swap(keysOut);
+        values.swap(valuesOut);
+    }
+}
+
+AABB BVHTree::rangeBounds(
+    const std::vector<BVHBuildEntry>& entries,
+    size_t start,
+    size_t end,
+    bool centroids,
+    int threads)
+{
+    auto boundChunk = [&](size_t begin, size_t finish) {
+        AABB box = AABB::empty();
+        for (size_t i = begin; i < finish; ++i) {
+            box = centroids
+                ? surroundingBox(box, AABB{entries[i].centroid, entries[i].centroid})
+                : surroundingBox(box, entries[i].box);
+        }
+        return box;
+    };
+    if (threads <= 1) return boundChunk(start, end);
+
+    std::vector<AABB> partial(threads, AABB::empty());
+    parallelChunks(end - start, threads, [&](int chunk, size_t begin, size_t finish) {
+        partial[chunk] = boundChunk(start + begin, start + finish);
+    });
+
+    AABB bounds = AABB::empty();
+    for (const AABB& box : partial)
+        bounds = surroundingBox(bounds, box);
+    return bounds;
+}
+
+size_t BVHTree::splitMedian(
+    std::vector<BVHBuildEntry>& entries,
+    size_t start,
+    size_t end,
+    const AABB& bounds,
+    int& axis) const
+{
+    if (end - start <= static_cast<size_t>(options_.maxLeafSize)) return start;
+
+    Vec3 extent = bounds.max - bounds.min;
+    axis = 0;
     if (extent.y > extent.x) axis = 1;
     if (extent.z > extent[axis]) axis = 2;
 
@@ -70,61 +459,398 @@ int BVHTree::buildTree(
         }
     );
 
-    size_t mid = start + n / 2;
+    return start + (end - start) / 2;
+}
 
-    nodes_[index].left = buildTree(entries, start, mid);
-    nodes_[index].right = buildTree(entries, mid, end);
-    nodes_[index].primitiveIndex = InvalidNode;
-    nodes_[index].box = surroundingBox(
-        nodes_[nodes_[index].left].box, 
-        nodes_[nodes_[index].right].box
-    );
+size_t BVHTree::splitSAH(
+    std::vector<BVHBuildEntry>& entries,
+    std::vector<BVHBuildEntry>& scratch,
+    size_t start,
+    size_t end,
+    const AABB& bounds,
+    int& axis,
+    int threads) const
+{
+    struct Bin {
+        AABB box;
+        int count;
+    };
+
+    // Bin over centroid bounds rather than primitive bounds so large primitives don't squash the bins
+    AABB centroidBounds = rangeBounds(entries, start, end, true, threads);
+
+    const int binCount = options_.binCount;
+    Vec3 cmin = centroidBounds.min;
+    Vec3 scale;
+    for (int a = 0; a < 3; ++a) {
+        float extent = centroidBounds.max[a] - cmin[a];
+        scale[a] = extent > 0.0f ? binCount / extent : 0.0f;
+    }
+    auto binOf = [&](const BVHBuildEntry& e, int a) {
+        return std::min(binCount - 1, static_cast<int>((e.centroid[a] - cmin[a]) * scale[a]));
+    };
+
+    Bin bins[3][MaxBins];
+    for (auto& axisBins : bins)
+        std::fill_n(axisBins, binCount, Bin{AABB::empty(), 0});
 
-    return index;
+    auto binRange = [&](Bin (*target)[MaxBins], size_t begin, size_t finish) {
+        for (int a = 0; a < 3; ++a) {
+            if (scale[a] == 0.0f) continue; // All centroids share this coordinate
+            for (size_t i = begin; i < finish; ++i) {
+                Bin& bin = target[a][binOf(entries[i], a)];
+                bin.count++;
+                bin.box = surroundingBox(bin.box, entries[i].box);
+            }
+        }
+    };
+
+    if (threads <= 1) {
+        binRange(bins, start, end);
+    } else {
+        // Every chunk bins separately, then chunks are merged. Min/max and integer sums are order independent
+        std::vector<Bin> chunkBins(static_cast<size_t>(threads) * 3 * MaxBins, Bin{AABB::empty(), 0});
+        parallelChunks(end - start, threads, [&](int chunk, size_t begin, size_t finish) {
+            auto target = reinterpret_cast<Bin (*)[MaxBins]>(&chunkBins[static_cast<size_t>(chunk) * 3 * MaxBins]);
+            binRange(target, start + begin, start + finish);
+        });
+
+        for (int chunk = 0; chunk < threads; ++chunk) {
+            for (int a = 0; a < 3; ++a) {
+                const Bin* partial = &chunkBins[(static_cast<size_t>(chunk) * 3 + a) * MaxBins];
+                for (int b = 0; b < binCount; ++b) {
+                    bins[a][b].count += partial[b].count;
+                    bins[a][b].box = surroundingBox(bins[a][b].box, partial[b].box);
+                }
+            }
+        }
+    }
+
+    float bestCost = INFINITY;
+    int bestAxis = -1;
+    int bestSplit = 0; // Bins [0, bestSplit] go left
+
+    for (int a = 0; a < 3; ++a) {
+        if (scale[a] == 0.0f) continue;
+
+        // Sweep from the right to get area * count of every right-hand side, then from the left
+        float rightCost[MaxBins];
+        AABB rightBox = AABB::empty();
+        int rightCount = 0;
+        for (int b = binCount - 1; b > 0; --b) {
+            rightBox = surroundingBox(rightBox, bins[a][b].box);
+            rightCount += bins[a][b].count;
+            rightCost[b - 1] = rightCount > 0 ? rightBox.surfaceArea() * rightCount : 0.0f;
+        }
+
+        AABB leftBox = AABB::empty();
+        int leftCount = 0;
+        for (int b = 0; b < binCount - 1; ++b) {
+            leftBox = surroundingBox(leftBox, bins[a][b].box);
+            leftCount += bins[a][b].count;
+            if (leftCount == 0 || leftCount == static_cast<int>(end - start)) continue;
+
+            float cost = leftBox.surfaceArea() * leftCount + rightCost[b];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = a;
+                bestSplit = b;
+            }
+        }
+    }
+
+    size_t n = end - start;
+    bool fitsInLeaf = n <= static_cast<size_t>(options_.maxLeafSize);
+
+    // Degenerate centroids can't be separated spatially
+    if (bestAxis < 0)
+        return fitsInLeaf ? start : splitMedian(entries, start, end, bounds, axis);
+
+    // Stop when testing every primitive here is cheaper than descending
+    float leafCost = options_.intersectionCost * n;
+    float splitCost = options_.traversalCost + options_.intersectionCost * bestCost / bounds.surfaceArea();
+    if (fitsInLeaf && leafCost <= splitCost)
+        return start;
+
+    axis = bestAxis;
+    auto goesLeft = [&](const BVHBuildEntry& e) { return binOf(e, bestAxis) <= bestSplit; };
+
+    // Stable partition, so the parallel and serial builds produce the same order.
+    // Left entries compact in place, right entries go through scratch
+    if (threads <= 1) {
+        size_t left = start, right = start;
+        for (size_t i = start; i < end; ++i) {
+            if (goesLeft(entries[i])) entries[left++] = entries[i];
+            else scratch[right++] = entries[i];
+        }
+        std::copy(scratch.begin() + start, scratch.begin() + right, entries.begin() + left);
+        return left;
+    }
+
+    std::vector<size_t> leftCounts(threads, 0);
+    parallelChunks(n, threads, [&](int chunk, size_t begin, size_t finish) {
+        for (size_t i = start + begin; i < start + finish; ++i)
+            leftCounts[chunk] += goesLeft(entries[i]);
+    });
+
+    std::vector<size_t> leftOffsets(threads), rightOffsets(threads);
+    size_t totalLeft = 0;
+    for (int chunk = 0; chunk < threads; ++chunk) {
+        leftOffsets[chunk] = totalLeft;
+        totalLeft += leftCounts[chunk];
+    }
+    size_t rightStart = totalLeft;
+    for (int chunk = 0; chunk < threads; ++chunk) {
+        rightOffsets[chunk] = rightStart;
+        rightStart += (n * (chunk + 1) / threads - n * chunk / threads) - leftCounts[chunk];
+    }
+
+    parallelChunks(n, threads, [&](int chunk, size_t begin, size_t finish) {
+        size_t l = start + leftOffsets[chunk], r = start + rightOffsets[chunk];
+        for (size_t i = start + begin; i < start + finish; ++i)
+            scratch[goesLeft(entries[i]) ? l++ : r++] = entries[i];
+    });
+    parallelChunks(n, threads, [&](int, size_t begin, size_t finish) {
+        std::copy(scratch.begin() + start + begin, scratch.begin() + start + finish, entries.begin() + start + begin);
+    });
+
+    return start + totalLeft;
 }
 
+template <typename Geometry>
 bool BVHTree::hit(
-    const Scene& scene,
+    const Geometry& scene,
     HitRecord& record,
     const Ray& ray,
     float tMin,
     float tMax
+) const {
+    return hit(scene, record, TraversalRay{ray}, tMin, tMax);
+}
+
+template <typename Geometry>
+bool BVHTree::hit(
+    const Geometry& scene,
+    HitRecord& record,
+    const TraversalRay& ray,
+    float tMin,
+    float tMax,
+    TraversalStats* stats
+) const {
+    PrimitiveHit closest{tMax};
+    if (!closestHit(scene, closest, ray, tMin, stats)) return false;
+
+    scene.finalizeHit(closest, record, ray.ray);
+    return true;
+}
+
+template <typename Geometry>
+bool BVHTree::closestHit(
+    const Geometry& scene,
+    PrimitiveHit& closest,
+    const TraversalRay& ray,
+    float tMin,
+    TraversalStats* stats
 ) const {
     if (rootIndex_ < 0) return false;
+    return closestHitFrom(scene, closest, ray, tMin, rootIndex_, stats);
+}
+
+template <typename Geometry>
+bool BVHTree::closestHitFrom(
+    const Geometry& scene,
+    PrimitiveHit& closest,
+    const TraversalRay& ray,
+    float tMin,
+    int nodeIndex,
+    TraversalStats* stats
+) const {
+    struct StackEntry {
+        int node;
+        float tEntry; // Where the ray enters the node's box
+    };
 
     bool hitAnything = false;
-    float closest = tMax;
 
-    int stack[64]; // Tree with 64 levels could hold 2^64 leaf nodes = 1.8x10^19 objects
+    float rootEntry;
+    if (stats) stats->nodesVisited++;
+    if (!nodes_[nodeIndex].box.hit(ray, tMin, closest.t, rootEntry)) return false;
+
+    StackEntry stack[64]; // Tree with 64 levels could hold 2^64 leaf nodes = 1.8x10^19 objects
     int stackPtr = 0; // Next available spot
-    stack[stackPtr++] = rootIndex_;
+    stack[stackPtr++] = {nodeIndex, rootEntry};
 
-    // Traverse tree until primitive hitbox is found
+    // Nodes are pushed only after their box was hit, nearest child on top
     while (stackPtr > 0) {
-        int nodeIndex = stack[--stackPtr];
+        StackEntry entry = stack[--stackPtr];
+        if (entry.tEntry > closest.t) continue; // A closer hit was found after this node was pushed
 
-        const BVHNode& node = nodes_[nodeIndex];
-        const auto& prim = scene.getPrimitives()[node.primitiveIndex];
-
-        if (!node.box.hit(ray, tMin, closest)) continue;
+        const BVHNode& node = nodes_[entry.node];
 
         if (node.isLeaf()) {
-            switch (prim.type) {
-                case Scene::PrimitiveType::Sphere: 
-                    if (sphereHit(scene.getSpheres()[prim.index], record, ray, tMin, closest)) {
-                        hitAnything = true;
-                        closest = record.t;
-                    }
+            if (stats) stats->primitivesTested += node.primitiveCount;
+            if (scene.hitLeaf(primitiveIndices_.data(), node.offset, node.primitiveCount, ray.ray, tMin, closest))
+                hitAnything = true;
+            continue;
+        }
+
+        int near = node.left();
+        int far = node.right();
+        float tNear, tFar;
+        bool hitNear = nodes_[near].box.hit(ray, tMin, closest.t, tNear);
+        bool hitFar = nodes_[far].box.hit(ray, tMin, closest.t, tFar);
+        if (stats) stats->nodesVisited += 2;
+
+        // Order by entry distance. Rays starting inside both boxes tie at tMin, so fall back to the split axis:
+        // left holds the smaller centroids and is nearer when the ray runs in +axis
+        if (tFar < tNear || (tFar == tNear && ray.sign[node.axis])) {
+            std::swap(near, far);
+            std::swap(tNear, tFar);
+            std::swap(hitNear, hitFar);
+        }
+
+        if (hitFar) stack[stackPtr++] = {far, tFar};
+        if (hitNear) stack[stackPtr++] = {near, tNear};
+    }
+
+    return hitAnything;
+}
+
+// Slab test of one box against every lane of a packet, each lane clipped to [tMin, tMax[lane]]. Returns the hit mask
+static int packetHitsBox(const AABB& box, const RayPacket& packet, float tMin, const float* tMax) {
+#if defined(__AVX__)
+    __m256 tx0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.min.x), _mm256_load_ps(packet.originX)), _mm256_load_ps(packet.invDirX));
+    __m256 tx1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.max.x), _mm256_load_ps(packet.originX)), _mm256_load_ps(packet.invDirX));
+    __m256 ty0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.min.y), _mm256_load_ps(packet.originY)), _mm256_load_ps(packet.invDirY));
+    __m256 ty1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.max.y), _mm256_load_ps(packet.originY)), _mm256_load_ps(packet.invDirY));
+    __m256 tz0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.min.z), _mm256_load_ps(packet.originZ)), _mm256_load_ps(packet.invDirZ));
+    __m256 tz1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box.max.z), _mm256_load_ps(packet.originZ)), _mm256_load_ps(packet.invDirZ));
+
+    __m256 tNear = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(tx0, tx1), _mm256_min_ps(ty0, ty1)),
+                                 _mm256_max_ps(_mm256_min_ps(tz0, tz1), _mm256_set1_ps(tMin)));
+    __m256 tFar = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(tx0, tx1), _mm256_max_ps(ty0, ty1)),
+                                _mm256_min_ps(_mm256_max_ps(tz0, tz1), _mm256_load_ps(tMax)));
+    return _mm256_movemask_ps(_mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ));
+#else
+    int mask = 0;
+    for (int lane = 0; lane < RayPacket::Size; ++lane) {
+        float tx0 = (box.min.x - packet.originX[lane]) * packet.invDirX[lane], tx1 = (box.max.x - packet.originX[lane]) * packet.invDirX[lane];
+        float ty0 = (box.min.y - packet.originY[lane]) * packet.invDirY[lane], ty1 = (box.max.y - packet.originY[lane]) * packet.invDirY[lane];
+        float tz0 = (box.min.z - packet.originZ[lane]) * packet.invDirZ[lane], tz1 = (box.max.z - packet.originZ[lane]) * packet.invDirZ[lane];
+        float tNear = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), tMin));
+        float tFar = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), tMax[lane]));
+        if (tNear <= tFar) mask |= 1 << lane;
+    }
+    return mask;
+#endif
+}
+
+template <typename Geometry>
+int BVHTree::closestHitPacket(
+    const Geometry& scene,
+    PrimitiveHit* closest,
+    const RayPacket& packet,
+    float tMin,
+    TraversalStats* stats
+) const {
+    if (rootIndex_ < 0) return 0;
+
+    int hits = 0;
+    auto traceSingle = [&](int lane, int nodeIndex) {
+        if (closestHitFrom(scene, closest[lane], TraversalRay{packet.rays[lane]}, tMin, nodeIndex, stats))
+            hits |= 1 << lane;
+    };
+
+    // Rays heading into different octants would disagree on child order and soon on everything else
+    if (packet.octant < 0) {
+        for (int lane = 0; lane < packet.count; ++lane)
+            traceSingle(lane, rootIndex_);
+        return hits;
+    }
+
+    alignas(32) float tMax[RayPacket::Size];
+    for (int lane = 0; lane < RayPacket::Size; ++lane)
+        tMax[lane] = lane < packet.count ? closest[lane].t : -INFINITY;
+
+    struct StackEntry {
+        int node;
+        int mask; // Lanes whose rays reached the node's parent
+    };
+    StackEntry stack[64];
+    int stackPtr = 0;
+    stack[stackPtr++] = {rootIndex_, packet.laneMask()};
+
+    while (stackPtr > 0) {
+        StackEntry entry = stack[--stackPtr];
+        const BVHNode& node = nodes_[entry.node];
+
+        // Tested on pop, against each lane's current closest hit, so hits found since the push cull too
+        if (stats) stats->nodesVisited++;
+        int mask = packetHitsBox(node.box, packet, tMin, tMax) & entry.mask;
+        if (mask == 0) continue;
+
+        if (std::popcount(static_cast<unsigned>(mask)) <= PacketFallbackLanes) {
+            for (int lanes = mask; lanes; lanes &= lanes - 1)
+                traceSingle(std::countr_zero(static_cast<unsigned>(lanes)), entry.node);
+        } else if (node.isLeaf()) {
+            for (int lanes = mask; lanes; lanes &= lanes - 1) {
+                int lane = std::countr_zero(static_cast<unsigned>(lanes));
+                if (stats) stats->primitivesTested += node.primitiveCount;
+                if (scene.hitLeaf(primitiveIndices_.data(), node.offset, node.primitiveCount, packet.rays[lane], tMin, closest[lane]))
+                    hits |= 1 << lane;
             }
         } else {
-            stack[stackPtr++] = node.right;
-            stack[stackPtr++] = node.left;
+            // Every ray shares the octant, so the split axis orders the children for all of them
+            int near = node.left();
+            int far = node.right();
+            if ((packet.octant >> node.axis) & 1) std::swap(near, far);
+            stack[stackPtr++] = {far, mask};
+            stack[stackPtr++] = {near, mask};
+            continue;
+        }
+
+        for (int lanes = mask; lanes; lanes &= lanes - 1) {
+            int lane = std::countr_zero(static_cast<unsigned>(lanes));
+            tMax[lane] = closest[lane].t;
         }
     }
 
-    return hitAnything;
+    return hits;
 }
 
+template <typename Geometry>
+bool BVHTree::occluded(
+    const Geometry& scene,
+    const TraversalRay& ray,
+    float tMin,
+    float tMax,
+    TraversalStats* stats
+) const {
+    if (rootIndex_ < 0) return false;
+
+    // Any hit ends the query, so visiting order doesn't matter
+    int stack[64];
+    int stackPtr = 0;
+    stack[stackPtr++] = rootIndex_;
+
+    while (stackPtr > 0) {
+        const BVHNode& node = nodes_[stack[--stackPtr]];
+
+        if (stats) stats->nodesVisited++;
+        if (!node.box.hit(ray, tMin, tMax)) continue;
+
+        if (node.isLeaf()) {
+            if (stats) stats->primitivesTested += node.primitiveCount;
+            if (scene.occludesLeaf(primitiveIndices_.data(), node.offset, node.primitiveCount, ray.ray, tMin, tMax))
+                return true;
+        } else {
+            stack[stackPtr++] = node.right();
+            stack[stackPtr++] = node.left();
+        }
+    }
+
+    return false;
+}
 
 AABB BVHTree::boundingBox() const {
     if (rootIndex_ < 0 || nodes_.empty()) {
@@ -133,6 +859,109 @@ AABB BVHTree::boundingBox() const {
     return nodes_[rootIndex_].box;
 }
 
+bool BVHTree::isValid(size_t primitiveCount) const {
+    if (nodes_.empty()) return rootIndex_ == InvalidNode && primitiveIndices_.empty();
+    if (rootIndex_ < 0 || static_cast<size_t>(rootIndex_) >= nodes_.size()) return false;
+
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        const BVHNode& node = nodes_[i];
+        if (node.isLeaf()) {
+            if (node.offset < 0 || size_t(node.offset) + node.primitiveCount > primitiveIndices_.size()) return false;
+        } else if (node.offset <= static_cast<int>(i) || size_t(node.offset) + 1 >= nodes_.size()) {
+            return false;
+        }
+    }
+    return std::all_of(primitiveIndices_.begin(), primitiveIndices_.end(),
+                       [&](int index) { return index >= 0 && static_cast<size_t>(index) < primitiveCount; });
+}
+
+float BVHTree::sahCost() const {
+    if (rootIndex_ < 0) return 0.0f;
+
+    float rootArea = nodes_[rootIndex_].box.surfaceArea();
+    if (rootArea <= 0.0f) return options_.intersectionCost;
+
+    float cost = 0.0f;
+    for (const BVHNode& node : nodes_) {
+        float areaRatio = node.box.surfaceArea() / rootArea;
+        cost += areaRatio * (node.isLeaf()
+            ? options_.intersectionCost * node.primitiveCount
+            : options_.traversalCost);
+    }
+    return cost;
+}
+
+template <typename Geometry>
+void BVHTree::refit(const Geometry& scene) {
+    if (rootIndex_ < 0) return;
+    int threads = resolveThreadCount(options_.threadCount);
+
+    // Cut the tree breadth-first until there are enough subtrees to spread over the threads.
+    // Children always come after their parent in the list, so a reverse sweep refits the cut bottom-up
+    std::vector<int> top{rootIndex_};
+    std::vector<int> subtrees;
+    size_t targetTasks = threads > 1 && primitiveIndices_.size() >= MinParallelRange ? static_cast<size_t>(threads) * 8 : 0;
+    for (size_t i = 0; i < top.size(); ++i) {
+        const BVHNode& node = nodes_[top[i]];
+        if (!node.isLeaf() && top.size() + subtrees.size() < targetTasks) {
+            top.push_back(node.left());
+            top.push_back(node.right());
+        } else {
+            subtrees.push_back(top[i]);
+        }
+    }
+
+    parallelTasks(subtrees.size(), threads, [&](size_t i) {
+        refitNode(scene, subtrees[i]);
+    });
+
+    for (int i = static_cast<int>(top.size()) - 1; i >= 0; --i) {
+        BVHNode& node = nodes_[top[i]];
+        if (!node.isLeaf())
+            node.box = surroundingBox(nodes_[node.left()].box, nodes_[node.right()].box);
+    }
+}
+
+template <typename Geometry>
+AABB BVHTree::refitNode(const Geometry& scene, int nodeIndex) {
+    BVHNode& node = nodes_[nodeIndex];
+    if (node.isLeaf()) {
+        AABB box = AABB::empty();
+        for (int i = node.offset; i < node.offset + node.primitiveCount; ++i)
+            box = surroundingBox(box, scene.primitiveBounds(primitiveIndices_[i]));
+        return node.box = box;
+    }
+
+    AABB leftBox = refitNode(scene, node.left());
+    AABB rightBox = refitNode(scene, node.right());
+    return node.box = surroundingBox(leftBox, rightBox);
+}
+
+std::vector<int> BVHTree::renumberPrimitives() {
+    std::vector<int> order = std::move(primitiveIndices_);
+    primitiveIndices_.resize(order.size());
+    std::iota(primitiveIndices_.begin(), primitiveIndices_.end(), 0);
+    return order;
+}
+
+float BVHTree::sahDegradation() const {
+    if (rootIndex_ < 0 || builtSahCost_ <= 0.0f) return 1.0f;
+    return sahCost() / builtSahCost_;
+}
+
 const BVHNode& BVHTree::root() { 
     return nodes_[rootIndex_]; 
-}
\ No newline at end of file
+}
+
+#define INSTANTIATE_BVH_GEOMETRY(Geometry)                                                                          \
+    template void BVHTree::build(const Geometry&, const BVHBuildOptions&);                                          \
+    template bool BVHTree::hit(const Geometry&, HitRecord&, const Ray&, float, float) const;                        \
+    template bool BVHTree::hit(const Geometry&, HitRecord&, const TraversalRay&, float, float, TraversalStats*) const; \
+    template bool BVHTree::closestHit(const Geometry&, PrimitiveHit&, const TraversalRay&, float, TraversalStats*) const; \
+    template int BVHTree::closestHitPacket(const Geometry&, PrimitiveHit*, const RayPacket&, float, TraversalStats*) const; \
+    template bool BVHTree::occluded(const Geometry&, const TraversalRay&, float, float, TraversalStats*) const;      \
+    template void BVHTree::refit(const Geometry&);
+
+INSTANTIATE_BVH_GEOMETRY(Scene)
+INSTANTIATE_BVH_GEOMETRY(SceneObject)
+INSTANTIATE_BVH_GEOMETRY(PagedGeometry)
@@ -1,52 +1,178 @@
 #pragma once
 
 #include "accel/AABB.h"
+#include "accel/RayPacket.h"
 #include "core/HitRecord.h"
 #include "core/Vec3.h"
 #include "core/Ray.h"
 #include <vector>
+#include <cstdint>
 
-class Scene;  // Forward declare
 
 static constexpr int InvalidNode = -1;
 
+enum class BVHBuildMethod : uint8_t {
+    Median, // Sort along the longest axis and split at the median count
+    SAH,    // Binned surface area heuristic over centroid bounds
+    LBVH    // Linear BVH: radix sorted Morton codes, split at the highest differing bit. Fastest build
+};
+
 /**
- * BVH Node - contains two children or references a primitive (leaf)
+ * BVH build configuration. Costs are relative: only their ratio matters to the SAH.
  */
-struct BVHNode {
-    int left;            // Index of left child (-1 if leaf)
-    int right;           // Index of right child (-1 if leaf)
-    int primitiveIndex;  // Index into primitives array
+struct BVHBuildOptions {
+    BVHBuildMethod method = BVHBuildMethod::SAH;
+    int maxLeafSize = 4;           // Upper bound on primitives per leaf, clamped to [1, 255]
+    int binCount = 16;             // SAH bins per axis, clamped to [2, 32]
+    float traversalCost = 1.0f;    // Cost of visiting one interior node
+    float intersectionCost = 1.0f; // Cost of testing one primitive
+    int threadCount = 0;           // Build threads, 0 = one per hardware thread. The tree is identical for any count
+    float rebuildThreshold = 1.5f; // Scene::refit() rebuilds once sahDegradation() exceeds this
+};
 
+/**
+ * Per-query traversal counters, filled in when a TraversalStats pointer is passed to hit()
+ */
+struct TraversalStats {
+    uint64_t nodesVisited = 0;     // Node bounds tested against the ray
+    uint64_t primitivesTested = 0; // Primitive intersection tests performed
+};
+
+/**
+ * BVH Node - contains two children or references a range of primitives (leaf).
+ * Siblings are allocated next to each other, so interior nodes only store the left child.
+ */
+struct BVHNode {
     AABB box;
 
-    inline bool isLeaf() const { return primitiveIndex > InvalidNode; }
+    int offset;               // Interior: index of left child (right is offset + 1). Leaf: first slot in primitive index array
+    uint16_t primitiveCount;  // Number of primitives in leaf (0 if interior)
+    uint8_t axis;             // Split axis: the left child holds the smaller centroids along it
+
+    inline bool isLeaf() const { return primitiveCount > 0; }
+    inline int left() const { return offset; }
+    inline int right() const { return offset + 1; }
 };
 
 /**
- * Bounding Volume Hierarchy for ray-scene intersection acceleration
+ * Bounding Volume Hierarchy for ray-scene intersection acceleration.
+ * Builds over any geometry source with primitiveCount(), primitiveBounds(), hitLeaf(), occludesLeaf() and
+ * finalizeHit():
+ * the Scene (top level), a SceneObject (bottom level) or a PagedGeometry (resident tree over its pages).
+ * Instantiated for all three in BVH.cpp.
+ * Leaves hand their whole primitive range to the geometry, which may test it in SIMD batches.
  */
 class BVHTree {
 public:
     BVHTree() = default;
 
-    void build(const Scene& scene);
+    template <typename Geometry>
+    void build(const Geometry& scene, const BVHBuildOptions& options = {});
 
+    template <typename Geometry>
     bool hit(
-        const Scene& scene,
+        const Geometry& scene,
         HitRecord& record,
         const Ray& ray,
         float tMin,
         float tMax
     ) const;
 
+    // Same query for a ray whose inverse direction and sign bits are already computed
+    template <typename Geometry>
+    bool hit(
+        const Geometry& scene,
+        HitRecord& record,
+        const TraversalRay& ray,
+        float tMin,
+        float tMax,
+        TraversalStats* stats = nullptr
+    ) const;
+
+    /**
+     * Traversal without building a HitRecord: narrows closest (t on entry is tMax) to the nearest primitive
+     * and returns true if it found one. hit() is this followed by the geometry's finalizeHit().
+     */
+    template <typename Geometry>
+    bool closestHit(
+        const Geometry& scene,
+        PrimitiveHit& closest,
+        const TraversalRay& ray,
+        float tMin,
+        TraversalStats* stats = nullptr
+    ) const;
+
+    /**
+     * closestHit() for a packet of coherent rays, closest[lane].t on entry being each ray's tMax. Nodes are
+     * tested against every ray at once and skipped when all of them miss. Returns the mask of lanes that hit.
+     * Rays whose directions differ in sign, and the last few rays still inside a subtree, go on as single rays.
+     */
+    template <typename Geometry>
+    int closestHitPacket(
+        const Geometry& scene,
+        PrimitiveHit* closest,
+        const RayPacket& packet,
+        float tMin,
+        TraversalStats* stats = nullptr
+    ) const;
+
+    // A packet whose rays still inside a subtree number this many or fewer traces them one by one
+    static constexpr int PacketFallbackLanes = 2;
+
+    // Any-hit query: returns as soon as one primitive is hit within (tMin, tMax)
+    template <typename Geometry>
+    bool occluded(
+        const Geometry& scene,
+        const TraversalRay& ray,
+        float tMin,
+        float tMax,
+        TraversalStats* stats = nullptr
+    ) const;
+
+    /**
+     * Recomputes every node's bounds bottom-up from the scene's current primitive bounds, keeping the topology.
+     * Linear in the node count and parallel over subtrees. Use after primitives move; rebuild after adding any.
+     */
+    template <typename Geometry>
+    void refit(const Geometry& scene);
+
+    /**
+     * Renumbers primitives in leaf order, so slot i of the index array holds primitive i. Returns the old index
+     * array: the geometry must move its old primitive order[i] to index i. For geometry stored in leaf order.
+     */
+    std::vector<int> renumberPrimitives();
+
+    // Current SAH cost relative to the cost right after the last build. Grows as refitted boxes drift apart
+    float sahDegradation() const;
+
     AABB boundingBox() const;
 
+    /**
+     * Expected cost of tracing a random ray through the tree under the surface area heuristic,
+     * using the traversal and intersection costs the tree was built with. Lower is better.
+     */
+    float sahCost() const;
+
+    /**
+     * True if every child offset, leaf range and primitive index stays inside the tree's arrays, children coming
+     * after their parents so traversal ends. For trees restored from a file rather than built.
+     */
+    bool isValid(size_t primitiveCount) const;
+
     const BVHNode& root();
+
+    const std::vector<BVHNode>& getNodes() const { return nodes_; }
+    const std::vector<int>& getPrimitiveIndices() const { return primitiveIndices_; }
     
 private:
+    friend class SceneCache;    // Reads and restores internal arrays
+    friend class PagedGeometry; // Writes and restores page subtrees
+
     std::vector<BVHNode> nodes_;
+    std::vector<int> primitiveIndices_; // Scene primitive indices, reordered so every leaf owns a contiguous range
     int rootIndex_ = InvalidNode;
+    BVHBuildOptions options_;
+    float builtSahCost_ = 0.0f;
 
     struct BVHBuildEntry {
         int primitiveIndex;
@@ -54,5 +180,73 @@ private:
         Point3 centroid;
     };
 
-    int buildTree(std::vector<BVHBuildEntry>& entries, size_t start, size_t end);
+    // Recursively builds entries[start, end) into nodes[nodeIndex], appending descendants to nodes
+    void buildTree(
+        std::vector<BVHNode>& nodes,
+        std::vector<BVHBuildEntry>& entries,
+        std::vector<BVHBuildEntry>& scratch,
+        int nodeIndex,
+        size_t start,
+        size_t end
+    ) const;
+
+    // closestHit() over the subtree under nodeIndex
+    template <typename Geometry>
+    bool closestHitFrom(
+        const Geometry& scene,
+        PrimitiveHit& closest,
+        const TraversalRay& ray,
+        float tMin,
+        int nodeIndex,
+        TraversalStats* stats
+    ) const;
+
+    // Refits the subtree under nodeIndex and returns its new bounds
+    template <typename Geometry>
+    AABB refitNode(const Geometry& scene, int nodeIndex);
+
+    // Top of a parallel build: interior nodes split on the calling thread, leaves handed to subtree tasks
+    struct BuildTopNode {
+        AABB box;
+        int axis = 0;
+        int left = InvalidNode, right = InvalidNode; // Indices into the top node list
+        int subtree = InvalidNode;                   // Set when this range is built as a task
+    };
+
+    struct BuildSubtree {
+        size_t start, end;
+        std::vector<BVHNode> nodes; // Local indices: root at 0, descendants from 1
+        int slot = 0;               // Final index of the subtree root
+        int base = 0;               // Final index of local node 1
+    };
+
+    // Splits the top levels with every thread, then builds the remaining subtrees as parallel tasks
+    void buildParallel(std::vector<BVHBuildEntry>& entries, std::vector<BVHBuildEntry>& scratch, int threads);
+
+    // Lays top nodes and finished subtrees out in nodes_ in serial depth-first order
+    void assembleSubtrees(const std::vector<BuildTopNode>& top, std::vector<BuildSubtree>& subtrees, int threads);
+
+    // LBVH: sorts entries by Morton code, then emits the hierarchy from the sorted codes
+    void buildLinear(std::vector<BVHBuildEntry>& entries, std::vector<BVHBuildEntry>& scratch, int threads);
+    AABB buildLinearTree(
+        std::vector<BVHNode>& nodes,
+        const std::vector<BVHBuildEntry>& entries,
+        const std::vector<uint64_t>& codes,
+        int nodeIndex,
+        size_t start,
+        size_t end
+    ) const;
+
+    // Stable LSD radix sort of the low bits of keys, carrying values along
+    static void radixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int bits, int threads);
+
+    // Reorders entries[start, end) into two halves along axis and returns the split point, or start to make a leaf.
+    // threads > 1 spreads binning and partitioning over threads without changing the result
+    size_t splitMedian(
+        std::vector<BVHBuildEntry>& entries, size_t start, size_t end, const AABB& bounds, int& axis) const;
+    size_t splitSAH(
+        std::vector<BVHBuildEntry>& entries, std::vector<BVHBuildEntry>& scratch,
+        size_t start, size_t end, const AABB& bounds, int& axis, int threads = 1) const;
+
+    static AABB rangeBounds(const std::vector<BVHBuildEntry>& entries, size_t start, size_t end, bool centroids, int threads);
 };
\ No newline at end of file
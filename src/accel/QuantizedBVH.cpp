@@ -0,0 +1,286 @@
+#include "accel/QuantizedBVH.h"
+#include "renderer/Scene.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+// Decoding is origin + q * step. The compiler may fuse that into an FMA in scalar code while SIMD code rounds
+// twice, so encoding checks both forms
+static float decodeSeparate(float origin, int q, float step) {
+    volatile float scaled = static_cast<float>(q) * step;
+    return origin + scaled;
+}
+
+static float decodeFused(float origin, int q, float step) {
+    return std::fma(static_cast<float>(q), step, origin);
+}
+
+static uint8_t quantizeMin(float origin, float step, float value) {
+    int q = std::clamp(static_cast<int>(std::floor((value - origin) / step)), 0, 255);
+    while (q > 0 && (decodeSeparate(origin, q, step) > value || decodeFused(origin, q, step) > value))
+        --q;
+    return static_cast<uint8_t>(q);
+}
+
+static uint8_t quantizeMax(float origin, float step, float value) {
+    int q = std::clamp(static_cast<int>(std::ceil((value - origin) / step)), 0, 255);
+    while (q < 255 && (decodeSeparate(origin, q, step) < value || decodeFused(origin, q, step) < value))
+        ++q;
+    return static_cast<uint8_t>(q);
+}
+
+AABB QuantizedBVHNode::childBounds(int lane) const {
+    float step[3];
+    for (int a = 0; a < 3; ++a)
+        step[a] = std::ldexp(1.0f, exponent[a]);
+
+    return AABB{
+        Vec3{origin[0] + qMinX[lane] * step[0], origin[1] + qMinY[lane] * step[1], origin[2] + qMinZ[lane] * step[2]},
+        Vec3{origin[0] + qMaxX[lane] * step[0], origin[1] + qMaxY[lane] * step[1], origin[2] + qMaxZ[lane] * step[2]}
+    };
+}
+
+void QuantizedBVH::build(const BVHTree& tree) {
+    // Same topology as BVH4, so collapse with it and re-encode node by node; indices carry over unchanged
+    BVH4 wide;
+    wide.build(tree);
+
+    primitiveIndices_ = wide.getPrimitiveIndices();
+    bounds_ = wide.boundingBox();
+
+    nodes_.resize(wide.getNodes().size());
+    for (size_t i = 0; i < nodes_.size(); ++i)
+        nodes_[i] = quantize(wide.getNodes()[i]);
+}
+
+QuantizedBVH::Node QuantizedBVH::quantize(const BVH4::Node& wide) {
+    Node node{};
+    node.childCount = static_cast<uint8_t>(wide.childCount);
+
+    const float* mins[3] = {wide.minX, wide.minY, wide.minZ};
+    const float* maxs[3] = {wide.maxX, wide.maxY, wide.maxZ};
+    uint8_t* qMins[3] = {node.qMinX, node.qMinY, node.qMinZ};
+    uint8_t* qMaxs[3] = {node.qMaxX, node.qMaxY, node.qMaxZ};
+
+    for (int a = 0; a < 3; ++a) {
+        float lo = INFINITY, hi = -INFINITY;
+        for (int lane = 0; lane < wide.childCount; ++lane) {
+            lo = std::min(lo, mins[a][lane]);
+            hi = std::max(hi, maxs[a][lane]);
+        }
+
+        // Smallest power of two step that spans the node in 255 steps
+        int exponent = -126;
+        if (hi > lo) {
+            std::frexp((hi - lo) / 255.0f, &exponent);
+            exponent = std::clamp(exponent, -126, 127);
+
+            // The division above rounds, so make sure the top grid line really reaches hi
+            while (exponent < 127 && (decodeSeparate(lo, 255, std::ldexp(1.0f, exponent)) < hi
+                                   || decodeFused(lo, 255, std::ldexp(1.0f, exponent)) < hi))
+                ++exponent;
+        }
+        float step = std::ldexp(1.0f, exponent);
+
+        node.origin[a] = lo;
+        node.exponent[a] = static_cast<int8_t>(exponent);
+
+        // Unused lanes decode to an inverted box and are masked out by childCount anyway
+        for (int lane = 0; lane < Node::Width; ++lane) {
+            if (lane < wide.childCount) {
+                qMins[a][lane] = quantizeMin(lo, step, mins[a][lane]);
+                qMaxs[a][lane] = quantizeMax(lo, step, maxs[a][lane]);
+            } else {
+                qMins[a][lane] = 255;
+                qMaxs[a][lane] = 0;
+            }
+        }
+    }
+
+    for (int lane = 0; lane < Node::Width; ++lane) {
+        node.child[lane] = wide.child[lane];
+        node.primitiveCount[lane] = static_cast<uint8_t>(wide.primitiveCount[lane]);
+    }
+    return node;
+}
+
+/**
+ * Decodes every child box of a node and slab tests the ray against them.
+ * Writes the entry distance of each lane to tNear and returns a bitmask of the lanes that were hit.
+ */
+static int quantizedSlabTest(
+    const QuantizedBVHNode& node,
+    const Vec3& origin,
+    const Vec3& invDir,
+    float tMin,
+    float tMax,
+    float* tNear)
+{
+    int validMask = (1 << node.childCount) - 1;
+
+#if defined(__SSE4_1__)
+    // Decode: widen 4 bytes to 4 floats, scale by the axis step and offset by the node origin
+    auto decode = [](const uint8_t* q, float nodeOrigin, int exponent) {
+        int packed;
+        std::memcpy(&packed, q, sizeof(packed));
+        __m128 value = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed)));
+        __m128 step = _mm_castsi128_ps(_mm_set1_epi32((exponent + 127) << 23));
+        return _mm_add_ps(_mm_mul_ps(value, step), _mm_set1_ps(nodeOrigin));
+    };
+
+    __m128 ix = _mm_set1_ps(invDir.x), iy = _mm_set1_ps(invDir.y), iz = _mm_set1_ps(invDir.z);
+    __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+
+    __m128 t0x = _mm_mul_ps(_mm_sub_ps(decode(node.qMinX, node.origin[0], node.exponent[0]), ox), ix);
+    __m128 t1x = _mm_mul_ps(_mm_sub_ps(decode(node.qMaxX, node.origin[0], node.exponent[0]), ox), ix);
+    __m128 t0y = _mm_mul_ps(_mm_sub_ps(decode(node.qMinY, node.origin[1], node.exponent[1]), oy), iy);
+    __m128 t1y = _mm_mul_ps(_mm_sub_ps(decode(node.qMaxY, node.origin[1], node.exponent[1]), oy), iy);
+    __m128 t0z = _mm_mul_ps(_mm_sub_ps(decode(node.qMinZ, node.origin[2], node.exponent[2]), oz), iz);
+    __m128 t1z = _mm_mul_ps(_mm_sub_ps(decode(node.qMaxZ, node.origin[2], node.exponent[2]), oz), iz);
+
+    __m128 enter = _mm_max_ps(
+        _mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)),
+        _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_set1_ps(tMin)));
+    __m128 exit = _mm_min_ps(
+        _mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)),
+        _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_set1_ps(tMax)));
+
+    _mm_storeu_ps(tNear, enter);
+    return _mm_movemask_ps(_mm_cmple_ps(enter, exit)) & validMask;
+#else
+    // Scalar fallback
+    int mask = 0;
+    for (int lane = 0; lane < node.childCount; ++lane) {
+        AABB box = node.childBounds(lane);
+        float t0x = (box.min.x - origin.x) * invDir.x, t1x = (box.max.x - origin.x) * invDir.x;
+        float t0y = (box.min.y - origin.y) * invDir.y, t1y = (box.max.y - origin.y) * invDir.y;
+        float t0z = (box.min.z - origin.z) * invDir.z, t1z = (box.max.z - origin.z) * invDir.z;
+
+        float enter = std::max(std::max(std::min(t0x, t1x), std::min(t0y, t1y)), std::max(std::min(t0z, t1z), tMin));
+        float exit = std::min(std::min(std::max(t0x, t1x), std::max(t0y, t1y)), std::min(std::max(t0z, t1z), tMax));
+
+        tNear[lane] = enter;
+        if (enter <= exit) mask |= 1 << lane;
+    }
+    return mask & validMask;
+#endif
+}
+
+bool QuantizedBVH::hit(
+    const Scene& scene,
+    HitRecord& record,
+    const TraversalRay& ray,
+    float tMin,
+    float tMax,
+    TraversalStats* stats
+) const {
+    PrimitiveHit closest{tMax};
+    if (!closestHit(scene, closest, ray, tMin, stats)) return false;
+
+    scene.finalizeHit(closest, record, ray.ray);
+    return true;
+}
+
+bool QuantizedBVH::closestHit(
+    const Scene& scene,
+    PrimitiveHit& closest,
+    const TraversalRay& ray,
+    float tMin,
+    TraversalStats* stats
+) const {
+    if (nodes_.empty()) return false;
+
+    struct StackEntry {
+        int child;
+        int primitiveCount; // 0 for interior nodes
+        float tNear;
+    };
+
+    bool hitAnything = false;
+
+    StackEntry stack[64 * Node::Width];
+    int stackPtr = 0;
+    stack[stackPtr++] = {0, 0, tMin};
+
+    while (stackPtr > 0) {
+        StackEntry entry = stack[--stackPtr];
+        if (entry.tNear > closest.t) continue; // A closer hit was found after this entry was pushed
+
+        if (entry.primitiveCount > 0) {
+            if (stats) stats->primitivesTested += entry.primitiveCount;
+            if (scene.hitLeaf(primitiveIndices_.data(), entry.child, entry.primitiveCount, ray.ray, tMin, closest))
+                hitAnything = true;
+            continue;
+        }
+
+        const Node& node = nodes_[entry.child];
+        if (stats) stats->nodesVisited += node.childCount;
+
+        alignas(16) float tNear[Node::Width];
+        int mask = quantizedSlabTest(node, ray.ray.origin, ray.invDirection, tMin, closest.t, tNear);
+        if (mask == 0) continue;
+
+        // Sort hit children by entry distance, then push farthest first so the nearest is popped next
+        int order[Node::Width];
+        int count = 0;
+        for (int lane = 0; lane < Node::Width; ++lane) {
+            if (!(mask & (1 << lane))) continue;
+
+            int i = count++;
+            while (i > 0 && tNear[order[i - 1]] > tNear[lane]) {
+                order[i] = order[i - 1];
+                --i;
+            }
+            order[i] = lane;
+        }
+
+        for (int i = count - 1; i >= 0; --i) {
+            int lane = order[i];
+            stack[stackPtr++] = {node.child[lane], node.primitiveCount[lane], tNear[lane]};
+        }
+    }
+
+    return hitAnything;
+}
+
+bool QuantizedBVH::occluded(
+    const Scene& scene,
+    const TraversalRay& ray,
+    float tMin,
+    float tMax,
+    TraversalStats* stats
+) const {
+    if (nodes_.empty()) return false;
+
+    // Any hit ends the query, so children are pushed unsorted
+    int stack[64 * Node::Width];
+    int stackPtr = 0;
+    stack[stackPtr++] = 0;
+
+    while (stackPtr > 0) {
+        const Node& node = nodes_[stack[--stackPtr]];
+        if (stats) stats->nodesVisited += node.childCount;
+
+        alignas(16) float tNear[Node::Width];
+        int mask = quantizedSlabTest(node, ray.ray.origin, ray.invDirection, tMin, tMax, tNear);
+
+        for (int lane = 0; lane < Node::Width; ++lane) {
+            if (!(mask & (1 << lane))) continue;
+
+            if (!node.isLeaf(lane)) {
+                stack[stackPtr++] = node.child[lane];
+                continue;
+            }
+
+            if (stats) stats->primitivesTested += node.primitiveCount[lane];
+            if (scene.occludesLeaf(primitiveIndices_.data(), node.child[lane], node.primitiveCount[lane], ray.ray, tMin, tMax))
+                return true;
+        }
+    }
+
+    return false;
+}
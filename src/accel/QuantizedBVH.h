@@ -0,0 +1,91 @@
+#pragma once
+
+#include "accel/AABB.h"
+#include "accel/BVH.h"
+#include "accel/WideBVH.h"
+#include "core/HitRecord.h"
+#include "core/Ray.h"
+#include <cstdint>
+#include <vector>
+
+class Scene;  // Forward declare
+
+/**
+ * Quantized BVH Node - four children in one 64-byte cache line.
+ * Child bounds are 8-bit grid coordinates inside the node's bounds: origin + q * 2^exponent per axis.
+ * Minimums round down and maximums round up, so decoded boxes always contain the exact ones.
+ */
+struct alignas(64) QuantizedBVHNode {
+    static constexpr int Width = 4;
+
+    float origin[3];    // Minimum corner of the node's bounds
+    int8_t exponent[3]; // Grid step per axis is 2^exponent
+    uint8_t childCount;
+
+    uint8_t qMinX[Width], qMinY[Width], qMinZ[Width];
+    uint8_t qMaxX[Width], qMaxY[Width], qMaxZ[Width];
+
+    int child[Width];             // Interior child: node index. Leaf child: first slot in primitive index array
+    uint8_t primitiveCount[Width]; // Number of primitives for leaf children (0 if interior)
+
+    inline bool isLeaf(int lane) const { return primitiveCount[lane] > 0; }
+
+    // Decoded (conservative) bounds of one child
+    AABB childBounds(int lane) const;
+};
+
+static_assert(sizeof(QuantizedBVHNode) == 64, "QuantizedBVHNode must fill exactly one cache line");
+
+/**
+ * Quantized 4-wide BVH. Same topology as BVH4, but each node is a quarter to a third of the size,
+ * which matters once the tree no longer fits in cache. Child boxes are decoded in the traversal loop.
+ */
+class QuantizedBVH {
+public:
+    using Node = QuantizedBVHNode;
+
+    QuantizedBVH() = default;
+
+    void build(const BVHTree& tree);
+
+    bool hit(
+        const Scene& scene,
+        HitRecord& record,
+        const TraversalRay& ray,
+        float tMin,
+        float tMax,
+        TraversalStats* stats = nullptr
+    ) const;
+
+    // Traversal without building a HitRecord, as BVHTree::closestHit()
+    bool closestHit(
+        const Scene& scene,
+        PrimitiveHit& closest,
+        const TraversalRay& ray,
+        float tMin,
+        TraversalStats* stats = nullptr
+    ) const;
+
+    // Any-hit query: returns as soon as one primitive is hit within (tMin, tMax)
+    bool occluded(
+        const Scene& scene,
+        const TraversalRay& ray,
+        float tMin,
+        float tMax,
+        TraversalStats* stats = nullptr
+    ) const;
+
+    AABB boundingBox() const { return bounds_; }
+
+    const std::vector<Node>& getNodes() const { return nodes_; }
+    const std::vector<int>& getPrimitiveIndices() const { return primitiveIndices_; }
+
+private:
+    friend class SceneCache; // Reads and restores internal arrays
+
+    std::vector<Node> nodes_;
+    std::vector<int> primitiveIndices_;
+    AABB bounds_;
+
+    static Node quantize(const BVH4::Node& wide);
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "core/Ray.h"
+
+/**
+ * RayPacket - Up to Size rays traced together through a BVHTree, such as the camera rays of neighbouring pixels.
+ * Origins and inverse directions are stored as SoA so one 8-wide slab test checks a node against every ray.
+ * Lanes from count up repeat lane 0 and are never reported.
+ */
+struct RayPacket {
+    static constexpr int Size = 8;
+
+    alignas(32) float originX[Size], originY[Size], originZ[Size];
+    alignas(32) float invDirX[Size], invDirY[Size], invDirZ[Size];
+    Ray rays[Size];
+    int count;
+    int octant; // Direction sign bits (bit axis set if negative) shared by every ray, or -1 if they differ
+
+    RayPacket(const Ray* packetRays, int rayCount) : count(rayCount), octant(0) {
+        for (int lane = 0; lane < Size; ++lane) {
+            const Ray& ray = packetRays[lane < count ? lane : 0];
+            rays[lane] = ray;
+            originX[lane] = ray.origin.x;
+            originY[lane] = ray.origin.y;
+            originZ[lane] = ray.origin.z;
+            invDirX[lane] = TraversalRay::safeInverse(ray.direction.x);
+            invDirY[lane] = TraversalRay::safeInverse(ray.direction.y);
+            invDirZ[lane] = TraversalRay::safeInverse(ray.direction.z);
+
+            int sign = (ray.direction.x < 0.0f) | (ray.direction.y < 0.0f) << 1 | (ray.direction.z < 0.0f) << 2;
+            if (lane == 0) octant = sign;
+            else if (lane < count && sign != octant) octant = -1;
+        }
+    }
+
+    int laneMask() const { return (1 << count) - 1; }
+};
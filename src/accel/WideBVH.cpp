@@ -0,0 +1,295 @@
+#include "accel/WideBVH.h"
+#include "renderer/Scene.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+template <int Width>
+void WideBVH<Width>::build(const BVHTree& tree) {
+    nodes_.clear();
+    primitiveIndices_ = tree.getPrimitiveIndices();
+    bounds_ = tree.boundingBox();
+
+    const auto& binaryNodes = tree.getNodes();
+    if (binaryNodes.empty()) return;
+
+    nodes_.reserve(binaryNodes.size() / 2 + 1);
+    collapse(binaryNodes, 0);
+}
+
+template <int Width>
+int WideBVH<Width>::collapse(const std::vector<BVHNode>& binaryNodes, int binaryIndex) {
+    // Gather up to Width descendants, always opening the interior child with the largest surface area
+    int children[Width];
+    int count = 0;
+
+    const BVHNode& source = binaryNodes[binaryIndex];
+    if (source.isLeaf()) {
+        children[count++] = binaryIndex;
+    } else {
+        children[count++] = source.left();
+        children[count++] = source.right();
+    }
+
+    while (count < Width) {
+        int best = -1;
+        float bestArea = -1.0f;
+        for (int i = 0; i < count; ++i) {
+            const BVHNode& node = binaryNodes[children[i]];
+            if (!node.isLeaf() && node.box.surfaceArea() > bestArea) {
+                best = i;
+                bestArea = node.box.surfaceArea();
+            }
+        }
+        if (best < 0) break;
+
+        int opened = children[best];
+        children[best] = binaryNodes[opened].left();
+        children[count++] = binaryNodes[opened].right();
+    }
+
+    int index = static_cast<int>(nodes_.size());
+    nodes_.emplace_back();
+
+    // Unused lanes get an inverted box and are masked out by childCount during traversal
+    for (int lane = 0; lane < Width; ++lane) {
+        Node& node = nodes_[index];
+        node.minX[lane] = node.minY[lane] = node.minZ[lane] = INFINITY;
+        node.maxX[lane] = node.maxY[lane] = node.maxZ[lane] = -INFINITY;
+        node.child[lane] = InvalidNode;
+        node.primitiveCount[lane] = 0;
+    }
+    nodes_[index].childCount = count;
+
+    for (int lane = 0; lane < count; ++lane) {
+        const BVHNode& child = binaryNodes[children[lane]];
+
+        // Recurse first: it may reallocate nodes_
+        int childRef = child.isLeaf() ? child.offset : collapse(binaryNodes, children[lane]);
+
+        Node& node = nodes_[index];
+        node.minX[lane] = child.box.min.x;
+        node.minY[lane] = child.box.min.y;
+        node.minZ[lane] = child.box.min.z;
+        node.maxX[lane] = child.box.max.x;
+        node.maxY[lane] = child.box.max.y;
+        node.maxZ[lane] = child.box.max.z;
+        node.child[lane] = childRef;
+        node.primitiveCount[lane] = child.primitiveCount;
+    }
+
+    return index;
+}
+
+/**
+ * Slab test of one ray against every child box of a node.
+ * Writes the entry distance of each lane to tNear and returns a bitmask of the lanes that were hit.
+ */
+template <int Width>
+static int slabTest(
+    const WideBVHNode<Width>& node,
+    const Vec3& origin,
+    const Vec3& invDir,
+    float tMin,
+    float tMax,
+    float* tNear)
+{
+    int validMask = (1 << node.childCount) - 1;
+
+#if defined(__AVX__)
+    if constexpr (Width == 8) {
+        __m256 ox = _mm256_set1_ps(origin.x), oy = _mm256_set1_ps(origin.y), oz = _mm256_set1_ps(origin.z);
+        __m256 ix = _mm256_set1_ps(invDir.x), iy = _mm256_set1_ps(invDir.y), iz = _mm256_set1_ps(invDir.z);
+
+        __m256 t0x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.minX), ox), ix);
+        __m256 t1x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.maxX), ox), ix);
+        __m256 t0y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.minY), oy), iy);
+        __m256 t1y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.maxY), oy), iy);
+        __m256 t0z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.minZ), oz), iz);
+        __m256 t1z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.maxZ), oz), iz);
+
+        __m256 enter = _mm256_max_ps(
+            _mm256_max_ps(_mm256_min_ps(t0x, t1x), _mm256_min_ps(t0y, t1y)),
+            _mm256_max_ps(_mm256_min_ps(t0z, t1z), _mm256_set1_ps(tMin)));
+        __m256 exit = _mm256_min_ps(
+            _mm256_min_ps(_mm256_max_ps(t0x, t1x), _mm256_max_ps(t0y, t1y)),
+            _mm256_min_ps(_mm256_max_ps(t0z, t1z), _mm256_set1_ps(tMax)));
+
+        _mm256_storeu_ps(tNear, enter);
+        return _mm256_movemask_ps(_mm256_cmp_ps(enter, exit, _CMP_LE_OQ)) & validMask;
+    }
+#endif
+#if defined(__SSE2__)
+    if constexpr (Width == 4) {
+        __m128 ox = _mm_set1_ps(origin.x), oy = _mm_set1_ps(origin.y), oz = _mm_set1_ps(origin.z);
+        __m128 ix = _mm_set1_ps(invDir.x), iy = _mm_set1_ps(invDir.y), iz = _mm_set1_ps(invDir.z);
+
+        __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), ox), ix);
+        __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), ox), ix);
+        __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), oy), iy);
+        __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), oy), iy);
+        __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), oz), iz);
+        __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), oz), iz);
+
+        __m128 enter = _mm_max_ps(
+            _mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)),
+            _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_set1_ps(tMin)));
+        __m128 exit = _mm_min_ps(
+            _mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)),
+            _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_set1_ps(tMax)));
+
+        _mm_storeu_ps(tNear, enter);
+        return _mm_movemask_ps(_mm_cmple_ps(enter, exit)) & validMask;
+    }
+#endif
+
+    // Scalar fallback
+    int mask = 0;
+    for (int lane = 0; lane < node.childCount; ++lane) {
+        float t0x = (node.minX[lane] - origin.x) * invDir.x, t1x = (node.maxX[lane] - origin.x) * invDir.x;
+        float t0y = (node.minY[lane] - origin.y) * invDir.y, t1y = (node.maxY[lane] - origin.y) * invDir.y;
+        float t0z = (node.minZ[lane] - origin.z) * invDir.z, t1z = (node.maxZ[lane] - origin.z) * invDir.z;
+
+        float enter = std::max(std::max(std::min(t0x, t1x), std::min(t0y, t1y)), std::max(std::min(t0z, t1z), tMin));
+        float exit = std::min(std::min(std::max(t0x, t1x), std::max(t0y, t1y)), std::min(std::max(t0z, t1z), tMax));
+
+        tNear[lane] = enter;
+        if (enter <= exit) mask |= 1 << lane;
+    }
+    return mask;
+}
+
+template <int Width>
+bool WideBVH<Width>::hit(
+    const Scene& scene,
+    HitRecord& record,
+    const Ray& ray,
+    float tMin,
+    float tMax
+) const {
+    return hit(scene, record, TraversalRay{ray}, tMin, tMax);
+}
+
+template <int Width>
+bool WideBVH<Width>::hit(
+    const Scene& scene,
+    HitRecord& record,
+    const TraversalRay& ray,
+    float tMin,
+    float tMax,
+    TraversalStats* stats
+) const {
+    PrimitiveHit closest{tMax};
+    if (!closestHit(scene, closest, ray, tMin, stats)) return false;
+
+    scene.finalizeHit(closest, record, ray.ray);
+    return true;
+}
+
+template <int Width>
+bool WideBVH<Width>::closestHit(
+    const Scene& scene,
+    PrimitiveHit& closest,
+    const TraversalRay& ray,
+    float tMin,
+    TraversalStats* stats
+) const {
+    if (nodes_.empty()) return false;
+
+    struct StackEntry {
+        int child;
+        int primitiveCount; // 0 for interior nodes
+        float tNear;
+    };
+
+    bool hitAnything = false;
+
+    StackEntry stack[64 * Width];
+    int stackPtr = 0;
+    stack[stackPtr++] = {0, 0, tMin};
+
+    while (stackPtr > 0) {
+        StackEntry entry = stack[--stackPtr];
+        if (entry.tNear > closest.t) continue; // A closer hit was found after this entry was pushed
+
+        if (entry.primitiveCount > 0) {
+            if (stats) stats->primitivesTested += entry.primitiveCount;
+            if (scene.hitLeaf(primitiveIndices_.data(), entry.child, entry.primitiveCount, ray.ray, tMin, closest))
+                hitAnything = true;
+            continue;
+        }
+
+        const Node& node = nodes_[entry.child];
+        if (stats) stats->nodesVisited += node.childCount;
+
+        alignas(32) float tNear[Width];
+        int mask = slabTest<Width>(node, ray.ray.origin, ray.invDirection, tMin, closest.t, tNear);
+        if (mask == 0) continue;
+
+        // Sort hit children by entry distance, then push farthest first so the nearest is popped next
+        int order[Width];
+        int count = 0;
+        for (int lane = 0; lane < Width; ++lane) {
+            if (!(mask & (1 << lane))) continue;
+
+            int i = count++;
+            while (i > 0 && tNear[order[i - 1]] > tNear[lane]) {
+                order[i] = order[i - 1];
+                --i;
+            }
+            order[i] = lane;
+        }
+
+        for (int i = count - 1; i >= 0; --i) {
+            int lane = order[i];
+            stack[stackPtr++] = {node.child[lane], node.primitiveCount[lane], tNear[lane]};
+        }
+    }
+
+    return hitAnything;
+}
+
+template <int Width>
+bool WideBVH<Width>::occluded(
+    const Scene& scene,
+    const TraversalRay& ray,
+    float tMin,
+    float tMax,
+    TraversalStats* stats
+) const {
+    if (nodes_.empty()) return false;
+
+    // Any hit ends the query, so children are pushed unsorted
+    int stack[64 * Width];
+    int stackPtr = 0;
+    stack[stackPtr++] = 0;
+
+    while (stackPtr > 0) {
+        const Node& node = nodes_[stack[--stackPtr]];
+        if (stats) stats->nodesVisited += node.childCount;
+
+        alignas(32) float tNear[Width];
+        int mask = slabTest<Width>(node, ray.ray.origin, ray.invDirection, tMin, tMax, tNear);
+
+        for (int lane = 0; lane < Width; ++lane) {
+            if (!(mask & (1 << lane))) continue;
+
+            if (!node.isLeaf(lane)) {
+                stack[stackPtr++] = node.child[lane];
+                continue;
+            }
+
+            if (stats) stats->primitivesTested += node.primitiveCount[lane];
+            if (scene.occludesLeaf(primitiveIndices_.data(), node.child[lane], node.primitiveCount[lane], ray.ray, tMin, tMax))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+template class WideBVH<4>;
+template class WideBVH<8>;
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "accel/AABB.h"
+#include "accel/BVH.h"
+#include "core/HitRecord.h"
+#include "core/Ray.h"
+#include <vector>
+
+class Scene;  // Forward declare
+
+/**
+ * Wide BVH Node - up to Width children whose bounds are stored as structure-of-arrays,
+ * so a single SIMD slab test checks the ray against every child at once.
+ * Valid children are packed into the first childCount lanes.
+ */
+template <int Width>
+struct alignas(32) WideBVHNode {
+    float minX[Width], minY[Width], minZ[Width];
+    float maxX[Width], maxY[Width], maxZ[Width];
+
+    int child[Width];          // Interior child: node index. Leaf child: first slot in primitive index array
+    int primitiveCount[Width]; // Number of primitives for leaf children (0 if interior)
+    int childCount;
+
+    inline bool isLeaf(int lane) const { return primitiveCount[lane] > 0; }
+};
+
+/**
+ * Wide Bounding Volume Hierarchy (BVH4 / BVH8) built by collapsing a binary BVHTree.
+ * Every node tests all of its children in one SSE (4-wide) or AVX (8-wide) slab test and
+ * descends into them nearest-first. Falls back to a scalar loop when the instruction set is unavailable.
+ */
+template <int Width>
+class WideBVH {
+    static_assert(Width == 4 || Width == 8, "WideBVH supports 4 or 8 children per node");
+
+public:
+    using Node = WideBVHNode<Width>;
+
+    WideBVH() = default;
+
+    void build(const BVHTree& tree);
+
+    bool hit(
+        const Scene& scene,
+        HitRecord& record,
+        const Ray& ray,
+        float tMin,
+        float tMax
+    ) const;
+
+    bool hit(
+        const Scene& scene,
+        HitRecord& record,
+        const TraversalRay& ray,
+        float tMin,
+        float tMax,
+        TraversalStats* stats = nullptr
+    ) const;
+
+    // Traversal without building a HitRecord, as BVHTree::closestHit()
+    bool closestHit(
+        const Scene& scene,
+        PrimitiveHit& closest,
+        const TraversalRay& ray,
+        float tMin,
+        TraversalStats* stats = nullptr
+    ) const;
+
+    // Any-hit query: returns as soon as one primitive is hit within (tMin, tMax)
+    bool occluded(
+        const Scene& scene,
+        const TraversalRay& ray,
+        float tMin,
+        float tMax,
+        TraversalStats* stats = nullptr
+    ) const;
+
+    AABB boundingBox() const { return bounds_; }
+
+    const std::vector<Node>& getNodes() const { return nodes_; }
+    const std::vector<int>& getPrimitiveIndices() const { return primitiveIndices_; }
+
+private:
+    friend class SceneCache; // Reads and restores internal arrays
+
+    std::vector<Node> nodes_;
+    std::vector<int> primitiveIndices_; // Same order as the source BVHTree, so leaf ranges carry over unchanged
+    AABB bounds_;
+
+    int collapse(const std::vector<BVHNode>& binaryNodes, int binaryIndex);
+};
+
+using BVH4 = WideBVH<4>;
+using BVH8 = WideBVH<8>;
@@ -24,3 +24,13 @@ struct HitRecord {
     }
 };
 
+
+/**
+ * PrimitiveHit - Closest hit found so far during traversal: only its distance and what was hit.
+ * Geometry turns the final one into a HitRecord once, after traversal (finalizeHit()).
+ */
+struct PrimitiveHit {
+    float t;               // Doubles as the current tMax while traversing
+    int primitive = -1;    // Primitive index in the traversed geometry, -1 while nothing was hit
+    int subPrimitive = -1; // Primitive inside an instanced object
+};
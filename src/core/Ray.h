@@ -1,5 +1,6 @@
 #pragma once
 #include "core/Vec3.h"
+#include <cmath>
 
 /**
  * Ray - Half-line defined by origin and unit direction.
@@ -15,4 +16,27 @@ struct Ray {
     Point3 at(float t) const{
         return origin + t * direction;
     }
+};
+
+/**
+ * TraversalRay - Ray plus the per-ray constants every box test needs, computed once per ray
+ * instead of once per node: inverse direction and the sign of each direction component.
+ */
+struct TraversalRay {
+    Ray ray;
+    Vec3 invDirection;
+    int sign[3]; // 1 if the direction component is negative
+
+    explicit TraversalRay(const Ray& r) : ray(r) {
+        for (int axis = 0; axis < 3; ++axis) {
+            invDirection[axis] = safeInverse(r.direction[axis]);
+            sign[axis] = r.direction[axis] < 0.0f;
+        }
+    }
+
+    // Large finite stand-in for 1/0 so parallel rays never produce 0 * inf = NaN in slab tests
+    static float safeInverse(float d) {
+        constexpr float EPS = 1e-20f;
+        return 1.0f / (std::abs(d) > EPS ? d : std::copysign(EPS, d));
+    }
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+#include "core/Vec3.h"
+#include <cmath>
+#include <type_traits>
+
+/**
+ * Transform - Affine transform stored as the top three rows of a 4x4 matrix.
+ * Columns 0-2 hold the linear part (rotation, scale), column 3 the translation.
+ */
+struct Transform {
+    float m[3][4];
+
+    static Transform identity() {
+        return {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}}};
+    }
+
+    static Transform translate(const Vec3& offset) {
+        return {{{1, 0, 0, offset.x}, {0, 1, 0, offset.y}, {0, 0, 1, offset.z}}};
+    }
+
+    static Transform scale(const Vec3& factor) {
+        return {{{factor.x, 0, 0, 0}, {0, factor.y, 0, 0}, {0, 0, factor.z, 0}}};
+    }
+
+    // Right-handed rotation by angle radians around a (not necessarily unit) axis
+    static Transform rotate(const Vec3& axis, float angle) {
+        Vec3 a = axis.normalized();
+        float c = std::cos(angle), s = std::sin(angle), k = 1.0f - c;
+        return {{
+            {a.x * a.x * k + c,       a.x * a.y * k - a.z * s, a.x * a.z * k + a.y * s, 0},
+            {a.y * a.x * k + a.z * s, a.y * a.y * k + c,       a.y * a.z * k - a.x * s, 0},
+            {a.z * a.x * k - a.y * s, a.z * a.y * k + a.x * s, a.z * a.z * k + c,       0}
+        }};
+    }
+
+    Point3 applyPoint(const Point3& p) const {
+        return Point3(m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+                      m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+                      m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3]);
+    }
+
+    Vec3 applyVector(const Vec3& v) const {
+        return Vec3(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+                    m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+                    m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
+    }
+
+    // Multiplies by the transposed linear part. Called on the inverse transform, this maps normals
+    Vec3 applyTransposed(const Vec3& v) const {
+        return Vec3(m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z,
+                    m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z,
+                    m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z);
+    }
+
+    // Assumes an invertible linear part
+    Transform inverse() const {
+        // Inverse of the linear part via cofactors
+        float c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+        float c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+        float c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+        float invDet = 1.0f / (m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02);
+
+        Transform r;
+        r.m[0][0] = c00 * invDet;
+        r.m[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * invDet;
+        r.m[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invDet;
+        r.m[1][0] = c01 * invDet;
+        r.m[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invDet;
+        r.m[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * invDet;
+        r.m[2][0] = c02 * invDet;
+        r.m[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * invDet;
+        r.m[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * invDet;
+
+        // Translation: -R^-1 * t
+        Vec3 t = r.applyVector(Vec3(m[0][3], m[1][3], m[2][3]));
+        r.m[0][3] = -t.x;
+        r.m[1][3] = -t.y;
+        r.m[2][3] = -t.z;
+        return r;
+    }
+};
+
+// Composition: (a * b) applies b first, then a
+inline Transform operator*(const Transform& a, const Transform& b) {
+    Transform r;
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            r.m[row][col] = a.m[row][0] * b.m[0][col] + a.m[row][1] * b.m[1][col] + a.m[row][2] * b.m[2][col];
+        }
+        r.m[row][3] += a.m[row][3];
+    }
+    return r;
+}
+
+static_assert(std::is_trivially_copyable_v<Transform>, "Transform must be trivially copyable!");
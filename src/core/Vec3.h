@@ -122,6 +122,10 @@ inline Vec3 lerp(const Vec3&a, const Vec3& b, float t) {
     return (1 - t) * a + t * b;
 }
 
+inline float luminance(const Vec3& color) { // Perceived brightness of a linear RGB color (Rec. 709 weights)
+    return 0.2126f * color.x + 0.7152f * color.y + 0.0722f * color.z;
+}
+
 inline std::ostream & operator << ( std::ostream & out, Vec3 v) {
     out << "[" << v.x << ", " << v.y << ", " << v.z << "]";
     return out;
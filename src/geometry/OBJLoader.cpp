@@ -0,0 +1,99 @@
+#include "geometry/OBJLoader.h"
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+namespace {
+
+const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+const char* skipToken(const char* p, const char* end) {
+    while (p < end && *p != ' ' && *p != '\t') ++p;
+    return p;
+}
+
+bool parseFloat(const char*& p, const char* end, float& value) {
+    p = skipSpaces(p, end);
+    if (p < end && *p == '+') ++p; // from_chars rejects a leading plus
+    auto [next, error] = std::from_chars(p, end, value);
+    if (error != std::errc{}) return false;
+    p = next;
+    return true;
+}
+
+} // namespace
+
+bool loadOBJ(const std::string& path, TriangleMesh& mesh) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+    return loadOBJ(file, mesh, path);
+}
+
+bool loadOBJ(std::istream& in, TriangleMesh& mesh, const std::string& name) {
+    mesh = TriangleMesh{};
+
+    std::string line;
+    std::vector<int> face;
+    size_t lineNumber = 0;
+    auto fail = [&](const char* message) {
+        std::cerr << "Error: " << name << ":" << lineNumber << ": " << message << std::endl;
+        mesh = TriangleMesh{};
+        return false;
+    };
+
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        const char* p = line.data();
+        const char* end = p + line.size();
+        while (end > p && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) --end;
+        p = skipSpaces(p, end);
+
+        const char* keyword = p;
+        p = skipToken(p, end);
+        std::string_view statement(keyword, p - keyword);
+
+        if (statement == "v") {
+            Point3 position;
+            if (!parseFloat(p, end, position.x) || !parseFloat(p, end, position.y) || !parseFloat(p, end, position.z))
+                return fail("expected three vertex coordinates");
+            mesh.vertices.push_back(position);
+        } else if (statement == "f") {
+            face.clear();
+            for (p = skipSpaces(p, end); p < end; p = skipSpaces(p, end)) {
+                int index;
+                auto [next, error] = std::from_chars(p, end, index);
+                if (error != std::errc{} || index == 0) return fail("invalid face vertex index");
+
+                // Positive indices count from 1, negative ones back from the last vertex read so far
+                index = index > 0 ? index - 1 : static_cast<int>(mesh.vertices.size()) + index;
+                if (index < 0) return fail("face vertex index out of range");
+                face.push_back(index);
+                p = skipToken(next, end); // Texture and normal references
+            }
+            if (face.size() < 3) return fail("face needs at least three vertices");
+
+            for (size_t i = 1; i + 1 < face.size(); ++i) {
+                mesh.indices.push_back(face[0]);
+                mesh.indices.push_back(face[i]);
+                mesh.indices.push_back(face[i + 1]);
+            }
+        }
+    }
+
+    // Positive indices may refer to vertices defined further down, so range checks wait for the whole file
+    for (int index : mesh.indices) {
+        if (index >= static_cast<int>(mesh.vertices.size())) {
+            std::cerr << "Error: " << name << ": face vertex index " << index + 1 << " out of range" << std::endl;
+            mesh = TriangleMesh{};
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "geometry/Triangle.h"
+#include <istream>
+#include <string>
+
+/**
+ * Reads vertex positions (v) and faces (f) of a Wavefront OBJ file into mesh, one line at a time, so only
+ * the mesh itself is held in memory. Polygons are fan-triangulated; v/vt/vn references and negative
+ * (relative) indices are accepted, texture coordinates, normals, groups and materials are skipped.
+ * Returns false after printing an error for unreadable files, malformed lines or out-of-range indices.
+ */
+bool loadOBJ(const std::string& path, TriangleMesh& mesh);
+
+// Same, from any stream. name only labels error messages
+bool loadOBJ(std::istream& in, TriangleMesh& mesh, const std::string& name = "OBJ");
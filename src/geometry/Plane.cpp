@@ -0,0 +1,39 @@
+#include "geometry/Plane.h"
+
+bool planeIntersect(
+    const Plane& plane,
+    const Ray& ray,
+    float tMin,
+    float& tClosest
+) {
+    // Points on plane: (P - Q) · N = 0. Substitute P = O + tD: t = (Q - O) · N / (D · N)
+    float denominator = dot(ray.direction, plane.normal);
+    if (denominator == 0.0f) return false; // Parallel
+
+    float t = dot(plane.point - ray.origin, plane.normal) / denominator;
+    if (t <= tMin || t >= tClosest) return false;
+
+    tClosest = t;
+    return true;
+}
+
+void planeHitRecord(
+    const Plane& plane,
+    HitRecord& record,
+    const Ray& ray,
+    float t
+) {
+    record.t = t;
+    record.position = ray.at(t);
+    record.setFaceNormal(ray.direction, plane.normal);
+    record.materialIndex = plane.materialIndex;
+}
+
+bool planeOccludes(
+    const Plane& plane,
+    const Ray& ray,
+    float tMin,
+    float tMax
+) {
+    return planeIntersect(plane, ray, tMin, tMax);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "core/HitRecord.h"
+#include "core/Vec3.h"
+#include "core/Ray.h"
+
+/**
+ * Plane - Infinite plane through point with unit normal. Unbounded, so it is never put in a BVH.
+ * The normal side is the outside.
+ */
+struct Plane {
+    Point3 point;
+    Vec3 normal;
+    int materialIndex;
+};
+
+// Distance-only test: lowers tClosest to the hit in (tMin, tClosest). Both sides are hit
+bool planeIntersect(
+    const Plane& plane,
+    const Ray& ray,
+    float tMin,
+    float& tClosest
+);
+
+// Fills record for a hit at distance t
+void planeHitRecord(
+    const Plane& plane,
+    HitRecord& record,
+    const Ray& ray,
+    float t
+);
+
+// Any-hit test: true if the ray hits the plane within (tMin, tMax)
+bool planeOccludes(
+    const Plane& plane,
+    const Ray& ray,
+    float tMin,
+    float tMax
+);
@@ -0,0 +1,198 @@
+#include "geometry/QuantizedSpheres.h"
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr float MaxStep = 65535.0f;
+
+// Rounding slack for decoding values up to magnitude: covers float error whether or not the decode is fused
+float decodeSlack(float magnitude) {
+    return 8.0f * FLT_EPSILON * magnitude;
+}
+
+} // namespace
+
+bool QuantizedSpheres::build(const std::vector<Sphere>& spheres) {
+    batches_.clear();
+    palette_.clear();
+    size_ = 0;
+
+    for (const Sphere& sphere : spheres) {
+        if (sphere.materialIndex < 0 || sphere.materialIndex > UINT16_MAX) return false;
+    }
+
+    // Exact radii when the set has few of them, as particle sets usually do
+    std::vector<float> radii;
+    radii.reserve(spheres.size());
+    for (const Sphere& sphere : spheres) radii.push_back(sphere.radius);
+    std::sort(radii.begin(), radii.end());
+    radii.erase(std::unique(radii.begin(), radii.end()), radii.end());
+    if (radii.size() <= MaxPaletteSize) palette_ = std::move(radii);
+
+    size_ = spheres.size();
+    batches_.assign((size_ + Lanes - 1) / Lanes, Batch{});
+
+    for (size_t b = 0; b < batches_.size(); ++b) {
+        Batch& batch = batches_[b];
+        size_t first = b * Lanes;
+        size_t last = std::min(first + Lanes, size_);
+
+        Vec3 lo{INFINITY}, hi{-INFINITY};
+        float minRadius = INFINITY, maxRadius = 0.0f;
+        for (size_t i = first; i < last; ++i) {
+            for (int axis = 0; axis < 3; ++axis) {
+                lo[axis] = std::min(lo[axis], spheres[i].center[axis]);
+                hi[axis] = std::max(hi[axis], spheres[i].center[axis]);
+            }
+            minRadius = std::min(minRadius, spheres[i].radius);
+            maxRadius = std::max(maxRadius, spheres[i].radius);
+        }
+
+        for (int axis = 0; axis < 3; ++axis) {
+            batch.origin[axis] = lo[axis];
+            batch.step[axis] = (hi[axis] - lo[axis]) / MaxStep;
+        }
+        batch.radiusStep = palette_.empty() ? (maxRadius - minRadius) / MaxStep * (1.0f + 4.0f * FLT_EPSILON) : 0.0f;
+
+        // Quantize centers to the nearest step and track how far the decoded centers moved
+        double centerError = 0.0;
+        float magnitude = 0.0f;
+        for (size_t i = first; i < last; ++i) {
+            int lane = static_cast<int>(i - first);
+            uint16_t* offsets[3] = {batch.x, batch.y, batch.z};
+            double distance2 = 0.0;
+            for (int axis = 0; axis < 3; ++axis) {
+                float step = batch.step[axis];
+                float q = step > 0.0f ? std::round((spheres[i].center[axis] - lo[axis]) / step) : 0.0f;
+                offsets[axis][lane] = static_cast<uint16_t>(std::clamp(q, 0.0f, MaxStep));
+
+                double decoded = static_cast<double>(lo[axis]) + static_cast<double>(offsets[axis][lane]) * step;
+                distance2 += (decoded - spheres[i].center[axis]) * (decoded - spheres[i].center[axis]);
+                magnitude = std::max({magnitude, std::abs(lo[axis]), std::abs(hi[axis])});
+            }
+            centerError = std::max(centerError, std::sqrt(distance2));
+            batch.material[lane] = static_cast<uint16_t>(spheres[i].materialIndex);
+        }
+
+        // Grow every radius by the worst center error, so each decoded sphere encloses its original
+        float slack = static_cast<float>(centerError) + decodeSlack(magnitude) + decodeSlack(maxRadius);
+        if (palette_.empty()) {
+            batch.radiusOffset = minRadius + slack;
+            for (size_t i = first; i < last; ++i) {
+                float above = spheres[i].radius - minRadius;
+                float q = batch.radiusStep > 0.0f ? std::ceil(above / batch.radiusStep) : 0.0f;
+                batch.radius[i - first] = static_cast<uint16_t>(std::min(q, MaxStep));
+            }
+        } else {
+            batch.radiusOffset = slack;
+            for (size_t i = first; i < last; ++i) {
+                auto entry = std::lower_bound(palette_.begin(), palette_.end(), spheres[i].radius);
+                batch.radius[i - first] = static_cast<uint16_t>(entry - palette_.begin());
+            }
+        }
+    }
+    return true;
+}
+
+Sphere QuantizedSpheres::get(size_t slot) const {
+    const Batch& batch = batches_[slot / Lanes];
+    size_t lane = slot % Lanes;
+
+    Point3 center{
+        batch.origin[0] + batch.x[lane] * batch.step[0],
+        batch.origin[1] + batch.y[lane] * batch.step[1],
+        batch.origin[2] + batch.z[lane] * batch.step[2]
+    };
+    float radius = batch.radiusOffset
+                 + (palette_.empty() ? batch.radius[lane] * batch.radiusStep : palette_[batch.radius[lane]]);
+    return {center, radius, batch.material[lane]};
+}
+
+// Batches are aligned to Lanes slots, so a leaf range is tested over the batches it overlaps with the rest masked
+int QuantizedSpheres::intersect(const Ray& ray, int first, int count, float tMin, float& tClosest) const {
+    int best = -1;
+    int end = first + count;
+
+#if defined(__AVX2__)
+    const __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y), oz = _mm256_set1_ps(ray.origin.z);
+    const __m256 dx = _mm256_set1_ps(ray.direction.x), dy = _mm256_set1_ps(ray.direction.y), dz = _mm256_set1_ps(ray.direction.z);
+    const __m256 tMinV = _mm256_set1_ps(tMin);
+    const __m256 inf = _mm256_set1_ps(INFINITY);
+    const __m256i laneIndex = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const bool palette = !palette_.empty();
+
+    auto decode = [](const uint16_t* values) {
+        return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values))));
+    };
+
+    // Decoded with a separate multiply and add, which needs no FMA beyond AVX2; decodeSlack() covers either rounding
+    for (int base = first - first % Lanes; base < end; base += Lanes) {
+        const Batch& batch = batches_[base / Lanes];
+
+        __m256 cx = _mm256_add_ps(_mm256_mul_ps(decode(batch.x), _mm256_set1_ps(batch.step[0])), _mm256_set1_ps(batch.origin[0]));
+        __m256 cy = _mm256_add_ps(_mm256_mul_ps(decode(batch.y), _mm256_set1_ps(batch.step[1])), _mm256_set1_ps(batch.origin[1]));
+        __m256 cz = _mm256_add_ps(_mm256_mul_ps(decode(batch.z), _mm256_set1_ps(batch.step[2])), _mm256_set1_ps(batch.origin[2]));
+
+        __m256 radius;
+        if (palette) {
+            __m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(batch.radius)));
+            radius = _mm256_add_ps(_mm256_i32gather_ps(palette_.data(), index, 4), _mm256_set1_ps(batch.radiusOffset));
+        } else {
+            radius = _mm256_add_ps(_mm256_mul_ps(decode(batch.radius), _mm256_set1_ps(batch.radiusStep)), _mm256_set1_ps(batch.radiusOffset));
+        }
+
+        __m256 ocx = _mm256_sub_ps(ox, cx);
+        __m256 ocy = _mm256_sub_ps(oy, cy);
+        __m256 ocz = _mm256_sub_ps(oz, cz);
+
+        __m256 halfB = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, ocx), _mm256_mul_ps(dy, ocy)), _mm256_mul_ps(dz, ocz));
+        __m256 ocLength2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, ocx), _mm256_mul_ps(ocy, ocy)), _mm256_mul_ps(ocz, ocz));
+        __m256 c = _mm256_sub_ps(ocLength2, _mm256_mul_ps(radius, radius));
+        __m256 discriminant = _mm256_sub_ps(_mm256_mul_ps(halfB, halfB), c);
+
+        __m256 sqrtD = _mm256_sqrt_ps(_mm256_max_ps(discriminant, _mm256_setzero_ps()));
+        __m256 tMinus = _mm256_sub_ps(_mm256_sub_ps(_mm256_setzero_ps(), halfB), sqrtD);
+        __m256 tPlus = _mm256_sub_ps(sqrtD, halfB);
+        __m256 t = _mm256_blendv_ps(tPlus, tMinus, _mm256_cmp_ps(tMinus, tMinV, _CMP_GT_OQ));
+
+        // Lanes outside [first, end) belong to neighbouring leaves or are padding
+        __m256i inRange = _mm256_and_si256(
+            _mm256_cmpgt_epi32(laneIndex, _mm256_set1_epi32(first - base - 1)),
+            _mm256_cmpgt_epi32(_mm256_set1_epi32(end - base), laneIndex));
+        __m256 valid = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(discriminant, _mm256_setzero_ps(), _CMP_GE_OQ), _mm256_castsi256_ps(inRange)),
+            _mm256_and_ps(_mm256_cmp_ps(t, tMinV, _CMP_GT_OQ),
+                          _mm256_cmp_ps(t, _mm256_set1_ps(tClosest), _CMP_LT_OQ)));
+        if (_mm256_movemask_ps(valid) == 0) continue;
+
+        // Horizontal minimum over the valid lanes, then pick the first lane holding it
+        __m256 tValid = _mm256_blendv_ps(inf, t, valid);
+        __m256 m = _mm256_min_ps(tValid, _mm256_permute2f128_ps(tValid, tValid, 1));
+        m = _mm256_min_ps(m, _mm256_permute_ps(m, 0b01001110));
+        m = _mm256_min_ps(m, _mm256_permute_ps(m, 0b10110001));
+
+        int lanes = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(tValid, m, _CMP_EQ_OQ), valid));
+        best = base + std::countr_zero(static_cast<unsigned>(lanes));
+        tClosest = _mm256_cvtss_f32(m);
+    }
+#else
+    for (int slot = first; slot < end; ++slot) {
+        if (sphereIntersect(get(slot), ray, tMin, tClosest))
+            best = slot;
+    }
+#endif
+
+    return best;
+}
+
+bool QuantizedSpheres::occludes(const Ray& ray, int first, int count, float tMin, float tMax) const {
+    float tClosest = tMax;
+    return intersect(ray, first, count, tMin, tClosest) >= 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "geometry/Sphere.h"
+#include "core/Ray.h"
+#include "util/AlignedAllocator.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * QuantizedSpheres - Compact leaf storage for large sphere sets, 14 bytes per sphere against 40 for full-precision
+ * spheres plus their SphereSoA copy. Slots are grouped in batches of Lanes consecutive slots. Batches are aligned
+ * to slots, not leaves: a batch may span several small leaves or part of a large one, but since slots are in BVH
+ * leaf order its spheres are still close together. Each batch stores its centers as 16-bit offsets within the
+ * batch's center bounds, and radii either as 16-bit steps over the batch's radius range or, when the whole set
+ * has at most MaxPaletteSize distinct radii, as indices into an exact radius palette.
+ *
+ * Decoding is conservative: every decoded sphere encloses its original, grown by the batch's worst center error,
+ * so rays that hit the original geometry never slip through cracks. Hits land slightly early, by at most that error.
+ */
+class QuantizedSpheres {
+public:
+    static constexpr int Lanes = 8;
+    static constexpr size_t MaxPaletteSize = 256;
+
+    /**
+     * Encodes spheres in slot order. Returns false, leaving the storage empty, if a material index does not
+     * fit in 16 bits.
+     */
+    bool build(const std::vector<Sphere>& spheres);
+
+    size_t size() const { return size_; }
+    bool hasPalette() const { return !palette_.empty(); }
+    size_t memoryBytes() const { return batches_.size() * sizeof(Batch) + palette_.size() * sizeof(float); }
+
+    // Decoded sphere in slot, which encloses the sphere that was encoded there
+    Sphere get(size_t slot) const;
+
+    /**
+     * Nearest decoded sphere among slots [first, first + count) with tMin < t < tClosest, decoded and tested a
+     * batch at a time. Returns its slot and lowers tClosest to its t, or returns -1. No HitRecord is built.
+     */
+    int intersect(const Ray& ray, int first, int count, float tMin, float& tClosest) const;
+
+    // Any-hit version of intersect()
+    bool occludes(const Ray& ray, int first, int count, float tMin, float tMax) const;
+
+private:
+    friend class SceneCache; // Reads and restores internal arrays
+
+    // Lanes consecutive slots sharing one quantization frame. 112 bytes, no padding
+    struct Batch {
+        float origin[3];        // Center decoded from offset 0
+        float step[3];          // Center distance per offset step, per axis
+        float radiusOffset;     // Added to every decoded radius: the worst center error, plus the smallest radius for 16-bit radii
+        float radiusStep;       // Radius per step for 16-bit radii, unused with a palette
+        uint16_t x[Lanes], y[Lanes], z[Lanes];
+        uint16_t radius[Lanes]; // Steps above the smallest radius, or a palette index
+        uint16_t material[Lanes];
+    };
+    static_assert(sizeof(Batch) == 8 * sizeof(float) + 5 * Lanes * sizeof(uint16_t), "Batch must stay unpadded");
+
+    std::vector<Batch, AlignedAllocator<Batch, 32>> batches_;
+    std::vector<float> palette_; // Sorted distinct radii, empty for 16-bit radii
+    size_t size_ = 0;
+};
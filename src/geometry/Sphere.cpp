@@ -11,6 +11,18 @@ bool sphereHit(
     const Ray& ray, 
     float tMin, 
     float tMax
+) {
+    if (!sphereIntersect(sphere, ray, tMin, tMax)) return false;
+
+    sphereHitRecord(sphere, record, ray, tMax);
+    return true;
+}
+
+bool sphereIntersect(
+    const Sphere& sphere,
+    const Ray& ray,
+    float tMin,
+    float& tClosest
 ) {
     // Points on sphere: |P - C|^2 = r^2 -> point P on sphere if its distance from center C is equal to radius
     // Points on ray:     P = O + tD 
@@ -31,19 +43,47 @@ bool sphereHit(
     float tMinus = (-halfB - std::sqrt(discriminant)) / a;
     float tPlus = (-halfB + std::sqrt(discriminant)) / a;
 
-    float t;
-    if (tMin < tMinus && tMinus < tMax ) 
-        t = tMinus;
-    else if (tMin < tPlus && tPlus < tMax ) 
-        t = tPlus;
+    if (tMin < tMinus && tMinus < tClosest) 
+        tClosest = tMinus;
+    else if (tMin < tPlus && tPlus < tClosest) 
+        tClosest = tPlus;
     else return false;
 
+    return true;
+}
+
+void sphereHitRecord(
+    const Sphere& sphere,
+    HitRecord& record,
+    const Ray& ray,
+    float t
+) {
     record.t = t;
     record.position = ray.at(t);
     Vec3 outwardNormal = (record.position - sphere.center).normalized();
     record.setFaceNormal(ray.direction, outwardNormal);
     record.materialIndex = sphere.materialIndex;
-    return true;
+}
+
+bool sphereOccludes(
+    const Sphere& sphere,
+    const Ray& ray,
+    float tMin,
+    float tMax
+) {
+    // Same quadratic as sphereHit
+    Vec3 oc = ray.origin - sphere.center;
+    float halfB = dot(ray.direction, oc);
+    float c = dot(oc, oc) - sphere.radius * sphere.radius;
+    float discriminant = halfB * halfB - c;
+
+    if (discriminant < 0) return false;
+
+    float sqrtD = std::sqrt(discriminant);
+    float tMinus = -halfB - sqrtD;
+    float tPlus = -halfB + sqrtD;
+
+    return (tMin < tMinus && tMinus < tMax) || (tMin < tPlus && tPlus < tMax);
 }
 
 AABB sphereBounds(const Sphere& sphere) {
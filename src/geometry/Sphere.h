@@ -22,4 +22,28 @@ bool sphereHit(
     float tMax
 );
 
+// Distance-only test: lowers tClosest to the nearest hit in (tMin, tClosest). Builds no hit record
+bool sphereIntersect(
+    const Sphere& sphere,
+    const Ray& ray,
+    float tMin,
+    float& tClosest
+);
+
+// Fills record for a hit at distance t found by any sphere test
+void sphereHitRecord(
+    const Sphere& sphere,
+    HitRecord& record,
+    const Ray& ray,
+    float t
+);
+
+// Any-hit test: true if the ray hits the sphere within (tMin, tMax). Skips hit record construction
+bool sphereOccludes(
+    const Sphere& sphere,
+    const Ray& ray,
+    float tMin,
+    float tMax
+);
+
 AABB sphereBounds(const Sphere& sphere);
\ No newline at end of file
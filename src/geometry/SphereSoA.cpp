@@ -0,0 +1,142 @@
+#include "geometry/SphereSoA.h"
+#include <bit>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+void SphereSoA::resize(size_t count) {
+    // One batch of padding past the last full batch, so a batch may start at any slot below count
+    size_t padded = (count + 2 * Lanes - 1) / Lanes * Lanes;
+    size_ = count;
+
+    cx_.assign(padded, 0.0f);
+    cy_.assign(padded, 0.0f);
+    cz_.assign(padded, 0.0f);
+    r2_.assign(padded, -INFINITY);
+    material_.assign(padded, 0);
+}
+
+void SphereSoA::set(size_t slot, const Sphere& sphere) {
+    cx_[slot] = sphere.center.x;
+    cy_[slot] = sphere.center.y;
+    cz_[slot] = sphere.center.z;
+    r2_[slot] = sphere.radius * sphere.radius;
+    material_[slot] = sphere.materialIndex;
+}
+
+void SphereSoA::setEmpty(size_t slot) {
+    cx_[slot] = cy_[slot] = cz_[slot] = 0.0f;
+    r2_[slot] = -INFINITY; // c = +inf, so the discriminant is never positive
+    material_[slot] = 0;
+}
+
+Sphere SphereSoA::get(size_t slot) const {
+    return {Point3{cx_[slot], cy_[slot], cz_[slot]}, std::sqrt(r2_[slot]), material_[slot]};
+}
+
+// The quadratic is the same as sphereHit: a = 1 for unit directions, half-b form, nearest root above tMin
+int SphereSoA::intersect(const Ray& ray, int first, int count, float tMin, float& tClosest) const {
+    int best = -1;
+
+#if defined(__AVX__)
+    const __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y), oz = _mm256_set1_ps(ray.origin.z);
+    const __m256 dx = _mm256_set1_ps(ray.direction.x), dy = _mm256_set1_ps(ray.direction.y), dz = _mm256_set1_ps(ray.direction.z);
+    const __m256 tMinV = _mm256_set1_ps(tMin);
+    const __m256 inf = _mm256_set1_ps(INFINITY);
+    const __m256 laneIndex = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (int base = first; base < first + count; base += Lanes) {
+        __m256 ocx = _mm256_sub_ps(ox, _mm256_loadu_ps(&cx_[base]));
+        __m256 ocy = _mm256_sub_ps(oy, _mm256_loadu_ps(&cy_[base]));
+        __m256 ocz = _mm256_sub_ps(oz, _mm256_loadu_ps(&cz_[base]));
+
+        __m256 halfB = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, ocx), _mm256_mul_ps(dy, ocy)), _mm256_mul_ps(dz, ocz));
+        __m256 ocLength2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, ocx), _mm256_mul_ps(ocy, ocy)), _mm256_mul_ps(ocz, ocz));
+        __m256 c = _mm256_sub_ps(ocLength2, _mm256_loadu_ps(&r2_[base]));
+        __m256 discriminant = _mm256_sub_ps(_mm256_mul_ps(halfB, halfB), c);
+
+        __m256 sqrtD = _mm256_sqrt_ps(_mm256_max_ps(discriminant, _mm256_setzero_ps()));
+        __m256 tMinus = _mm256_sub_ps(_mm256_sub_ps(_mm256_setzero_ps(), halfB), sqrtD);
+        __m256 tPlus = _mm256_sub_ps(sqrtD, halfB);
+        __m256 t = _mm256_blendv_ps(tPlus, tMinus, _mm256_cmp_ps(tMinus, tMinV, _CMP_GT_OQ));
+
+        __m256 valid = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(discriminant, _mm256_setzero_ps(), _CMP_GE_OQ),
+                          _mm256_cmp_ps(laneIndex, _mm256_set1_ps(static_cast<float>(first + count - base)), _CMP_LT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(t, tMinV, _CMP_GT_OQ),
+                          _mm256_cmp_ps(t, _mm256_set1_ps(tClosest), _CMP_LT_OQ)));
+        if (_mm256_movemask_ps(valid) == 0) continue;
+
+        // Horizontal minimum over the valid lanes, then pick the first lane holding it
+        __m256 tValid = _mm256_blendv_ps(inf, t, valid);
+        __m256 m = _mm256_min_ps(tValid, _mm256_permute2f128_ps(tValid, tValid, 1));
+        m = _mm256_min_ps(m, _mm256_permute_ps(m, 0b01001110));
+        m = _mm256_min_ps(m, _mm256_permute_ps(m, 0b10110001));
+
+        int lanes = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(tValid, m, _CMP_EQ_OQ), valid));
+        best = base + std::countr_zero(static_cast<unsigned>(lanes));
+        tClosest = _mm256_cvtss_f32(m);
+    }
+#elif defined(__SSE2__)
+    // Two 4-wide halves per batch
+    const __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+    const __m128 dx = _mm_set1_ps(ray.direction.x), dy = _mm_set1_ps(ray.direction.y), dz = _mm_set1_ps(ray.direction.z);
+    const __m128 tMinV = _mm_set1_ps(tMin);
+    const __m128 inf = _mm_set1_ps(INFINITY);
+    const __m128 laneIndex = _mm_setr_ps(0, 1, 2, 3);
+
+    for (int base = first; base < first + count; base += 4) {
+        __m128 ocx = _mm_sub_ps(ox, _mm_loadu_ps(&cx_[base]));
+        __m128 ocy = _mm_sub_ps(oy, _mm_loadu_ps(&cy_[base]));
+        __m128 ocz = _mm_sub_ps(oz, _mm_loadu_ps(&cz_[base]));
+
+        __m128 halfB = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, ocx), _mm_mul_ps(dy, ocy)), _mm_mul_ps(dz, ocz));
+        __m128 ocLength2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, ocx), _mm_mul_ps(ocy, ocy)), _mm_mul_ps(ocz, ocz));
+        __m128 c = _mm_sub_ps(ocLength2, _mm_loadu_ps(&r2_[base]));
+        __m128 discriminant = _mm_sub_ps(_mm_mul_ps(halfB, halfB), c);
+
+        __m128 sqrtD = _mm_sqrt_ps(_mm_max_ps(discriminant, _mm_setzero_ps()));
+        __m128 tMinus = _mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), halfB), sqrtD);
+        __m128 tPlus = _mm_sub_ps(sqrtD, halfB);
+        __m128 useMinus = _mm_cmpgt_ps(tMinus, tMinV);
+        __m128 t = _mm_or_ps(_mm_and_ps(useMinus, tMinus), _mm_andnot_ps(useMinus, tPlus));
+
+        __m128 valid = _mm_and_ps(
+            _mm_and_ps(_mm_cmpge_ps(discriminant, _mm_setzero_ps()),
+                       _mm_cmplt_ps(laneIndex, _mm_set1_ps(static_cast<float>(first + count - base)))),
+            _mm_and_ps(_mm_cmpgt_ps(t, tMinV), _mm_cmplt_ps(t, _mm_set1_ps(tClosest))));
+        if (_mm_movemask_ps(valid) == 0) continue;
+
+        __m128 tValid = _mm_or_ps(_mm_and_ps(valid, t), _mm_andnot_ps(valid, inf));
+        __m128 m = _mm_min_ps(tValid, _mm_shuffle_ps(tValid, tValid, 0b01001110));
+        m = _mm_min_ps(m, _mm_shuffle_ps(m, m, 0b10110001));
+
+        int lanes = _mm_movemask_ps(_mm_and_ps(_mm_cmpeq_ps(tValid, m), valid));
+        best = base + std::countr_zero(static_cast<unsigned>(lanes));
+        tClosest = _mm_cvtss_f32(m);
+    }
+#else
+    for (int slot = first; slot < first + count; ++slot) {
+        Vec3 oc = ray.origin - Point3{cx_[slot], cy_[slot], cz_[slot]};
+        float halfB = dot(ray.direction, oc);
+        float discriminant = halfB * halfB - (dot(oc, oc) - r2_[slot]);
+        if (discriminant < 0) continue;
+
+        float sqrtD = std::sqrt(discriminant);
+        float t = -halfB - sqrtD > tMin ? -halfB - sqrtD : -halfB + sqrtD;
+        if (t > tMin && t < tClosest) {
+            tClosest = t;
+            best = slot;
+        }
+    }
+#endif
+
+    return best;
+}
+
+bool SphereSoA::occludes(const Ray& ray, int first, int count, float tMin, float tMax) const {
+    float tClosest = tMax;
+    return intersect(ray, first, count, tMin, tClosest) >= 0;
+}
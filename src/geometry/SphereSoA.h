@@ -0,0 +1,45 @@
+#pragma once
+
+#include "geometry/Sphere.h"
+#include "core/Ray.h"
+#include "util/AlignedAllocator.h"
+#include <vector>
+
+/**
+ * SphereSoA - Spheres stored as structure-of-arrays (center x, y, z, radius squared, material),
+ * 32-byte aligned and padded to a multiple of 8, so one AVX register holds one component of 8 spheres.
+ * Slots are filled in BVH leaf order, so each leaf is a contiguous run of slots.
+ */
+class SphereSoA {
+public:
+    static constexpr int Lanes = 8;
+
+    // Resizes to count slots plus padding. Every slot starts empty
+    void resize(size_t count);
+
+    void set(size_t slot, const Sphere& sphere);
+    // A slot that never hits, for primitives that are not spheres
+    void setEmpty(size_t slot);
+
+    size_t size() const { return size_; }
+    bool isEmpty(size_t slot) const { return !(r2_[slot] >= 0.0f); }
+    Sphere get(size_t slot) const;
+
+    /**
+     * Nearest sphere among slots [first, first + count) with tMin < t < tClosest, tested Lanes at a time.
+     * Returns its slot and lowers tClosest to its t, or returns -1. No HitRecord is built.
+     */
+    int intersect(const Ray& ray, int first, int count, float tMin, float& tClosest) const;
+
+    // Any-hit version of intersect()
+    bool occludes(const Ray& ray, int first, int count, float tMin, float tMax) const;
+
+private:
+    template <typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T, 32>>;
+
+    AlignedVector<float> cx_, cy_, cz_;
+    AlignedVector<float> r2_; // Radius squared, -infinity for empty slots
+    AlignedVector<int> material_;
+    size_t size_ = 0;
+};
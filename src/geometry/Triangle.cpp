@@ -0,0 +1,68 @@
+#include "geometry/Triangle.h"
+#include <algorithm>
+
+bool triangleIntersect(
+    const Point3& p0,
+    const Point3& p1,
+    const Point3& p2,
+    const Ray& ray,
+    float tMin,
+    float& tClosest
+) {
+    // Solve O + tD = (1 - u - v) P0 + u P1 + v P2 with Cramer's rule, sharing the cross products
+    Vec3 edge1 = p1 - p0;
+    Vec3 edge2 = p2 - p0;
+
+    Vec3 p = cross(ray.direction, edge2);
+    float det = dot(edge1, p);
+    if (det == 0.0f) return false; // Ray parallel to the plane
+    float invDet = 1.0f / det;
+
+    Vec3 s = ray.origin - p0;
+    float u = dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    Vec3 q = cross(s, edge1);
+    float v = dot(ray.direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    float t = dot(edge2, q) * invDet;
+    if (t <= tMin || t >= tClosest) return false;
+
+    tClosest = t;
+    return true;
+}
+
+void triangleHitRecord(
+    const Point3& p0,
+    const Point3& p1,
+    const Point3& p2,
+    int materialIndex,
+    HitRecord& record,
+    const Ray& ray,
+    float t
+) {
+    record.t = t;
+    record.position = ray.at(t);
+    Vec3 outwardNormal = cross(p1 - p0, p2 - p0).normalized();
+    record.setFaceNormal(ray.direction, outwardNormal);
+    record.materialIndex = materialIndex;
+}
+
+bool triangleOccludes(
+    const Point3& p0,
+    const Point3& p1,
+    const Point3& p2,
+    const Ray& ray,
+    float tMin,
+    float tMax
+) {
+    return triangleIntersect(p0, p1, p2, ray, tMin, tMax);
+}
+
+AABB triangleBounds(const Point3& p0, const Point3& p1, const Point3& p2) {
+    return AABB{
+        Vec3{std::min({p0.x, p1.x, p2.x}), std::min({p0.y, p1.y, p2.y}), std::min({p0.z, p1.z, p2.z})},
+        Vec3{std::max({p0.x, p1.x, p2.x}), std::max({p0.y, p1.y, p2.y}), std::max({p0.z, p1.z, p2.z})}
+    };
+}
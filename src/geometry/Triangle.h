@@ -0,0 +1,60 @@
+#pragma once
+
+#include "core/HitRecord.h"
+#include "core/Vec3.h"
+#include "core/Ray.h"
+#include "accel/AABB.h"
+#include <vector>
+
+/**
+ * Triangle - Three indices into a shared vertex buffer, so meshes store each vertex once.
+ * Counterclockwise winding (seen from outside) defines the outward normal.
+ */
+struct Triangle {
+    int v0, v1, v2;
+    int materialIndex;
+};
+
+/**
+ * Möller–Trumbore test: lowers tClosest to the hit in (tMin, tClosest). Both faces are hit;
+ * rays parallel to the plane miss. Builds no hit record
+ */
+bool triangleIntersect(
+    const Point3& p0,
+    const Point3& p1,
+    const Point3& p2,
+    const Ray& ray,
+    float tMin,
+    float& tClosest
+);
+
+// Fills record for a hit at distance t, with the geometric normal
+void triangleHitRecord(
+    const Point3& p0,
+    const Point3& p1,
+    const Point3& p2,
+    int materialIndex,
+    HitRecord& record,
+    const Ray& ray,
+    float t
+);
+
+// Any-hit test: true if the ray hits the triangle within (tMin, tMax)
+bool triangleOccludes(
+    const Point3& p0,
+    const Point3& p1,
+    const Point3& p2,
+    const Ray& ray,
+    float tMin,
+    float tMax
+);
+
+AABB triangleBounds(const Point3& p0, const Point3& p1, const Point3& p2);
+
+/**
+ * TriangleMesh - Indexed triangle list: every three entries of indices form one triangle over vertices.
+ */
+struct TriangleMesh {
+    std::vector<Point3> vertices;
+    std::vector<int> indices;
+};
@@ -0,0 +1,116 @@
+#include "geometry/TriangleSoA.h"
+#include <bit>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+void TriangleSoA::resize(size_t count) {
+    // One batch of padding past the last full batch, so a batch may start at any slot below count
+    size_t padded = (count + 2 * Lanes - 1) / Lanes * Lanes;
+    size_ = count;
+
+    for (auto* array : {&v0x_, &v0y_, &v0z_, &e1x_, &e1y_, &e1z_, &e2x_, &e2y_, &e2z_})
+        array->assign(padded, 0.0f);
+}
+
+void TriangleSoA::set(size_t slot, const Point3& p0, const Point3& p1, const Point3& p2) {
+    Vec3 edge1 = p1 - p0;
+    Vec3 edge2 = p2 - p0;
+    v0x_[slot] = p0.x;    v0y_[slot] = p0.y;    v0z_[slot] = p0.z;
+    e1x_[slot] = edge1.x; e1y_[slot] = edge1.y; e1z_[slot] = edge1.z;
+    e2x_[slot] = edge2.x; e2y_[slot] = edge2.y; e2z_[slot] = edge2.z;
+}
+
+void TriangleSoA::setEmpty(size_t slot) {
+    set(slot, Point3{0.0f}, Point3{0.0f}, Point3{0.0f});
+}
+
+// Same steps and rejection tests as triangleIntersect(), one triangle per lane
+int TriangleSoA::intersect(const Ray& ray, int first, int count, float tMin, float& tClosest) const {
+    int best = -1;
+
+#if defined(__AVX__)
+    const __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y), oz = _mm256_set1_ps(ray.origin.z);
+    const __m256 dx = _mm256_set1_ps(ray.direction.x), dy = _mm256_set1_ps(ray.direction.y), dz = _mm256_set1_ps(ray.direction.z);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    const __m256 tMinV = _mm256_set1_ps(tMin);
+    const __m256 inf = _mm256_set1_ps(INFINITY);
+    const __m256 laneIndex = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (int base = first; base < first + count; base += Lanes) {
+        __m256 e1x = _mm256_loadu_ps(&e1x_[base]), e1y = _mm256_loadu_ps(&e1y_[base]), e1z = _mm256_loadu_ps(&e1z_[base]);
+        __m256 e2x = _mm256_loadu_ps(&e2x_[base]), e2y = _mm256_loadu_ps(&e2y_[base]), e2z = _mm256_loadu_ps(&e2z_[base]);
+
+        // p = D x edge2, det = edge1 . p
+        __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+        __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+        __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+        __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+        __m256 invDet = _mm256_div_ps(one, det);
+
+        // s = O - P0, u = (s . p) / det
+        __m256 sx = _mm256_sub_ps(ox, _mm256_loadu_ps(&v0x_[base]));
+        __m256 sy = _mm256_sub_ps(oy, _mm256_loadu_ps(&v0y_[base]));
+        __m256 sz = _mm256_sub_ps(oz, _mm256_loadu_ps(&v0z_[base]));
+        __m256 u = _mm256_mul_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)), invDet);
+
+        // q = s x edge1, v = (D . q) / det, t = (edge2 . q) / det
+        __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+        __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+        __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+        __m256 v = _mm256_mul_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)), invDet);
+        __m256 t = _mm256_mul_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), invDet);
+
+        // Ordered comparisons are false for the NaNs a zero determinant produces
+        __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(det, zero, _CMP_NEQ_OQ), _mm256_cmp_ps(u, zero, _CMP_GE_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+        __m256 valid = _mm256_and_ps(
+            _mm256_and_ps(inside, _mm256_cmp_ps(laneIndex, _mm256_set1_ps(static_cast<float>(first + count - base)), _CMP_LT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(t, tMinV, _CMP_GT_OQ), _mm256_cmp_ps(t, _mm256_set1_ps(tClosest), _CMP_LT_OQ)));
+        if (_mm256_movemask_ps(valid) == 0) continue;
+
+        // Horizontal minimum over the valid lanes, then pick the first lane holding it
+        __m256 tValid = _mm256_blendv_ps(inf, t, valid);
+        __m256 m = _mm256_min_ps(tValid, _mm256_permute2f128_ps(tValid, tValid, 1));
+        m = _mm256_min_ps(m, _mm256_permute_ps(m, 0b01001110));
+        m = _mm256_min_ps(m, _mm256_permute_ps(m, 0b10110001));
+
+        int lanes = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(tValid, m, _CMP_EQ_OQ), valid));
+        best = base + std::countr_zero(static_cast<unsigned>(lanes));
+        tClosest = _mm256_cvtss_f32(m);
+    }
+#else
+    for (int slot = first; slot < first + count; ++slot) {
+        Vec3 edge1{e1x_[slot], e1y_[slot], e1z_[slot]};
+        Vec3 edge2{e2x_[slot], e2y_[slot], e2z_[slot]};
+
+        Vec3 p = cross(ray.direction, edge2);
+        float det = dot(edge1, p);
+        if (det == 0.0f) continue;
+        float invDet = 1.0f / det;
+
+        Vec3 s = ray.origin - Point3{v0x_[slot], v0y_[slot], v0z_[slot]};
+        float u = dot(s, p) * invDet;
+        Vec3 q = cross(s, edge1);
+        float v = dot(ray.direction, q) * invDet;
+        float t = dot(edge2, q) * invDet;
+        if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > tMin && t < tClosest) {
+            tClosest = t;
+            best = slot;
+        }
+    }
+#endif
+
+    return best;
+}
+
+bool TriangleSoA::occludes(const Ray& ray, int first, int count, float tMin, float tMax) const {
+    float tClosest = tMax;
+    return intersect(ray, first, count, tMin, tClosest) >= 0;
+}
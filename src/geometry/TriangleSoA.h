@@ -0,0 +1,43 @@
+#pragma once
+
+#include "core/Ray.h"
+#include "core/Vec3.h"
+#include "util/AlignedAllocator.h"
+#include <vector>
+
+/**
+ * TriangleSoA - Triangles stored as structure-of-arrays of one vertex and two edges, ready for
+ * Möller–Trumbore. Same slot layout as SphereSoA: 32-byte aligned, padded so an 8-wide batch may start
+ * at any slot, filled in BVH leaf order.
+ */
+class TriangleSoA {
+public:
+    static constexpr int Lanes = 8;
+
+    // Resizes to count slots plus padding. Every slot starts empty
+    void resize(size_t count);
+
+    void set(size_t slot, const Point3& p0, const Point3& p1, const Point3& p2);
+    // A slot that never hits: zero edges make the determinant zero
+    void setEmpty(size_t slot);
+
+    size_t size() const { return size_; }
+
+    /**
+     * Nearest triangle among slots [first, first + count) with tMin < t < tClosest, tested Lanes at a time.
+     * Returns its slot and lowers tClosest to its t, or returns -1. Agrees with triangleIntersect().
+     */
+    int intersect(const Ray& ray, int first, int count, float tMin, float& tClosest) const;
+
+    // Any-hit version of intersect()
+    bool occludes(const Ray& ray, int first, int count, float tMin, float tMax) const;
+
+private:
+    template <typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T, 32>>;
+
+    AlignedVector<float> v0x_, v0y_, v0z_;
+    AlignedVector<float> e1x_, e1y_, e1z_;
+    AlignedVector<float> e2x_, e2y_, e2z_;
+    size_t size_ = 0;
+};
@@ -5,19 +5,14 @@
 #include "geometry/Sphere.h"
 #include "renderer/Camera.h"
 #include "renderer/Scene.h"
+#include "renderer/SceneCache.h"
+#include "renderer/SceneFile.h"
 #include "renderer/Renderer.h"
 #include "util/RNG.h"
 
 
-int main() {
-    // Image
-    const int imageWidth = 800;
-    const int imageHeight = 640;
-    const int samplesPerPixel = 75;
-    const int maxDepth = 8;
-
-    // Scene
-    Scene world;
+// Built-in demo scene, used when no scene file is given
+static void buildDemoScene(Scene& world, CameraSettings& camera) {
 
     // Materials
     int ground = world.addDiffuse(Color(0.5f, 0.5f, 0.5f));
@@ -39,7 +34,7 @@ int main() {
 
     int plastic = world.addPhysical(Color(0.4f, 0.4f, 0.4f), 0.3f, 0.3f );
 
-    world.addSphere(Color(0.0f, -1000.0f, 0.0f), 1000.0f, ground);
+    world.addPlane(Point3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), ground);
 
     world.addSphere(Point3(-0.6f, 1.0f, -3.0f), 1.0f, glass);
     world.addSphere(Point3(0.0f, 1.0f, -2.0f), 1.0f, brown);
@@ -75,25 +70,55 @@ int main() {
         
         world.addSphere(center, 0.25f, colors[rng.uniformInt(0, 7)]);
     }
-    world.build();
 
     // Camera setup - lower angle looking slightly up
-    Point3 cameraPosition{0.0f, 1.8f, 5.0f};  // Lower, closer
-    Point3 focusTarget{0.0f, 0.8f, -1.0f};    // Looking at hero spheres
-    float focusDistance = (focusTarget - cameraPosition).length();
+    camera.lookFrom = Point3{0.0f, 1.8f, 5.0f};  // Lower, closer
+    camera.lookAt = Point3{0.0f, 0.8f, -1.0f};   // Looking at hero spheres
+    camera.vUp = Vec3{0.0f, 1.0f, 0.0f};
+    camera.imageWidth = 800;
+    camera.imageHeight = 640;
+    camera.vFovDegrees = 50.0f;
+    camera.aperture = 0.0f;                      // Aperture for depth of field
+    camera.focusDistance = (camera.lookAt - camera.lookFrom).length();
+}
+
+/**
+ * Usage: raytracer [scene.rtscene]
+ * Renders the given binary scene file (see SceneFile, scene_convert), or the built-in demo scene.
+ */
+int main(int argc, char** argv) {
+    const int samplesPerPixel = 75;
+
+    Scene world;
+    CameraSettings settings;
+    if (argc > 1) {
+        if (!SceneFile::load(argv[1], world, settings)) return EXIT_FAILURE;
+    } else {
+        buildDemoScene(world, settings);
+    }
+
+    // Reuse the BVH from an earlier run while the scene is unchanged
+    const std::string cachePath = "renders/scene.cache";
+    uint64_t sceneHash = SceneCache::hash(world);
+    if (SceneCache::load(world, cachePath, sceneHash)) {
+        std::cout << "Loaded scene cache " << cachePath << std::endl;
+    } else {
+        world.build();
+        SceneCache::save(world, cachePath, sceneHash);
+    }
 
     Camera camera{
-        cameraPosition,
-        focusTarget,
-        Vec3{0.0f, 1.0f, 0.0f},
-        imageWidth, 
-        imageHeight, 
-        50.0f,           // FOV
-        0.0f,            // Aperture for depth of field
-        focusDistance
+        settings.lookFrom,
+        settings.lookAt,
+        settings.vUp,
+        settings.imageWidth,
+        settings.imageHeight,
+        settings.vFovDegrees,
+        settings.aperture,
+        settings.focusDistance
     };
 
-    Renderer renderer{imageWidth, imageHeight, samplesPerPixel};
+    Renderer renderer{settings.imageWidth, settings.imageHeight, samplesPerPixel};
     renderer.render(camera, world, "renders/output.ppm");
     
     return EXIT_SUCCESS;
@@ -1,4 +1,6 @@
-#include "materials./Sampling.h"
+#include "materials/Sampling.h"
+#include <algorithm>
+#include <numbers>
 
 Vec3 randomInUnitSphere(RNG& rng) {
     while(true) {
@@ -54,4 +56,34 @@ Vec3 sampleGGX(const Vec3& N, float alpha, RNG& rng) {
     return onb.toWorld(H_local);
 }
 
+// 1 - cos(thetaMax) of the cone a sphere subtends, or 0 from inside it. Small cones use the series
+// expansion, where 1 - sqrt(1 - x) would cancel to nothing in float
+static float coneSpread(const Point3& p, const Point3& center, float radius) {
+    float distance2 = (center - p).lengthSquared();
+    float sinThetaMax2 = radius * radius / distance2;
+    if (sinThetaMax2 >= 1.0f) return 0.0f;
+    return sinThetaMax2 < 1e-3f ? 0.5f * sinThetaMax2 * (1.0f + 0.25f * sinThetaMax2)
+                                : 1.0f - std::sqrt(1.0f - sinThetaMax2);
+}
+
+float sampleSphereSolidAngle(const Point3& p, const Point3& center, float radius, RNG& rng, Vec3& wi) {
+    float spread = coneSpread(p, center, radius);
+    if (spread <= 0.0f) return 0.0f;
+
+    float r1 = rng.uniform01();
+    float r2 = rng.uniform01();
 
+    float oneMinusCos = r1 * spread;
+    float cosTheta = 1.0f - oneMinusCos;
+    float sinTheta = std::sqrt(std::max(0.0f, oneMinusCos * (2.0f - oneMinusCos)));
+    float phi = 2.0f * std::numbers::pi_v<float> * r2;
+
+    ONB onb{(center - p).normalized()};
+    wi = onb.toWorld(Vec3(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta));
+    return 1.0f / (2.0f * std::numbers::pi_v<float> * spread);
+}
+
+float sphereSolidAnglePdf(const Point3& p, const Point3& center, float radius) {
+    float spread = coneSpread(p, center, radius);
+    return spread > 0.0f ? 1.0f / (2.0f * std::numbers::pi_v<float> * spread) : 0.0f;
+}
@@ -28,4 +28,13 @@ Vec3 randomInUnitSphere(RNG& rng);
 Vec3 reflect(const Vec3& dir, const Vec3& normal);
 Vec3 refract(const Vec3& dir, const Vec3& normal, float eta);
 
-Vec3 sampleGGX(const Vec3& N, float alpha, RNG& rng);
\ No newline at end of file
+Vec3 sampleGGX(const Vec3& N, float alpha, RNG& rng);
+
+/**
+ * Uniformly samples a direction inside the cone a sphere subtends from point p, so every sample sees the sphere.
+ * Returns the pdf in solid-angle measure, or 0 (leaving wi unset) when p is inside the sphere.
+ */
+float sampleSphereSolidAngle(const Point3& p, const Point3& center, float radius, RNG& rng, Vec3& wi);
+
+// Solid-angle pdf of sampleSphereSolidAngle() for any direction within the cone
+float sphereSolidAnglePdf(const Point3& p, const Point3& center, float radius);
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/Vec3.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * AdaptiveSampling - Settings for Renderer's adaptive mode. Every pixel first gets roundSamples samples; after
+ * that, each round gives another roundSamples to the pixels whose displayError() is still above maxError, until
+ * none are left or they reach maxSamples. The default threshold is about 4 of the 255 levels of an 8-bit image.
+ */
+struct AdaptiveSampling {
+    int roundSamples = 32;
+    int maxSamples = 1024;
+    float maxError = 0.015f;
+};
+
+/**
+ * PixelEstimate - Running mean color of a pixel's samples, plus the variance of their luminance, both updated
+ * one sample at a time with Welford's algorithm so long runs stay accurate in float.
+ */
+struct PixelEstimate {
+    // Luminance floor for displayError(), which would otherwise diverge for near-black pixels
+    static constexpr float MinLuminance = 0.01f;
+
+    Color mean{0.0f, 0.0f, 0.0f};
+    float luminanceMean = 0.0f;
+    float luminanceM2 = 0.0f; // Sum of squared luminance deviations from the mean
+    int count = 0;
+
+    void add(const Color& sample) {
+        ++count;
+        mean += (sample - mean) / static_cast<float>(count);
+
+        float value = luminance(sample);
+        float delta = value - luminanceMean;
+        luminanceMean += delta / static_cast<float>(count);
+        luminanceM2 += delta * (value - luminanceMean);
+    }
+
+    // Unbiased sample variance of the luminance
+    float variance() const { return count > 1 ? luminanceM2 / static_cast<float>(count - 1) : 0.0f; }
+
+    /**
+     * Standard error of the mean luminance as Film::output() displays it: gamma 2 encoding scales an error at
+     * luminance L by 1 / (2 sqrt(L)). Error relative to L alone would send most samples to dark pixels, whose
+     * noise is hardly visible. Unknown until there are two samples.
+     */
+    float displayError() const {
+        if (count < 2) return INFINITY;
+        return std::sqrt(variance() / static_cast<float>(count)) / (2.0f * std::sqrt(std::max(luminanceMean, MinLuminance)));
+    }
+
+    bool converged(const AdaptiveSampling& settings) const {
+        return count >= settings.maxSamples || displayError() <= settings.maxError;
+    }
+};
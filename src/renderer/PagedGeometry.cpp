@@ -0,0 +1,341 @@
+#include "PagedGeometry.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr char Magic[8] = {'R', 'T', 'P', 'A', 'G', 'E', 'S', '\0'};
+constexpr uint64_t PageAlignment = 4096; // Pages start on file system blocks, so a page read touches no neighbour
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t pageSpheres;
+    uint64_t pageCount;
+    uint64_t sphereCount;
+    uint64_t materialCount; // Bounds every sphere's material index, checked as pages are read
+};
+
+struct PageRecord {
+    AABB bounds;
+    int32_t sphereCount;
+    int32_t nodeCount;
+    int32_t rootIndex;
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+uint64_t pageBytes(int sphereCount, int nodeCount) {
+    return uint64_t(nodeCount) * sizeof(BVHNode) + uint64_t(sphereCount) * (sizeof(int) + sizeof(Sphere));
+}
+
+/**
+ * Splits spheres[start, end) at multiples of pageSpheres along the longest centroid axis until every range
+ * fits in one page, so pages are full and spatially compact (a kd-tree over page-sized groups).
+ */
+void partitionPages(std::vector<Sphere>& spheres, size_t start, size_t end, size_t pageSpheres) {
+    while (end - start > pageSpheres) {
+        AABB centroids = AABB::empty();
+        for (size_t i = start; i < end; ++i)
+            centroids = surroundingBox(centroids, AABB{spheres[i].center, spheres[i].center});
+
+        Vec3 extent = centroids.max - centroids.min;
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+        size_t pages = (end - start + pageSpheres - 1) / pageSpheres;
+        size_t mid = start + pages / 2 * pageSpheres;
+        std::nth_element(spheres.begin() + start, spheres.begin() + mid, spheres.begin() + end,
+                         [axis](const Sphere& a, const Sphere& b) { return a.center[axis] < b.center[axis]; });
+
+        partitionPages(spheres, start, mid, pageSpheres);
+        start = mid;
+    }
+}
+
+} // namespace
+
+bool PagedGeometry::write(const std::string& path, const std::vector<Sphere>& spheres, const PagedGeometryOptions& options) {
+    if (options.pageSpheres <= 0 || spheres.size() > size_t(INT_MAX)) {
+        std::cerr << "Error: Cannot page " << spheres.size() << " spheres by " << options.pageSpheres << std::endl;
+        return false;
+    }
+    if (std::any_of(spheres.begin(), spheres.end(), [](const Sphere& s) { return s.materialIndex < 0; })) {
+        std::cerr << "Error: Cannot page spheres with a negative material index" << std::endl;
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+
+    std::vector<Sphere> ordered = spheres;
+    size_t pageSpheres = static_cast<size_t>(options.pageSpheres);
+    partitionPages(ordered, 0, ordered.size(), pageSpheres);
+
+    FileHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.pageSpheres = options.pageSpheres;
+    header.pageCount = (ordered.size() + pageSpheres - 1) / pageSpheres;
+    header.sphereCount = ordered.size();
+    for (const Sphere& sphere : ordered)
+        header.materialCount = std::max<uint64_t>(header.materialCount, uint64_t(sphere.materialIndex) + 1);
+
+    // The page table goes after the header; pages follow, each aligned
+    std::vector<PageRecord> records(header.pageCount);
+    uint64_t offset = alignUp(sizeof(FileHeader) + records.size() * sizeof(PageRecord), PageAlignment);
+    const char padding[PageAlignment] = {};
+
+    for (size_t p = 0; p < records.size(); ++p) {
+        SceneObject page;
+        size_t first = p * pageSpheres;
+        size_t last = std::min(first + pageSpheres, ordered.size());
+        page.spheres_.assign(ordered.begin() + first, ordered.begin() + last);
+        page.bvh_.build(page, options.pageBuild);
+
+        const std::vector<BVHNode>& nodes = page.bvh_.nodes_;
+        const std::vector<int>& indices = page.bvh_.primitiveIndices_;
+        records[p] = {
+            page.bvh_.boundingBox(),
+            static_cast<int32_t>(page.spheres_.size()),
+            static_cast<int32_t>(nodes.size()),
+            page.bvh_.rootIndex_,
+            0,
+            offset
+        };
+
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(BVHNode));
+        file.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(int));
+        file.write(reinterpret_cast<const char*>(page.spheres_.data()), page.spheres_.size() * sizeof(Sphere));
+
+        uint64_t bytes = pageBytes(records[p].sphereCount, records[p].nodeCount);
+        offset = alignUp(offset + bytes, PageAlignment);
+    }
+    // Pad the last page so every page read stays inside the file
+    file.write(padding, (PageAlignment - file.tellp() % PageAlignment) % PageAlignment);
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(PageRecord));
+
+    if (!file) {
+        std::cerr << "Error: Could not write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool PagedGeometry::open(const std::string& path, size_t memoryBudget) {
+    if (!file_.open(path)) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+    auto fail = [&](const char* message) {
+        std::cerr << "Error: " << path << ": " << message << std::endl;
+        file_.close();
+        pages_.clear();
+        return false;
+    };
+
+    FileHeader header;
+    if (file_.size() < sizeof(FileHeader)) return fail("not a page file");
+    std::memcpy(&header, file_.data(), sizeof(FileHeader));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) return fail("not a page file");
+    if (header.version != Version) return fail("unsupported page file version");
+    if (header.pageSpheres <= 0 || header.sphereCount > size_t(INT_MAX)
+        || header.pageCount != (header.sphereCount + header.pageSpheres - 1) / header.pageSpheres
+        || header.pageCount > (file_.size() - sizeof(FileHeader)) / sizeof(PageRecord)
+        || header.materialCount > uint64_t(INT_MAX) + 1)
+        return fail("corrupt header");
+
+    std::vector<PageRecord> records(header.pageCount);
+    std::memcpy(records.data(), file_.data() + sizeof(FileHeader), records.size() * sizeof(PageRecord));
+
+    pages_.clear();
+    pages_.reserve(records.size());
+    for (size_t p = 0; p < records.size(); ++p) {
+        const PageRecord& record = records[p];
+        size_t expectedSpheres = std::min<size_t>(header.pageSpheres, header.sphereCount - p * header.pageSpheres);
+        if (size_t(record.sphereCount) != expectedSpheres || record.nodeCount <= 0
+            || record.rootIndex < 0 || record.rootIndex >= record.nodeCount
+            || record.offset > file_.size()
+            || pageBytes(record.sphereCount, record.nodeCount) > file_.size() - record.offset)
+            return fail("corrupt page table");
+
+        // Loaded pages also hold 8-wide SoA copies of their spheres
+        size_t soaBytes = alignUp(record.sphereCount, SphereSoA::Lanes) * 5 * sizeof(float);
+        pages_.push_back({
+            record.bounds,
+            record.offset,
+            record.sphereCount,
+            record.nodeCount,
+            record.rootIndex,
+            pageBytes(record.sphereCount, record.nodeCount) + soaBytes + sizeof(SceneObject)
+        });
+    }
+
+    sphereCount_ = header.sphereCount;
+    pageSpheres_ = header.pageSpheres;
+    materialCount_ = header.materialCount;
+    memoryBudget_ = memoryBudget;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        resident_.assign(pages_.size(), nullptr);
+        lru_.clear();
+        lruPosition_.assign(pages_.size(), lru_.end());
+        residentBytes_ = 0;
+        stats_ = {};
+    }
+
+    // One page per leaf, so a leaf's box is exactly the page it would read
+    BVHBuildOptions topOptions;
+    topOptions.maxLeafSize = 1;
+    top_.build(*this, topOptions);
+    return true;
+}
+
+bool PagedGeometry::closestHit(
+    PrimitiveHit& closest,
+    const Ray& ray,
+    float tMin
+) const {
+    return top_.closestHit(*this, closest, TraversalRay{ray}, tMin);
+}
+
+void PagedGeometry::finalizeHit(
+    const PrimitiveHit& closest,
+    HitRecord& record,
+    const Ray& ray
+) const {
+    // Usually still resident: the hit was found moments ago
+    page(closest.primitive / pageSpheres_)->finalizeHit({closest.t, closest.primitive % pageSpheres_}, record, ray);
+}
+
+bool PagedGeometry::occluded(
+    const Ray& ray,
+    float tMin,
+    float tMax
+) const {
+    return top_.occluded(*this, TraversalRay{ray}, tMin, tMax);
+}
+
+bool PagedGeometry::hitLeaf(
+    const int* indices,
+    int first,
+    int count,
+    const Ray& ray,
+    float tMin,
+    PrimitiveHit& closest
+) const {
+    bool hitAnything = false;
+    for (int i = first; i < first + count; ++i) {
+        int pageIndex = indices[i];
+        PrimitiveHit local{closest.t};
+        if (page(pageIndex)->closestHit(local, ray, tMin)) {
+            closest.t = local.t;
+            closest.primitive = pageIndex * pageSpheres_ + local.primitive;
+            hitAnything = true;
+        }
+    }
+    return hitAnything;
+}
+
+bool PagedGeometry::occludesLeaf(
+    const int* indices,
+    int first,
+    int count,
+    const Ray& ray,
+    float tMin,
+    float tMax
+) const {
+    for (int i = first; i < first + count; ++i) {
+        if (page(indices[i])->occluded(ray, tMin, tMax))
+            return true;
+    }
+    return false;
+}
+
+std::shared_ptr<const SceneObject> PagedGeometry::page(int pageIndex) const {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (resident_[pageIndex]) {
+            stats_.hits++;
+            lru_.splice(lru_.begin(), lru_, lruPosition_[pageIndex]);
+            return resident_[pageIndex];
+        }
+    }
+
+    // Read without the lock so other threads keep tracing resident pages meanwhile
+    std::shared_ptr<const SceneObject> loaded = readPage(pageIndex);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (resident_[pageIndex]) return resident_[pageIndex]; // Another thread read it first, and counted the miss
+
+    stats_.misses++;
+    stats_.bytesRead += pageBytes(pages_[pageIndex].sphereCount, pages_[pageIndex].nodeCount);
+    resident_[pageIndex] = loaded;
+    lru_.push_front(pageIndex);
+    lruPosition_[pageIndex] = lru_.begin();
+    residentBytes_ += pages_[pageIndex].memoryBytes;
+
+    // The newest page always stays, so a budget below one page still makes progress
+    while (residentBytes_ > memoryBudget_ && lru_.size() > 1) {
+        int victim = lru_.back();
+        lru_.pop_back();
+        resident_[victim].reset();
+        residentBytes_ -= pages_[victim].memoryBytes;
+        stats_.evictions++;
+    }
+    return loaded;
+}
+
+std::shared_ptr<const SceneObject> PagedGeometry::readPage(int pageIndex) const {
+    const PageInfo& info = pages_[pageIndex];
+    const char* data = file_.data() + info.offset;
+
+    auto page = std::make_shared<SceneObject>();
+    BVHTree& tree = page->bvh_;
+    tree.nodes_.resize(info.nodeCount);
+    tree.primitiveIndices_.resize(info.sphereCount);
+    page->spheres_.resize(info.sphereCount);
+
+    std::memcpy(tree.nodes_.data(), data, info.nodeCount * sizeof(BVHNode));
+    data += info.nodeCount * sizeof(BVHNode);
+    std::memcpy(tree.primitiveIndices_.data(), data, info.sphereCount * sizeof(int));
+    data += info.sphereCount * sizeof(int);
+    std::memcpy(page->spheres_.data(), data, info.sphereCount * sizeof(Sphere));
+    tree.rootIndex_ = info.rootIndex;
+
+    // open() only checked the page table. Ranges inside the page are checked here, before traversal follows them
+    bool validMaterials = std::all_of(page->spheres_.begin(), page->spheres_.end(), [&](const Sphere& s) {
+        return s.materialIndex >= 0 && size_t(s.materialIndex) < materialCount_;
+    });
+    if (!validMaterials || !tree.isValid(page->spheres_.size())) {
+        std::cerr << "Error: Page " << pageIndex << " is corrupt, tracing it as empty" << std::endl;
+        return std::make_shared<SceneObject>();
+    }
+
+    page->updateLeafData();
+    return page;
+}
+
+PageCacheStats PagedGeometry::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+size_t PagedGeometry::residentBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return residentBytes_;
+}
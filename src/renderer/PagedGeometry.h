@@ -0,0 +1,138 @@
+#pragma once
+#include "accel/BVH.h"
+#include "geometry/Sphere.h"
+#include "renderer/SceneObject.h"
+#include "util/MappedFile.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct PagedGeometryOptions {
+    int pageSpheres = 16384;   // Spheres per page. Every page but the last is full
+    BVHBuildOptions pageBuild; // Subtree built inside each page
+};
+
+/**
+ * Page cache counters since open(). Subtract two snapshots for per-frame figures.
+ */
+struct PageCacheStats {
+    uint64_t hits = 0;      // Page lookups served from memory
+    uint64_t misses = 0;    // Lookups that read the page from disk
+    uint64_t evictions = 0; // Pages dropped to stay under the memory budget
+    uint64_t bytesRead = 0;
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups > 0 ? static_cast<double>(hits) / lookups : 1.0;
+    }
+
+    PageCacheStats operator-(const PageCacheStats& earlier) const {
+        return {hits - earlier.hits, misses - earlier.misses, evictions - earlier.evictions, bytesRead - earlier.bytesRead};
+    }
+};
+
+/**
+ * PagedGeometry - Out-of-core sphere set for data larger than memory, such as point-cloud-derived spheres.
+ * write() splits the spheres into fixed-size, spatially compact pages, each with its own BVH subtree, and stores
+ * them in one file. After open(), the top of the tree (a BVH over page bounds) stays resident and its leaves fault
+ * pages in on demand through an LRU cache held under a memory budget. Queries are thread-safe.
+ * Placed into a Scene with Scene::addPagedGeometry(); sphere materials refer to that Scene's materials.
+ */
+class PagedGeometry {
+public:
+    static constexpr uint32_t Version = 2;
+
+    PagedGeometry() = default;
+    PagedGeometry(const PagedGeometry&) = delete;
+    PagedGeometry& operator=(const PagedGeometry&) = delete;
+
+    // Partitions spheres into pages, builds each page's subtree and writes the page file
+    static bool write(const std::string& path, const std::vector<Sphere>& spheres, const PagedGeometryOptions& options = {});
+
+    /**
+     * Opens a page file and builds the resident top tree. No page is read until a query reaches it; a page whose
+     * contents turn out corrupt then is reported and reads as empty.
+     */
+    bool open(const std::string& path, size_t memoryBudget);
+
+    // Same queries as SceneObject. closest.primitive is the sphere's index in page order
+    bool closestHit(
+        PrimitiveHit& closest,
+        const Ray& ray,
+        float tMin
+    ) const;
+    void finalizeHit(
+        const PrimitiveHit& closest,
+        HitRecord& record,
+        const Ray& ray
+    ) const;
+    bool occluded(
+        const Ray& ray,
+        float tMin,
+        float tMax
+    ) const;
+
+    AABB boundingBox() const { return top_.boundingBox(); }
+    size_t sphereCount() const { return sphereCount_; }
+    size_t pageCount() const { return pages_.size(); }
+    size_t materialCount() const { return materialCount_; } // One past the largest sphere material index
+    size_t memoryBudget() const { return memoryBudget_; }
+
+    // Returns a page, reading it if it is not resident. A page stays valid while held, even once evicted
+    std::shared_ptr<const SceneObject> page(int pageIndex) const;
+
+    PageCacheStats stats() const;
+    size_t residentBytes() const;
+
+    // Queries used by BVHTree for the top tree, whose primitives are pages. Leaves report sphere indices, not pages
+    size_t primitiveCount() const { return pages_.size(); }
+    AABB primitiveBounds(int pageIndex) const { return pages_[pageIndex].bounds; }
+    bool hitLeaf(
+        const int* indices,
+        int first,
+        int count,
+        const Ray& ray,
+        float tMin,
+        PrimitiveHit& closest
+    ) const;
+    bool occludesLeaf(
+        const int* indices,
+        int first,
+        int count,
+        const Ray& ray,
+        float tMin,
+        float tMax
+    ) const;
+
+private:
+    struct PageInfo {
+        AABB bounds;
+        uint64_t offset;    // Nodes, then primitive indices, then spheres
+        int sphereCount;
+        int nodeCount;
+        int rootIndex;
+        size_t memoryBytes; // Footprint once loaded, charged against the budget
+    };
+
+    MappedFile file_;
+    std::vector<PageInfo> pages_;
+    BVHTree top_;
+    size_t sphereCount_ = 0;
+    int pageSpheres_ = 0;
+    size_t materialCount_ = 0;
+    size_t memoryBudget_ = 0;
+
+    // LRU page cache, most recently used first. Loaded pages are indexed by page, null when not resident
+    mutable std::mutex mutex_;
+    mutable std::vector<std::shared_ptr<const SceneObject>> resident_;
+    mutable std::vector<std::list<int>::iterator> lruPosition_;
+    mutable std::list<int> lru_;
+    mutable size_t residentBytes_ = 0;
+    mutable PageCacheStats stats_;
+
+    // Copies a page out of the file into a ready-to-trace object
+    std::shared_ptr<const SceneObject> readPage(int pageIndex) const;
+};
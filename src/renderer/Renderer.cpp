@@ -1,10 +1,14 @@
 #include "renderer/Renderer.h"
+#include "renderer/PagedGeometry.h"
 #include "renderer/TraceRay.h"
+#include "renderer/WavefrontIntegrator.h"
 #include "core/Vec3.h"
 #include "util/RNG.h"
+#include <algorithm>
 #include <thread>
 #include <vector>
 #include <chrono>
+#include <filesystem>
 #include <iostream>
 
 using namespace std::chrono;
@@ -13,13 +17,15 @@ Renderer::Renderer(
     int imageWidth,
     int imageHeight,
     int samplesPerPixel,
-    int tileSize, int maxDepth
+    int tileSize, int maxDepth,
+    int rouletteDepth
 ) :   
     imageWidth_(imageWidth), 
     imageHeight_(imageHeight),
     samplesPerPixel_(samplesPerPixel),
     tileSize_(tileSize),
     maxDepth_(maxDepth),
+    rouletteDepth_(rouletteDepth),
     film_(imageWidth, imageHeight),
     queue_(imageWidth, imageHeight, tileSize) 
 {}
@@ -29,6 +35,19 @@ void Renderer::render(const Camera& camera, const Scene& scene, const std::strin
 
     auto start = high_resolution_clock::now();
 
+    std::vector<PageCacheStats> pageStats;
+    for (const auto& geometry : scene.getPagedGeometry())
+        pageStats.push_back(geometry->stats());
+    paths_ = 0;
+    segments_ = 0;
+    if (adaptive_ && integrator_ == Integrator::Wavefront) {
+        std::cerr << "Warning: Adaptive sampling is not supported by the wavefront integrator, using "
+                  << samplesPerPixel_ << " samples per pixel" << std::endl;
+    }
+    if (adaptiveActive() && packetPrimaryRays_)
+        std::cerr << "Warning: Packet primary rays are not used with adaptive sampling" << std::endl;
+    if (adaptiveActive()) sampleCounts_.assign(size_t(imageWidth_) * imageHeight_, 0);
+
     int numThreads = std::thread::hardware_concurrency();
     std::cout << "Starting Renderer with " << numThreads << " threads." << std::endl;
     std::vector<std::thread> threads;
@@ -47,22 +66,64 @@ void Renderer::render(const Camera& camera, const Scene& scene, const std::strin
         t.join();
 
     film_.output(path);
+    if (adaptiveActive()) outputSampleHeatmap(path);
 
     auto dur = high_resolution_clock::now() - start;
     std::cout << "Elapsed Time: " << duration_cast<seconds>(dur).count() << "s" << std::endl;
+    std::cout << "Average path length: " << static_cast<double>(segments_) / std::max<uint64_t>(paths_, 1)
+              << " segments (max depth " << maxDepth_ << ")" << std::endl;
+    if (adaptiveActive()) {
+        std::cout << "Adaptive sampling: " << static_cast<double>(paths_) / sampleCounts_.size() << " samples per pixel on average"
+                  << " (" << adaptiveSettings_.roundSamples << " to " << adaptiveSettings_.maxSamples << ")" << std::endl;
+    }
+
+    for (size_t i = 0; i < pageStats.size(); ++i) {
+        PageCacheStats frame = scene.getPagedGeometry()[i]->stats() - pageStats[i];
+        std::cout << "Paged geometry " << i << ": page cache hit rate " << 100.0 * frame.hitRate() << "%, "
+                  << frame.bytesRead / (1024.0 * 1024.0) << " MiB read, " << frame.evictions << " evictions" << std::endl;
+    }
 }
 
 void Renderer::renderWorker(int threadId, const Camera& camera, const Scene& scene) {
     RNG rng{globalSeed_, static_cast<uint64_t>(threadId)};
 
     Tile tile;
+    if (integrator_ == Integrator::Wavefront) {
+        WavefrontIntegrator wavefront{scene, camera, maxDepth_, rouletteDepth_};
+        std::vector<Color> pixels;
+        while(queue_.next(tile)) {
+            uint64_t tileSegments = wavefront.renderTile(tile, samplesPerPixel_, rng, pixels);
+
+            int width = tile.x1 - tile.x0;
+            for (int y = tile.y0; y < tile.y1; ++y) {
+                for (int x = tile.x0; x < tile.x1; ++x)
+                    film_.colorPixel(x, y, pixels[(y - tile.y0) * width + (x - tile.x0)]);
+            }
+            paths_ += uint64_t(tile.x1 - tile.x0) * (tile.y1 - tile.y0) * samplesPerPixel_;
+            segments_ += tileSegments;
+        }
+        return;
+    }
+
     while(queue_.next(tile)) {
+        if (adaptiveActive()) {
+            renderAdaptiveTile(tile, camera, scene, rng);
+            continue;
+        }
+
+        uint64_t tileSegments = 0;
         for (int y = tile.y0; y < tile.y1; ++y) {
+            if (packetPrimaryRays_) {
+                tileSegments += renderPacketRow(tile, y, camera, scene, rng);
+                continue;
+            }
             for (int x = tile.x0; x < tile.x1; ++x) {
                 Color pixelColor(0.0f, 0.0f, 0.0f);
                 for (int s = 0; s < samplesPerPixel_; ++s) {
                     Ray r = camera.shootRay(x, y, rng);
-                    pixelColor += traceRay(r, scene, rng, maxDepth_);
+                    int pathLength;
+                    pixelColor += traceRay(r, scene, rng, maxDepth_, rouletteDepth_, &pathLength);
+                    tileSegments += pathLength;
                 }
 
                 pixelColor /= static_cast<float>(samplesPerPixel_);
@@ -70,5 +131,101 @@ void Renderer::renderWorker(int threadId, const Camera& camera, const Scene& sce
                 film_.colorPixel(x, y, pixelColor);
             }
         }
+        paths_ += uint64_t(tile.x1 - tile.x0) * (tile.y1 - tile.y0) * samplesPerPixel_;
+        segments_ += tileSegments;
     }
-}
\ No newline at end of file
+}
+
+uint64_t Renderer::renderPacketRow(const Tile& tile, int y, const Camera& camera, const Scene& scene, RNG& rng) {
+    uint64_t rowSegments = 0;
+    for (int x0 = tile.x0; x0 < tile.x1; x0 += RayPacket::Size) {
+        int count = std::min(RayPacket::Size, tile.x1 - x0);
+        Color pixelColors[RayPacket::Size];
+        for (int lane = 0; lane < count; ++lane)
+            pixelColors[lane] = Color(0.0f, 0.0f, 0.0f);
+
+        for (int s = 0; s < samplesPerPixel_; ++s) {
+            Ray rays[RayPacket::Size];
+            PrimitiveHit hits[RayPacket::Size];
+            for (int lane = 0; lane < count; ++lane) {
+                rays[lane] = camera.shootRay(x0 + lane, y, rng);
+                hits[lane] = PrimitiveHit{INFINITY};
+            }
+            scene.closestHitPacket(hits, RayPacket{rays, count}, SHADOW_EPS);
+
+            for (int lane = 0; lane < count; ++lane) {
+                int pathLength;
+                pixelColors[lane] += traceRay(rays[lane], scene, rng, maxDepth_, rouletteDepth_, &pathLength, &hits[lane]);
+                rowSegments += pathLength;
+            }
+        }
+
+        for (int lane = 0; lane < count; ++lane)
+            film_.colorPixel(x0 + lane, y, pixelColors[lane] / static_cast<float>(samplesPerPixel_));
+    }
+    return rowSegments;
+}
+
+// Rounds go over the whole tile, so the pixels still refining are traced in scanline order each time
+void Renderer::renderAdaptiveTile(const Tile& tile, const Camera& camera, const Scene& scene, RNG& rng) {
+    int width = tile.x1 - tile.x0;
+    std::vector<PixelEstimate> estimates(size_t(width) * (tile.y1 - tile.y0));
+
+    uint64_t tilePaths = 0;
+    uint64_t tileSegments = 0;
+    bool refining = true;
+    while (refining) {
+        refining = false;
+        for (int y = tile.y0; y < tile.y1; ++y) {
+            for (int x = tile.x0; x < tile.x1; ++x) {
+                PixelEstimate& estimate = estimates[(y - tile.y0) * width + (x - tile.x0)];
+                if (estimate.count > 0 && estimate.converged(adaptiveSettings_)) continue;
+
+                int samples = std::min(adaptiveSettings_.roundSamples, adaptiveSettings_.maxSamples - estimate.count);
+                for (int s = 0; s < samples; ++s) {
+                    Ray r = camera.shootRay(x, y, rng);
+                    int pathLength;
+                    estimate.add(traceRay(r, scene, rng, maxDepth_, rouletteDepth_, &pathLength));
+                    tileSegments += pathLength;
+                }
+                tilePaths += std::max(samples, 0);
+                refining |= !estimate.converged(adaptiveSettings_);
+            }
+        }
+    }
+
+    for (int y = tile.y0; y < tile.y1; ++y) {
+        for (int x = tile.x0; x < tile.x1; ++x) {
+            const PixelEstimate& estimate = estimates[(y - tile.y0) * width + (x - tile.x0)];
+            film_.colorPixel(x, y, estimate.mean);
+            sampleCounts_[y * imageWidth_ + x] = estimate.count;
+        }
+    }
+    paths_ += tilePaths;
+    segments_ += tileSegments;
+}
+
+// Black at no samples through blue, green and yellow to red at the cap
+static Color heatmapColor(float t) {
+    static const Color ramp[] = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}};
+    constexpr int Segments = sizeof(ramp) / sizeof(ramp[0]) - 1;
+
+    float scaled = std::clamp(t, 0.0f, 1.0f) * Segments;
+    int segment = std::min(static_cast<int>(scaled), Segments - 1);
+    Color color = lerp(ramp[segment], ramp[segment + 1], scaled - segment);
+    return color * color; // Film::output() gamma corrects with a square root
+}
+
+void Renderer::outputSampleHeatmap(const std::string& path) const {
+    Film heatmap{imageWidth_, imageHeight_};
+    for (int y = 0; y < imageHeight_; ++y) {
+        for (int x = 0; x < imageWidth_; ++x) {
+            float t = static_cast<float>(sampleCounts_[y * imageWidth_ + x]) / adaptiveSettings_.maxSamples;
+            heatmap.colorPixel(x, y, heatmapColor(t));
+        }
+    }
+
+    std::filesystem::path heatmapPath{path};
+    heatmapPath.replace_filename(heatmapPath.stem().string() + "_spp" + heatmapPath.extension().string());
+    heatmap.output(heatmapPath.string());
+}
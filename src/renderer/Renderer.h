@@ -1,22 +1,63 @@
 #pragma once
 
+#include "renderer/AdaptiveSampling.h"
 #include "renderer/Camera.h"
 #include "renderer/Film.h"
 #include "renderer/TileQueue.h"
+#include "renderer/TraceRay.h"
 #include "renderer/Scene.h"
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 class Renderer {
 public: 
+    // How workers trace samples: traceRay() one sample at a time, or in large batches by WavefrontIntegrator
+    enum class Integrator : uint8_t {
+        Megakernel,
+        Wavefront
+    };
+
+    /**
+     * With rouletteDepth set, paths trace that many segments unconditionally, then Russian roulette ends dim ones
+     * early. Worth it for deep maxDepth in enclosed or glass-heavy scenes; sky-lit scenes, whose paths escape
+     * within a few bounces anyway, mostly trade the saved time for noise.
+     */
     Renderer(
         int imageWidth, 
         int imageHeight, 
         int samplesPerPixel, 
         int tileSize = 32, 
-        int maxDepth = 5
+        int maxDepth = 5,
+        int rouletteDepth = NoRoulette
     );
 
+    void setIntegrator(Integrator integrator) { integrator_ = integrator; }
+
+    /**
+     * Megakernel only: trace camera rays of RayPacket::Size neighbouring pixels in a row together through the
+     * scene's binary BVH, then continue each path on its own. Pays off for scenes of modest size at low spp,
+     * where primary rays are a large share of the work; on very large scenes the Wide8 single-ray default is faster.
+     * Not used while adaptive sampling is on.
+     */
+    void setPacketPrimaryRays(bool enabled) { packetPrimaryRays_ = enabled; }
+
+    /**
+     * Instead of samplesPerPixel samples everywhere, pixels are sampled in rounds until their estimated error
+     * falls below the threshold or they reach the cap, so flat regions such as open sky stop early and noisy ones
+     * get the budget. render() then also writes a heatmap of the samples each pixel took, next to the image as
+     * <name>_spp.ppm. Megakernel only: the wavefront integrator warns and renders samplesPerPixel samples. Takes
+     * precedence over packet primary rays, which render() warns about.
+     */
+    void setAdaptiveSampling(const AdaptiveSampling& settings) {
+        adaptive_ = true;
+        adaptiveSettings_ = settings;
+        adaptiveSettings_.roundSamples = std::max(adaptiveSettings_.roundSamples, 1);
+        adaptiveSettings_.maxSamples = std::max(adaptiveSettings_.maxSamples, adaptiveSettings_.roundSamples);
+    }
+
     void render(const Camera& camera, const Scene& scene, const std::string& path);
     void renderWorker(int threadId, const Camera& camera, const Scene& scene);
 
@@ -25,9 +66,30 @@ private:
     int samplesPerPixel_;
     int tileSize_;
     int maxDepth_;
+    int rouletteDepth_;
+    Integrator integrator_ = Integrator::Megakernel;
+    bool packetPrimaryRays_ = false;
+    bool adaptive_ = false;
+    AdaptiveSampling adaptiveSettings_;
 
     Film film_;
+    std::vector<int> sampleCounts_; // Samples each pixel took, in adaptive mode
     TileQueue queue_;
 
+    // Path statistics for the current frame, summed per tile by the workers
+    std::atomic<uint64_t> paths_{0};
+    std::atomic<uint64_t> segments_{0};
+
     const uint64_t globalSeed_ = 1215;
+
+    // Renders row y of tile with packet primary rays; returns the ray segments traced
+    uint64_t renderPacketRow(const Tile& tile, int y, const Camera& camera, const Scene& scene, RNG& rng);
+
+    // Renders tile in adaptive sampling rounds and adds its paths and segments to the frame statistics
+    void renderAdaptiveTile(const Tile& tile, const Camera& camera, const Scene& scene, RNG& rng);
+
+    void outputSampleHeatmap(const std::string& path) const;
+
+    // Adaptive sampling is set and the integrator supports it
+    bool adaptiveActive() const { return adaptive_ && integrator_ == Integrator::Megakernel; }
 };
\ No newline at end of file
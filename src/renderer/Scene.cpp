@@ -1,4 +1,5 @@
 #include "Scene.h"
+#include "PagedGeometry.h"
 #include <algorithm>
 
 int Scene::addDiffuse(const Color& color) {
@@ -81,8 +82,120 @@ int Scene::addSphere(const Point3& center, float radius, int materialIndex) {
     return index;
 }
 
-void Scene::build() {
-    bvh_.build(*this);
+int Scene::addPlane(const Point3& point, const Vec3& normal, int materialIndex) {
+    planes_.push_back({point, normal.normalized(), materialIndex});
+    return static_cast<int>(planes_.size() - 1);
+}
+
+int Scene::addTriangle(const Point3& p0, const Point3& p1, const Point3& p2, int materialIndex) {
+    int first = static_cast<int>(vertices_.size());
+    vertices_.insert(vertices_.end(), {p0, p1, p2});
+
+    int index = static_cast<int>(triangles_.size());
+    triangles_.push_back({first, first + 1, first + 2, materialIndex});
+    primitives_.push_back({PrimitiveType::Triangle, index});
+    return index;
+}
+
+int Scene::addMesh(const TriangleMesh& mesh, int materialIndex) {
+    int base = static_cast<int>(vertices_.size());
+    vertices_.insert(vertices_.end(), mesh.vertices.begin(), mesh.vertices.end());
+
+    int first = static_cast<int>(triangles_.size());
+    triangles_.reserve(triangles_.size() + mesh.indices.size() / 3);
+    primitives_.reserve(primitives_.size() + mesh.indices.size() / 3);
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        primitives_.push_back({PrimitiveType::Triangle, static_cast<int>(triangles_.size())});
+        triangles_.push_back({
+            base + mesh.indices[i],
+            base + mesh.indices[i + 1],
+            base + mesh.indices[i + 2],
+            materialIndex
+        });
+    }
+    return first;
+}
+
+int Scene::addObject(SceneObject object, const BVHBuildOptions& options, SphereStorage storage) {
+    object.build(options, storage);
+    objects_.push_back(std::move(object));
+    return static_cast<int>(objects_.size() - 1);
+}
+
+int Scene::addInstance(int objectIndex, const Transform& objectToWorld) {
+    int index = static_cast<int>(instances_.size());
+    instances_.push_back({
+        objectIndex,
+        objectToWorld,
+        objectToWorld.inverse()
+    });
+
+    primitives_.push_back({
+        PrimitiveType::Instance,
+        index
+    });
+    return index;
+}
+
+int Scene::addPagedGeometry(std::shared_ptr<const PagedGeometry> geometry) {
+    int index = static_cast<int>(pagedGeometry_.size());
+    pagedGeometry_.push_back(std::move(geometry));
+    primitives_.push_back({PrimitiveType::Paged, index});
+    return index;
+}
+
+void Scene::setInstanceTransform(int instanceIndex, const Transform& objectToWorld) {
+    Instance& instance = instances_[instanceIndex];
+    instance.objectToWorld = objectToWorld;
+    instance.worldToObject = objectToWorld.inverse();
+}
+
+void Scene::updateSphere(int sphereIndex, const Point3& center, float radius) {
+    Sphere& sphere = spheres_[sphereIndex];
+    sphere.center = center;
+    sphere.radius = radius;
+}
+
+void Scene::build(const BVHBuildOptions& options, BVHLayout layout) {
+    bvh_.build(*this, options);
+    buildOptions_ = options;
+
+    layout_ = layout;
+    bvh4_ = BVH4{};
+    bvh8_ = BVH8{};
+    quantizedBVH_ = QuantizedBVH{};
+    switch (layout_) {
+        case BVHLayout::Wide4: bvh4_.build(bvh_); break;
+        case BVHLayout::Wide8: bvh8_.build(bvh_); break;
+        case BVHLayout::Quantized4: quantizedBVH_.build(bvh_); break;
+        case BVHLayout::Binary: break;
+    }
+    updateLeafData();
+    collectLights();
+}
+
+bool Scene::refit() {
+    // Refitting keeps the primitive set, so anything added since the last build needs a full build
+    if (bvh_.getPrimitiveIndices().size() != primitives_.size()) {
+        build(buildOptions_, layout_);
+        return true;
+    }
+
+    bvh_.refit(*this);
+    if (bvh_.sahDegradation() > buildOptions_.rebuildThreshold) {
+        build(buildOptions_, layout_);
+        return true;
+    }
+
+    // Wide and quantized nodes are a straight copy of binary boxes, so collapsing again is linear as well
+    switch (layout_) {
+        case BVHLayout::Wide4: bvh4_.build(bvh_); break;
+        case BVHLayout::Wide8: bvh8_.build(bvh_); break;
+        case BVHLayout::Quantized4: quantizedBVH_.build(bvh_); break;
+        case BVHLayout::Binary: break;
+    }
+    updateLeafData();
+    return false;
 }
 
 bool Scene::intersect(
@@ -91,5 +204,374 @@ bool Scene::intersect(
     float tMin, 
     float tMax
 ) const {
-    return bvh_.hit(*this, record, ray, tMin, tMax);
+    PrimitiveHit closest{tMax};
+    if (!closestHit(closest, ray, tMin)) return false;
+
+    finalizeHit(closest, record, ray);
+    return true;
+}
+
+bool Scene::closestHit(
+    PrimitiveHit& closest,
+    const Ray& ray,
+    float tMin
+) const {
+    // Planes are outside the BVH. Testing them first lowers tMax, so traversal culls everything behind a hit
+    bool hitPlane = false;
+    for (size_t i = 0; i < planes_.size(); ++i) {
+        if (planeIntersect(planes_[i], ray, tMin, closest.t)) {
+            closest.primitive = static_cast<int>(primitives_.size() + i);
+            hitPlane = true;
+        }
+    }
+
+    if (primitives_.size() <= BruteForceLimit && bvh_.getPrimitiveIndices().size() == primitives_.size())
+        return hitLeaf(bvh_.getPrimitiveIndices().data(), 0, static_cast<int>(primitives_.size()), ray, tMin, closest) || hitPlane;
+
+    TraversalRay traversalRay{ray};
+    bool hitTree;
+    switch (layout_) {
+        case BVHLayout::Wide4: hitTree = bvh4_.closestHit(*this, closest, traversalRay, tMin); break;
+        case BVHLayout::Wide8: hitTree = bvh8_.closestHit(*this, closest, traversalRay, tMin); break;
+        case BVHLayout::Quantized4: hitTree = quantizedBVH_.closestHit(*this, closest, traversalRay, tMin); break;
+        default:               hitTree = bvh_.closestHit(*this, closest, traversalRay, tMin); break;
+    }
+    return hitTree || hitPlane;
+}
+
+int Scene::closestHitPacket(
+    PrimitiveHit* closest,
+    const RayPacket& packet,
+    float tMin
+) const {
+    int hits = 0;
+    for (int lane = 0; lane < packet.count; ++lane) {
+        for (size_t i = 0; i < planes_.size(); ++i) {
+            if (planeIntersect(planes_[i], packet.rays[lane], tMin, closest[lane].t)) {
+                closest[lane].primitive = static_cast<int>(primitives_.size() + i);
+                hits |= 1 << lane;
+            }
+        }
+    }
+
+    if (primitives_.size() <= BruteForceLimit && bvh_.getPrimitiveIndices().size() == primitives_.size()) {
+        for (int lane = 0; lane < packet.count; ++lane) {
+            if (hitLeaf(bvh_.getPrimitiveIndices().data(), 0, static_cast<int>(primitives_.size()), packet.rays[lane], tMin, closest[lane]))
+                hits |= 1 << lane;
+        }
+        return hits;
+    }
+
+    return bvh_.closestHitPacket(*this, closest, packet, tMin) | hits;
+}
+
+void Scene::finalizeHit(
+    const PrimitiveHit& closest,
+    HitRecord& record,
+    const Ray& ray
+) const {
+    if (closest.primitive >= static_cast<int>(primitives_.size())) {
+        planeHitRecord(planes_[closest.primitive - primitives_.size()], record, ray, closest.t);
+        return;
+    }
+
+    const PrimitiveRef& prim = primitives_[closest.primitive];
+    switch (prim.type) {
+        case PrimitiveType::Sphere:
+            sphereHitRecord(spheres_[prim.index], record, ray, closest.t);
+            break;
+        case PrimitiveType::Triangle: {
+            const Triangle& triangle = triangles_[prim.index];
+            triangleHitRecord(vertices_[triangle.v0], vertices_[triangle.v1], vertices_[triangle.v2],
+                              triangle.materialIndex, record, ray, closest.t);
+            break;
+        }
+        case PrimitiveType::Instance: {
+            const Instance& instance = instances_[prim.index];
+            float scale;
+            Ray localRay = objectRay(instance, ray, scale);
+            objects_[instance.objectIndex].finalizeHit({closest.t * scale, closest.subPrimitive}, record, localRay);
+
+            // Normals map with the inverse transpose, which keeps their side relative to the ray
+            record.t = closest.t;
+            record.position = ray.at(closest.t);
+            record.normal = instance.worldToObject.applyTransposed(record.normal).normalized();
+            break;
+        }
+        case PrimitiveType::Paged:
+            pagedGeometry_[prim.index]->finalizeHit({closest.t, closest.subPrimitive}, record, ray);
+            break;
+        default:
+            break;
+    }
+}
+
+bool Scene::occluded(
+    const Ray& ray,
+    float tMin,
+    float tMax
+) const {
+    for (const Plane& plane : planes_) {
+        if (planeOccludes(plane, ray, tMin, tMax))
+            return true;
+    }
+
+    if (primitives_.size() <= BruteForceLimit && bvh_.getPrimitiveIndices().size() == primitives_.size())
+        return occludesLeaf(bvh_.getPrimitiveIndices().data(), 0, static_cast<int>(primitives_.size()), ray, tMin, tMax);
+
+    TraversalRay traversalRay{ray};
+    switch (layout_) {
+        case BVHLayout::Wide4: return bvh4_.occluded(*this, traversalRay, tMin, tMax);
+        case BVHLayout::Wide8: return bvh8_.occluded(*this, traversalRay, tMin, tMax);
+        case BVHLayout::Quantized4: return quantizedBVH_.occluded(*this, traversalRay, tMin, tMax);
+        default:               return bvh_.occluded(*this, traversalRay, tMin, tMax);
+    }
+}
+
+AABB Scene::primitiveBounds(int primitiveIndex) const {
+    const PrimitiveRef& prim = primitives_[primitiveIndex];
+    switch (prim.type) {
+        case PrimitiveType::Sphere:
+            return sphereBounds(spheres_[prim.index]);
+        case PrimitiveType::Triangle: {
+            const Triangle& triangle = triangles_[prim.index];
+            return triangleBounds(vertices_[triangle.v0], vertices_[triangle.v1], vertices_[triangle.v2]);
+        }
+        case PrimitiveType::Instance: {
+            // World bounds of the transformed object box (Arvo): per output axis, take the min/max term of each column
+            const Instance& instance = instances_[prim.index];
+            AABB local = objects_[instance.objectIndex].boundingBox();
+            const auto& m = instance.objectToWorld.m;
+
+            AABB box;
+            for (int i = 0; i < 3; ++i) {
+                box.min[i] = box.max[i] = m[i][3];
+                for (int j = 0; j < 3; ++j) {
+                    float a = m[i][j] * local.min[j];
+                    float b = m[i][j] * local.max[j];
+                    box.min[i] += std::min(a, b);
+                    box.max[i] += std::max(a, b);
+                }
+            }
+            return box;
+        }
+        case PrimitiveType::Paged:
+            return pagedGeometry_[prim.index]->boundingBox();
+        default:
+            return AABB::empty();
+    }
+}
+
+bool Scene::intersectPrimitive(
+    int primitiveIndex,
+    const Ray& ray,
+    float tMin,
+    PrimitiveHit& closest
+) const {
+    const PrimitiveRef& prim = primitives_[primitiveIndex];
+    bool hit = false;
+    switch (prim.type) {
+        case PrimitiveType::Sphere:
+            hit = sphereIntersect(spheres_[prim.index], ray, tMin, closest.t);
+            break;
+        case PrimitiveType::Triangle: {
+            const Triangle& triangle = triangles_[prim.index];
+            hit = triangleIntersect(vertices_[triangle.v0], vertices_[triangle.v1], vertices_[triangle.v2], ray, tMin, closest.t);
+            break;
+        }
+        case PrimitiveType::Instance:
+            hit = intersectInstance(instances_[prim.index], ray, tMin, closest);
+            break;
+        case PrimitiveType::Paged: {
+            PrimitiveHit local{closest.t};
+            hit = pagedGeometry_[prim.index]->closestHit(local, ray, tMin);
+            if (hit) {
+                closest.t = local.t;
+                closest.subPrimitive = local.primitive;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    if (hit) closest.primitive = primitiveIndex;
+    return hit;
+}
+
+bool Scene::occludesPrimitive(
+    int primitiveIndex,
+    const Ray& ray,
+    float tMin,
+    float tMax
+) const {
+    const PrimitiveRef& prim = primitives_[primitiveIndex];
+    switch (prim.type) {
+        case PrimitiveType::Sphere:
+            return sphereOccludes(spheres_[prim.index], ray, tMin, tMax);
+        case PrimitiveType::Triangle: {
+            const Triangle& triangle = triangles_[prim.index];
+            return triangleOccludes(vertices_[triangle.v0], vertices_[triangle.v1], vertices_[triangle.v2], ray, tMin, tMax);
+        }
+        case PrimitiveType::Instance:
+            return occludesInstance(instances_[prim.index], ray, tMin, tMax);
+        case PrimitiveType::Paged:
+            return pagedGeometry_[prim.index]->occluded(ray, tMin, tMax);
+        default:
+            return false;
+    }
+}
+
+bool Scene::hitLeaf(
+    const int* indices,
+    int first,
+    int count,
+    const Ray& ray,
+    float tMin,
+    PrimitiveHit& closest
+) const {
+    bool hitAnything = false;
+    if (!inLeafOrder(indices)) {
+        for (int i = first; i < first + count; ++i)
+            hitAnything |= intersectPrimitive(indices[i], ray, tMin, closest);
+        return hitAnything;
+    }
+
+    // Each type's SoA kernel skips the other types' empty slots; instances and paged geometry go one by one
+    if (hasSpheres_) {
+        int slot = leafSpheres_.intersect(ray, first, count, tMin, closest.t);
+        if (slot >= 0) {
+            closest.primitive = indices[slot];
+            hitAnything = true;
+        }
+    }
+    if (hasTriangles_) {
+        int slot = leafTriangles_.intersect(ray, first, count, tMin, closest.t);
+        if (slot >= 0) {
+            closest.primitive = indices[slot];
+            hitAnything = true;
+        }
+    }
+    if (hasNested_) {
+        for (int i = first; i < first + count; ++i) {
+            PrimitiveType type = primitives_[indices[i]].type;
+            if (type == PrimitiveType::Instance || type == PrimitiveType::Paged)
+                hitAnything |= intersectPrimitive(indices[i], ray, tMin, closest);
+        }
+    }
+    return hitAnything;
+}
+
+bool Scene::occludesLeaf(
+    const int* indices,
+    int first,
+    int count,
+    const Ray& ray,
+    float tMin,
+    float tMax
+) const {
+    if (!inLeafOrder(indices)) {
+        for (int i = first; i < first + count; ++i) {
+            if (occludesPrimitive(indices[i], ray, tMin, tMax))
+                return true;
+        }
+        return false;
+    }
+
+    if (hasSpheres_ && leafSpheres_.occludes(ray, first, count, tMin, tMax))
+        return true;
+    if (hasTriangles_ && leafTriangles_.occludes(ray, first, count, tMin, tMax))
+        return true;
+    if (hasNested_) {
+        for (int i = first; i < first + count; ++i) {
+            PrimitiveType type = primitives_[indices[i]].type;
+            if ((type == PrimitiveType::Instance || type == PrimitiveType::Paged) && occludesPrimitive(indices[i], ray, tMin, tMax))
+                return true;
+        }
+    }
+    return false;
+}
+
+int Scene::hitLight(const PrimitiveHit& closest) const {
+    if (closest.primitive < 0 || closest.primitive >= static_cast<int>(primitives_.size())) return -1;
+    const PrimitiveRef& prim = primitives_[closest.primitive];
+    return prim.type == PrimitiveType::Sphere ? sphereLights_[prim.index] : -1;
+}
+
+void Scene::updateLeafData() {
+    hasSpheres_ = !spheres_.empty();
+    hasTriangles_ = !triangles_.empty();
+    hasNested_ = !instances_.empty() || !pagedGeometry_.empty();
+
+    // Storage only for the types present, so sphere-only scenes pay nothing for triangles and vice versa
+    const std::vector<int>& order = bvh_.getPrimitiveIndices();
+    leafSpheres_.resize(hasSpheres_ ? order.size() : 0);
+    leafTriangles_.resize(hasTriangles_ ? order.size() : 0);
+
+    for (size_t slot = 0; slot < order.size(); ++slot) {
+        const PrimitiveRef& prim = primitives_[order[slot]];
+        if (prim.type == PrimitiveType::Sphere) {
+            leafSpheres_.set(slot, spheres_[prim.index]);
+        } else if (prim.type == PrimitiveType::Triangle) {
+            const Triangle& triangle = triangles_[prim.index];
+            leafTriangles_.set(slot, vertices_[triangle.v0], vertices_[triangle.v1], vertices_[triangle.v2]);
+        }
+    }
+}
+
+void Scene::collectLights() {
+    lights_.clear();
+    sphereLights_.assign(spheres_.size(), -1);
+    for (size_t i = 0; i < spheres_.size(); ++i) {
+        // Geometry-only scenes (tests, tools) may reference materials that were never added
+        size_t material = static_cast<size_t>(spheres_[i].materialIndex);
+        if (material < materials_.size() && materials_[material].type == MaterialType::Emissive) {
+            sphereLights_[i] = static_cast<int>(lights_.size());
+            lights_.push_back(static_cast<int>(i));
+        }
+    }
+}
+
+bool Scene::inLeafOrder(const int* indices) const {
+    // Every layout stores the binary tree's primitive order, so slot i of any of them is leaf data slot i
+    return indices == bvh_.getPrimitiveIndices().data()
+        || indices == bvh4_.getPrimitiveIndices().data()
+        || indices == bvh8_.getPrimitiveIndices().data()
+        || indices == quantizedBVH_.getPrimitiveIndices().data();
+}
+
+Ray Scene::objectRay(const Instance& instance, const Ray& ray, float& scale) const {
+    // The object is traced with a unit-length ray, so distances scale by the transformed direction's length
+    Vec3 direction = instance.worldToObject.applyVector(ray.direction);
+    scale = direction.length();
+    return Ray{instance.worldToObject.applyPoint(ray.origin), direction};
+}
+
+bool Scene::intersectInstance(
+    const Instance& instance,
+    const Ray& ray,
+    float tMin,
+    PrimitiveHit& closest
+) const {
+    float scale;
+    Ray localRay = objectRay(instance, ray, scale);
+
+    PrimitiveHit local{closest.t * scale};
+    if (!objects_[instance.objectIndex].closestHit(local, localRay, tMin * scale))
+        return false;
+
+    closest.t = local.t / scale;
+    closest.subPrimitive = local.primitive;
+    return true;
+}
+
+bool Scene::occludesInstance(
+    const Instance& instance,
+    const Ray& ray,
+    float tMin,
+    float tMax
+) const {
+    float scale;
+    Ray localRay = objectRay(instance, ray, scale);
+
+    return objects_[instance.objectIndex].occluded(localRay, tMin * scale, tMax * scale);
 }
\ No newline at end of file
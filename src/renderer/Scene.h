@@ -1,26 +1,63 @@
 #pragma once
 #include "accel/BVH.h"
+#include "accel/WideBVH.h"
+#include "accel/QuantizedBVH.h"
+#include "core/Transform.h"
+#include "geometry/Plane.h"
 #include "geometry/Sphere.h"
+#include "geometry/SphereSoA.h"
+#include "geometry/Triangle.h"
+#include "geometry/TriangleSoA.h"
 #include "materials/Material.h"
+#include "renderer/SceneObject.h"
 #include "core/Vec3.h"
+#include <memory>
 #include <vector>
 #include <cstdint>
 
+class PagedGeometry;
+
 /**
- * Scene - Owns scene geometry and BVH acceleration structure
+ * Scene - Owns scene geometry and BVH acceleration structure.
+ * Loose spheres, mesh triangles and object instances share the top-level BVH; each instance's object has its own
+ * bottom-level BVH. Triangles index into one vertex buffer shared by every mesh. Paged geometry is a single
+ * top-level primitive whose spheres are read from disk as rays reach them.
  */
 class Scene {
 public:
     enum class PrimitiveType : uint8_t {
         Sphere,
         Triangle,
-        Plane
+        Plane, // Unbounded: kept in the plane list, never in primitives_ or the BVH
+        Instance,
+        Paged
     };
     
     struct PrimitiveRef {
         PrimitiveType type;
         int index;
     };
+
+    // Placement of a SceneObject. Both directions are kept so neither traversal nor bounds need an inverse
+    struct Instance {
+        int objectIndex;
+        Transform objectToWorld;
+        Transform worldToObject;
+    };
+
+    // Which hierarchy intersect() traverses. The binary tree is always built; wide trees are collapsed from it.
+    enum class BVHLayout : uint8_t {
+        Binary,
+        Wide4, // SSE
+        Wide8, // AVX
+        Quantized4 // 4-wide, one 64-byte node per cache line with 8-bit child bounds. For trees larger than cache
+    };
+
+#if defined(__AVX__)
+    static constexpr BVHLayout DefaultLayout = BVHLayout::Wide8;
+#else
+    static constexpr BVHLayout DefaultLayout = BVHLayout::Wide4;
+#endif
     
     // Material creation
     int addDiffuse(const Color& color);
@@ -31,9 +68,34 @@ public:
     
     // Geometry creation
     int addSphere(const Point3& center, float radius, int materialIndex);
+    int addTriangle(const Point3& p0, const Point3& p1, const Point3& p2, int materialIndex);
+
+    // Infinite plane, tested before BVH traversal instead of being put in the tree. Use for ground planes
+    int addPlane(const Point3& point, const Vec3& normal, int materialIndex);
+
+    // Appends the mesh's vertices to the shared buffer and adds one primitive per triangle. Returns the first triangle
+    int addMesh(const TriangleMesh& mesh, int materialIndex);
+
+    // Instancing. Objects are built once when added; instances only add a top-level primitive
+    int addObject(SceneObject object, const BVHBuildOptions& options = {}, SphereStorage storage = SphereStorage::Float);
+    int addInstance(int objectIndex, const Transform& objectToWorld);
+
+    // Out-of-core sphere set, opened by the caller and shared, with its page cache, by every copy of the scene
+    int addPagedGeometry(std::shared_ptr<const PagedGeometry> geometry);
+
+    // Geometry update. Moves a sphere without touching the BVH; call refit() once all updates for a frame are done
+    void updateSphere(int sphereIndex, const Point3& center, float radius);
+    void setInstanceTransform(int instanceIndex, const Transform& objectToWorld);
     
     // Build acceleration structure
-    void build();
+    void build(const BVHBuildOptions& options = {}, BVHLayout layout = DefaultLayout);
+
+    /**
+     * Updates the acceleration structure after primitives moved, keeping the tree topology (O(n)).
+     * Falls back to a full build with the last build's options once the SAH cost has degraded past
+     * BVHBuildOptions::rebuildThreshold. Returns true if it rebuilt.
+     */
+    bool refit();
     
     bool intersect(
         HitRecord& record, 
@@ -41,16 +103,140 @@ public:
         float tMin, 
         float tMax
     ) const;
+
+    /**
+     * First phase of intersect(): finds the nearest primitive (closest.t on entry is tMax) without building
+     * a HitRecord. finalizeHit() builds the record for it. closest.primitive values from primitiveCount()
+     * up name planes.
+     */
+    bool closestHit(
+        PrimitiveHit& closest,
+        const Ray& ray,
+        float tMin
+    ) const;
+    void finalizeHit(
+        const PrimitiveHit& closest,
+        HitRecord& record,
+        const Ray& ray
+    ) const;
+
+    /**
+     * closestHit() for a packet of coherent rays such as neighbouring camera rays, closest[lane].t on entry
+     * being each ray's tMax. Traced together through the binary tree, whatever the layout.
+     * Returns the mask of lanes that hit.
+     */
+    int closestHitPacket(
+        PrimitiveHit* closest,
+        const RayPacket& packet,
+        float tMin
+    ) const;
+
+    /**
+     * Any-hit visibility query for shadow rays: true if anything blocks the ray within (tMin, tMax).
+     * Stops at the first primitive found and never builds a HitRecord.
+     */
+    bool occluded(
+        const Ray& ray,
+        float tMin,
+        float tMax
+    ) const;
+
+    // Per-primitive queries used by the acceleration structures
+    size_t primitiveCount() const { return primitives_.size(); }
+    AABB primitiveBounds(int primitiveIndex) const;
+    bool intersectPrimitive(
+        int primitiveIndex,
+        const Ray& ray,
+        float tMin,
+        PrimitiveHit& closest
+    ) const;
+    bool occludesPrimitive(
+        int primitiveIndex,
+        const Ray& ray,
+        float tMin,
+        float tMax
+    ) const;
+
+    /**
+     * Leaf queries used by the acceleration structures: slots [first, first + count) of indices.
+     * When indices is one of this scene's own trees, spheres are tested as SIMD batches from leaf-ordered
+     * SoA storage. Other index arrays go primitive by primitive. Only closest is updated, no HitRecord is built.
+     */
+    bool hitLeaf(
+        const int* indices,
+        int first,
+        int count,
+        const Ray& ray,
+        float tMin,
+        PrimitiveHit& closest
+    ) const;
+    bool occludesLeaf(
+        const int* indices,
+        int first,
+        int count,
+        const Ray& ray,
+        float tMin,
+        float tMax
+    ) const;
+
+    // Index into getLights() of the light a closestHit() result landed on, or -1 for any other primitive
+    int hitLight(const PrimitiveHit& closest) const;
+
+    // Scenes this small are tested against every primitive without traversal
+    static constexpr size_t BruteForceLimit = 16;
     
     // Read-only access
     const std::vector<Sphere>& getSpheres() const { return spheres_; }
+    const std::vector<Plane>& getPlanes() const { return planes_; }
+    const std::vector<Point3>& getVertices() const { return vertices_; }
+    const std::vector<Triangle>& getTriangles() const { return triangles_; }
     const std::vector<Material>& getMaterials() const { return materials_; }
+    const std::vector<int>& getLights() const { return lights_; } // Emissive loose spheres, as indices into getSpheres()
     const std::vector<PrimitiveRef>& getPrimitives() const { return primitives_; }
+    const std::vector<SceneObject>& getObjects() const { return objects_; }
+    const std::vector<Instance>& getInstances() const { return instances_; }
+    const std::vector<std::shared_ptr<const PagedGeometry>>& getPagedGeometry() const { return pagedGeometry_; }
     const BVHTree& getBVH() const { return bvh_; }
+    const BVH4& getBVH4() const { return bvh4_; }
+    const BVH8& getBVH8() const { return bvh8_; }
+    const QuantizedBVH& getQuantizedBVH() const { return quantizedBVH_; }
+    BVHLayout getLayout() const { return layout_; }
     
 private:
+    friend class SceneCache; // Reads and restores internal arrays
+    friend class SceneFile;  // Loads geometry arrays in bulk
+
     std::vector<Sphere> spheres_;
+    std::vector<Plane> planes_;
+    std::vector<Point3> vertices_;
+    std::vector<Triangle> triangles_;
     std::vector<Material> materials_;
     std::vector<PrimitiveRef> primitives_;
+    std::vector<SceneObject> objects_;
+    std::vector<Instance> instances_;
+    std::vector<std::shared_ptr<const PagedGeometry>> pagedGeometry_;
+    std::vector<int> lights_;
+    std::vector<int> sphereLights_; // Light index per loose sphere, -1 if not emissive
     BVHTree bvh_;
+    BVH4 bvh4_;
+    BVH8 bvh8_;
+    QuantizedBVH quantizedBVH_;
+    BVHLayout layout_ = BVHLayout::Binary;
+    BVHBuildOptions buildOptions_;
+    // Primitives in bvh_ primitive index order, other types' slots left empty. Wide and quantized trees keep that order
+    SphereSoA leafSpheres_;
+    TriangleSoA leafTriangles_;
+    bool hasSpheres_ = false, hasTriangles_ = false; // Which leaf tests a scene needs
+    bool hasNested_ = false; // Instances or paged geometry, which leaves test one by one
+
+    // Refreshes leafSpheres_ after a build or refit
+    void updateLeafData();
+    // Rebuilds the light list from the loose spheres' materials
+    void collectLights();
+    bool inLeafOrder(const int* indices) const;
+
+    // Object-space ray for an instance, with the factor that converts world distances to object distances
+    Ray objectRay(const Instance& instance, const Ray& ray, float& scale) const;
+    bool intersectInstance(const Instance& instance, const Ray& ray, float tMin, PrimitiveHit& closest) const;
+    bool occludesInstance(const Instance& instance, const Ray& ray, float tMin, float tMax) const;
 };
\ No newline at end of file
@@ -0,0 +1,474 @@
+#include "SceneCache.h"
+#include "PagedGeometry.h"
+#include "util/MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+constexpr char Magic[8] = {'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0'};
+constexpr uint64_t SectionAlignment = 64;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t hash;
+};
+
+struct SectionEntry {
+    uint32_t elementSize; // Guards against struct layout changes the version number missed
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t offset;      // From the start of the file, SectionAlignment aligned
+};
+
+// Scalar BVH state that goes along with the node arrays
+struct TreeState {
+    BVHBuildOptions options;
+    int32_t rootIndex;
+    float builtSahCost;
+    Scene::BVHLayout layout;
+};
+
+// Scene sections, followed by ObjectSections per object
+enum Section : uint32_t {
+    Spheres,
+    Materials,
+    Primitives,
+    Instances,
+    SceneTree,
+    Nodes,
+    PrimitiveIndices,
+    Wide4Nodes,
+    Wide8Nodes,
+    QuantizedNodes,
+    Vertices,
+    Triangles,
+    Planes,
+    SceneSections
+};
+
+enum ObjectSection : uint32_t {
+    ObjectTree,
+    ObjectSpheres,
+    ObjectNodes,
+    ObjectPrimitiveIndices,
+    ObjectQuantizedBatches, // Empty for full-precision objects
+    ObjectRadiusPalette,
+    ObjectSections
+};
+
+/**
+ * 64-bit multiplicative hash over 8-byte words, FNV-style. Fields are added one by one wherever
+ * a struct has padding, so uninitialized bytes never reach the hash.
+ */
+struct Hasher {
+    uint64_t value = 14695981039346656037ull;
+
+    void bytes(const void* data, size_t size) {
+        const char* p = static_cast<const char*>(data);
+        for (; size >= 8; p += 8, size -= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, 8);
+            mix(word);
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, p, size);
+        mix(tail ^ (uint64_t{size} << 56));
+    }
+
+    template <typename T>
+    void add(const T& v) { bytes(&v, sizeof(T)); }
+
+    void mix(uint64_t word) {
+        value = (value ^ word) * 1099511628211ull;
+        value ^= value >> 29;
+    }
+};
+
+struct SectionSource {
+    const void* data;
+    uint32_t elementSize;
+    uint64_t count;
+};
+
+template <typename T, typename Allocator>
+SectionSource section(const std::vector<T, Allocator>& v) {
+    return {v.data(), sizeof(T), v.size()};
+}
+
+template <typename T>
+SectionSource section(const T& v) {
+    return {&v, sizeof(T), 1};
+}
+
+// Validated view of a mapped cache file
+class CacheReader {
+public:
+    explicit CacheReader(const MappedFile& file) : file_(file) {}
+
+    bool open(uint64_t hash) {
+        if (file_.size() < sizeof(FileHeader)) return false;
+        std::memcpy(&header_, file_.data(), sizeof(FileHeader));
+        if (std::memcmp(header_.magic, Magic, sizeof(Magic)) != 0) return false;
+        if (header_.version != SceneCache::Version || header_.hash != hash) return false;
+        if (header_.sectionCount < SceneSections || (header_.sectionCount - SceneSections) % ObjectSections != 0)
+            return false;
+
+        size_t tableSize = header_.sectionCount * sizeof(SectionEntry);
+        if (file_.size() < sizeof(FileHeader) + tableSize) return false;
+        sections_.resize(header_.sectionCount);
+        std::memcpy(sections_.data(), file_.data() + sizeof(FileHeader), tableSize);
+
+        for (const SectionEntry& entry : sections_) {
+            if (entry.offset % SectionAlignment != 0 || entry.offset > file_.size()) return false;
+            if (entry.elementSize != 0 && entry.count > (file_.size() - entry.offset) / entry.elementSize) return false;
+        }
+        return true;
+    }
+
+    size_t objectCount() const { return (header_.sectionCount - SceneSections) / ObjectSections; }
+
+    template <typename T, typename Allocator>
+    bool read(uint32_t index, std::vector<T, Allocator>& out) const {
+        const SectionEntry& entry = sections_[index];
+        if (entry.elementSize != sizeof(T)) return false;
+        out.resize(entry.count);
+        std::memcpy(out.data(), file_.data() + entry.offset, entry.count * sizeof(T));
+        return true;
+    }
+
+    template <typename T>
+    bool read(uint32_t index, T& out) const {
+        const SectionEntry& entry = sections_[index];
+        if (entry.elementSize != sizeof(T) || entry.count != 1) return false;
+        std::memcpy(&out, file_.data() + entry.offset, sizeof(T));
+        return true;
+    }
+
+private:
+    const MappedFile& file_;
+    FileHeader header_;
+    std::vector<SectionEntry> sections_;
+};
+
+bool inRange(int index, size_t size) {
+    return index >= 0 && static_cast<size_t>(index) < size;
+}
+
+/**
+ * BVHTree::isValid() for a wide or quantized tree: rooted at node 0, children after their parents and leaves
+ * inside the binary tree's primitive indices, which it shares.
+ */
+template <typename Node>
+bool validWideTree(const std::vector<Node>& nodes, size_t indexCount) {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node& node = nodes[i];
+        if (static_cast<size_t>(node.childCount) > std::size(node.child)) return false;
+        for (int lane = 0; lane < node.childCount; ++lane) {
+            int child = node.child[lane];
+            if (node.isLeaf(lane) && (child < 0 || size_t(child) + node.primitiveCount[lane] > indexCount)) return false;
+            if (!node.isLeaf(lane) && (child <= static_cast<int>(i) || !inRange(child, nodes.size()))) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+uint64_t SceneCache::hash(const Scene& scene, const BVHBuildOptions& options, Scene::BVHLayout layout) {
+    Hasher h;
+    h.add(Version);
+
+    static_assert(sizeof(Sphere) == 5 * sizeof(float), "Sphere must stay unpadded to be hashed as one block");
+    h.add(scene.spheres_.size());
+    h.bytes(scene.spheres_.data(), scene.spheres_.size() * sizeof(Sphere));
+
+    static_assert(sizeof(Point3) == 3 * sizeof(float) && sizeof(Triangle) == 4 * sizeof(int),
+                  "Vertices and triangles must stay unpadded to be hashed as one block");
+    h.add(scene.vertices_.size());
+    h.bytes(scene.vertices_.data(), scene.vertices_.size() * sizeof(Point3));
+    h.add(scene.triangles_.size());
+    h.bytes(scene.triangles_.data(), scene.triangles_.size() * sizeof(Triangle));
+
+    h.add(scene.planes_.size());
+    for (const Plane& plane : scene.planes_) {
+        h.add(plane.point);
+        h.add(plane.normal);
+        h.add(plane.materialIndex);
+    }
+
+    h.add(scene.materials_.size());
+    for (const Material& m : scene.materials_) {
+        h.add(m.type);
+        h.add(m.color);
+        h.add(m.roughness);
+        h.add(m.metallic);
+        h.add(m.ior);
+        h.add(m.emission);
+    }
+
+    h.add(scene.primitives_.size());
+    for (const Scene::PrimitiveRef& prim : scene.primitives_) {
+        h.add(prim.type);
+        h.add(prim.index);
+    }
+
+    h.add(scene.objects_.size());
+    for (const SceneObject& object : scene.objects_) {
+        const BVHBuildOptions& objectOptions = object.bvh_.options_;
+        h.add(objectOptions.method);
+        h.add(objectOptions.maxLeafSize);
+        h.add(objectOptions.binCount);
+        h.add(objectOptions.traversalCost);
+        h.add(objectOptions.intersectionCost);
+        h.add(object.spheres_.size());
+        h.bytes(object.spheres_.data(), object.spheres_.size() * sizeof(Sphere));
+
+        // Quantized objects no longer hold their spheres; the encoded batches stand in for them
+        const QuantizedSpheres& quantized = object.quantizedSpheres_;
+        h.add(quantized.size_);
+        h.bytes(quantized.batches_.data(), quantized.batches_.size() * sizeof(QuantizedSpheres::Batch));
+        h.bytes(quantized.palette_.data(), quantized.palette_.size() * sizeof(float));
+    }
+
+    h.add(scene.instances_.size());
+    for (const Scene::Instance& instance : scene.instances_) {
+        h.add(instance.objectIndex);
+        h.add(instance.objectToWorld);
+    }
+
+    // Paged spheres stay on disk; their page layout and bounds stand in for them
+    h.add(scene.pagedGeometry_.size());
+    for (const auto& geometry : scene.pagedGeometry_) {
+        h.add(geometry->sphereCount());
+        h.add(geometry->pageCount());
+        h.add(geometry->boundingBox());
+    }
+
+    // Thread count and rebuild threshold do not change the tree
+    h.add(options.method);
+    h.add(options.maxLeafSize);
+    h.add(options.binCount);
+    h.add(options.traversalCost);
+    h.add(options.intersectionCost);
+    h.add(layout);
+    return h.value;
+}
+
+bool SceneCache::save(const Scene& scene, const std::string& path, uint64_t hash) {
+    auto treeState = [](const BVHTree& tree, const BVHBuildOptions& options, Scene::BVHLayout layout) {
+        TreeState state{};
+        state.options = options;
+        state.rootIndex = tree.rootIndex_;
+        state.builtSahCost = tree.builtSahCost_;
+        state.layout = layout;
+        return state;
+    };
+    TreeState sceneTree = treeState(scene.bvh_, scene.buildOptions_, scene.layout_);
+
+    std::vector<SectionSource> sources(SceneSections);
+    sources[Spheres] = section(scene.spheres_);
+    sources[Materials] = section(scene.materials_);
+    sources[Primitives] = section(scene.primitives_);
+    sources[Instances] = section(scene.instances_);
+    sources[SceneTree] = section(sceneTree);
+    sources[Nodes] = section(scene.bvh_.nodes_);
+    sources[PrimitiveIndices] = section(scene.bvh_.primitiveIndices_);
+    sources[Wide4Nodes] = section(scene.bvh4_.nodes_);
+    sources[Wide8Nodes] = section(scene.bvh8_.nodes_);
+    sources[QuantizedNodes] = section(scene.quantizedBVH_.nodes_);
+    sources[Vertices] = section(scene.vertices_);
+    sources[Triangles] = section(scene.triangles_);
+    sources[Planes] = section(scene.planes_);
+
+    std::vector<TreeState> objectTrees;
+    objectTrees.reserve(scene.objects_.size());
+    for (const SceneObject& object : scene.objects_) {
+        objectTrees.push_back(treeState(object.bvh_, object.bvh_.options_, Scene::BVHLayout::Binary));
+        sources.push_back(section(objectTrees.back()));
+        sources.push_back(section(object.spheres_));
+        sources.push_back(section(object.bvh_.nodes_));
+        sources.push_back(section(object.bvh_.primitiveIndices_));
+        sources.push_back(section(object.quantizedSpheres_.batches_));
+        sources.push_back(section(object.quantizedSpheres_.palette_));
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.sectionCount = static_cast<uint32_t>(sources.size());
+    header.hash = hash;
+
+    std::vector<SectionEntry> table(sources.size());
+    uint64_t offset = sizeof(FileHeader) + table.size() * sizeof(SectionEntry);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        offset = (offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+        table[i] = {sources[i].elementSize, 0, sources[i].count, offset};
+        offset += sources[i].count * sources[i].elementSize;
+    }
+
+    std::filesystem::path filePath = path;
+    if (filePath.has_parent_path()) {
+        std::filesystem::create_directories(filePath.parent_path());
+    }
+
+    // Write to a temporary file and rename, so a concurrent or interrupted run never sees a partial cache
+    std::filesystem::path tempPath = filePath;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open " << tempPath << std::endl;
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(SectionEntry));
+
+        const char padding[SectionAlignment] = {};
+        uint64_t written = sizeof(FileHeader) + table.size() * sizeof(SectionEntry);
+        for (size_t i = 0; i < sources.size(); ++i) {
+            file.write(padding, table[i].offset - written);
+            file.write(static_cast<const char*>(sources[i].data), sources[i].count * sources[i].elementSize);
+            written = table[i].offset + sources[i].count * sources[i].elementSize;
+        }
+
+        if (!file) {
+            std::cerr << "Error: Could not write " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, filePath, error);
+    return !error;
+}
+
+bool SceneCache::load(Scene& scene, const std::string& path, uint64_t hash) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    CacheReader reader(file);
+    if (!reader.open(hash)) return false;
+
+    // Fill a fresh scene so a failed load leaves the caller's scene untouched
+    Scene loaded;
+    TreeState sceneTree;
+    bool ok = reader.read(Spheres, loaded.spheres_)
+           && reader.read(Materials, loaded.materials_)
+           && reader.read(Primitives, loaded.primitives_)
+           && reader.read(Instances, loaded.instances_)
+           && reader.read(SceneTree, sceneTree)
+           && reader.read(Nodes, loaded.bvh_.nodes_)
+           && reader.read(PrimitiveIndices, loaded.bvh_.primitiveIndices_)
+           && reader.read(Wide4Nodes, loaded.bvh4_.nodes_)
+           && reader.read(Wide8Nodes, loaded.bvh8_.nodes_)
+           && reader.read(QuantizedNodes, loaded.quantizedBVH_.nodes_)
+           && reader.read(Vertices, loaded.vertices_)
+           && reader.read(Triangles, loaded.triangles_)
+           && reader.read(Planes, loaded.planes_);
+    if (!ok) return false;
+
+    auto restoreTree = [](BVHTree& tree, const TreeState& state) {
+        tree.options_ = state.options;
+        tree.rootIndex_ = state.rootIndex;
+        tree.builtSahCost_ = state.builtSahCost;
+    };
+    restoreTree(loaded.bvh_, sceneTree);
+    loaded.buildOptions_ = sceneTree.options;
+    loaded.layout_ = sceneTree.layout;
+
+    // The reader checks section sizes, not contents: range-check every index before anything follows one
+    auto validMaterial = [&](int index) { return inRange(index, loaded.materials_.size()); };
+    auto validSpheres = [&](const std::vector<Sphere>& spheres) {
+        return std::all_of(spheres.begin(), spheres.end(), [&](const Sphere& s) { return validMaterial(s.materialIndex); });
+    };
+    auto validPrimitive = [&](const Scene::PrimitiveRef& prim) {
+        switch (prim.type) {
+            case Scene::PrimitiveType::Sphere: return inRange(prim.index, loaded.spheres_.size());
+            case Scene::PrimitiveType::Triangle: return inRange(prim.index, loaded.triangles_.size());
+            case Scene::PrimitiveType::Instance: return inRange(prim.index, loaded.instances_.size());
+            case Scene::PrimitiveType::Paged: return inRange(prim.index, scene.pagedGeometry_.size());
+            default: return false; // Planes never enter primitives_
+        }
+    };
+    auto validTriangle = [&](const Triangle& t) {
+        size_t vertices = loaded.vertices_.size();
+        return inRange(t.v0, vertices) && inRange(t.v1, vertices) && inRange(t.v2, vertices) && validMaterial(t.materialIndex);
+    };
+    auto validQuantized = [&](const QuantizedSpheres& quantized) {
+        for (size_t slot = 0; slot < quantized.size_; ++slot) {
+            const QuantizedSpheres::Batch& batch = quantized.batches_[slot / QuantizedSpheres::Lanes];
+            size_t lane = slot % QuantizedSpheres::Lanes;
+            if (!validMaterial(batch.material[lane])) return false;
+            if (!quantized.palette_.empty() && batch.radius[lane] >= quantized.palette_.size()) return false;
+        }
+        return true;
+    };
+    size_t primitiveCount = loaded.primitives_.size();
+    size_t indexCount = loaded.bvh_.primitiveIndices_.size();
+    ok = validSpheres(loaded.spheres_)
+      && std::all_of(loaded.triangles_.begin(), loaded.triangles_.end(), validTriangle)
+      && std::all_of(loaded.planes_.begin(), loaded.planes_.end(), [&](const Plane& p) { return validMaterial(p.materialIndex); })
+      && std::all_of(loaded.primitives_.begin(), loaded.primitives_.end(), validPrimitive)
+      && std::all_of(loaded.instances_.begin(), loaded.instances_.end(),
+                     [&](const Scene::Instance& instance) { return inRange(instance.objectIndex, reader.objectCount()); })
+      && loaded.bvh_.isValid(primitiveCount)
+      && validWideTree(loaded.bvh4_.nodes_, indexCount)
+      && validWideTree(loaded.bvh8_.nodes_, indexCount)
+      && validWideTree(loaded.quantizedBVH_.nodes_, indexCount);
+    if (!ok) return false;
+
+    // Wide trees share the binary tree's primitive order and bounds
+    for (auto* wide : {&loaded.bvh4_.primitiveIndices_, &loaded.bvh8_.primitiveIndices_, &loaded.quantizedBVH_.primitiveIndices_}) {
+        *wide = loaded.bvh_.primitiveIndices_;
+    }
+    loaded.bvh4_.bounds_ = loaded.bvh_.boundingBox();
+    loaded.bvh8_.bounds_ = loaded.bvh_.boundingBox();
+    loaded.quantizedBVH_.bounds_ = loaded.bvh_.boundingBox();
+
+    loaded.objects_.resize(reader.objectCount());
+    for (size_t i = 0; i < loaded.objects_.size(); ++i) {
+        SceneObject& object = loaded.objects_[i];
+        uint32_t base = SceneSections + static_cast<uint32_t>(i) * ObjectSections;
+
+        TreeState objectTree;
+        ok = reader.read(base + ObjectTree, objectTree)
+          && reader.read(base + ObjectSpheres, object.spheres_)
+          && reader.read(base + ObjectNodes, object.bvh_.nodes_)
+          && reader.read(base + ObjectPrimitiveIndices, object.bvh_.primitiveIndices_)
+          && reader.read(base + ObjectQuantizedBatches, object.quantizedSpheres_.batches_)
+          && reader.read(base + ObjectRadiusPalette, object.quantizedSpheres_.palette_);
+        if (!ok) return false;
+        restoreTree(object.bvh_, objectTree);
+
+        // Quantized spheres are stored in leaf order, one per primitive index
+        if (!object.quantizedSpheres_.batches_.empty()) {
+            size_t batches = (object.bvh_.primitiveIndices_.size() + QuantizedSpheres::Lanes - 1) / QuantizedSpheres::Lanes;
+            if (object.quantizedSpheres_.batches_.size() != batches) return false;
+            object.quantizedSpheres_.size_ = object.bvh_.primitiveIndices_.size();
+            object.storage_ = SphereStorage::Quantized;
+        }
+        size_t sphereCount = object.storage_ == SphereStorage::Quantized ? object.quantizedSpheres_.size_ : object.spheres_.size();
+        if (!validSpheres(object.spheres_) || !validQuantized(object.quantizedSpheres_)
+            || !object.bvh_.isValid(sphereCount))
+            return false;
+        object.updateLeafData();
+    }
+
+    // Paged geometry is opened by the caller, not cached
+    loaded.pagedGeometry_ = scene.pagedGeometry_;
+
+    // SoA leaf spheres are derived data, cheaper to rebuild than to store
+    loaded.updateLeafData();
+    loaded.collectLights();
+    scene = std::move(loaded);
+    return true;
+}
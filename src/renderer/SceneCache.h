@@ -0,0 +1,31 @@
+#pragma once
+#include "renderer/Scene.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * SceneCache - Versioned binary snapshot of a built Scene: geometry, materials and every BVH.
+ * Keyed by a content hash of the scene inputs and build settings, so a stale cache is never loaded.
+ * Arrays are stored in native byte order and struct layout: a per-machine cache, not an exchange format.
+ */
+class SceneCache {
+public:
+    static constexpr uint32_t Version = 5;
+
+    // Hash of everything Scene::build() depends on: geometry, materials, objects, instances, options and layout
+    static uint64_t hash(
+        const Scene& scene,
+        const BVHBuildOptions& options = {},
+        Scene::BVHLayout layout = Scene::DefaultLayout
+    );
+
+    // Writes a built scene. Returns false if the file cannot be written
+    static bool save(const Scene& scene, const std::string& path, uint64_t hash);
+
+    /**
+     * Replaces scene with the cached copy, ready to render without a build. The file is memory-mapped and each
+     * array is copied out in one block. Returns false, leaving scene untouched, if the file is missing, corrupt,
+     * from another format version or keyed by a different hash.
+     */
+    static bool load(Scene& scene, const std::string& path, uint64_t hash);
+};
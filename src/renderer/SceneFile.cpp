@@ -0,0 +1,370 @@
+#include "SceneFile.h"
+#include "util/MappedFile.h"
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr char Magic[8] = {'R', 'T', 'S', 'F', 'I', 'L', 'E', '\0'};
+constexpr uint64_t ChunkAlignment = 8;
+
+constexpr char MaterialChunk[4] = {'M', 'A', 'T', 'L'};
+constexpr char SphereChunk[4] = {'S', 'P', 'H', 'R'};
+constexpr char PlaneChunk[4] = {'P', 'L', 'A', 'N'};
+constexpr char CameraChunk[4] = {'C', 'A', 'M', 'R'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t chunkCount;
+};
+
+struct ChunkHeader {
+    char id[4];
+    uint32_t elementSize; // Lets readers reject or skip records they don't understand
+    uint64_t count;
+};
+
+struct MaterialRecord {
+    uint32_t type;
+    float color[3];
+    float roughness, metallic, ior;
+    float emission[3];
+};
+
+struct CameraRecord {
+    float lookFrom[3], lookAt[3], vUp[3];
+    int32_t imageWidth, imageHeight;
+    float vFovDegrees, aperture, focusDistance;
+};
+
+// Spheres and planes are stored exactly as they sit in memory
+static_assert(sizeof(Sphere) == 5 * 4 && sizeof(Plane) == 7 * 4, "Sphere and Plane must stay packed 4-byte words");
+
+// Every field in the format is a 4-byte word apart from chunk counts, so big-endian hosts swap word by word
+void swapWords(void* data, size_t bytes) {
+    if constexpr (std::endian::native == std::endian::big) {
+        auto* p = static_cast<unsigned char*>(data);
+        for (size_t i = 0; i + 4 <= bytes; i += 4) {
+            std::swap(p[i], p[i + 3]);
+            std::swap(p[i + 1], p[i + 2]);
+        }
+    }
+}
+
+uint64_t littleEndian(uint64_t value) {
+    if constexpr (std::endian::native == std::endian::big) {
+        uint64_t swapped = 0;
+        for (int i = 0; i < 8; ++i)
+            swapped = (swapped << 8) | ((value >> (8 * i)) & 0xff);
+        return swapped;
+    }
+    return value;
+}
+
+// Appends count records from data to out in one block
+template <typename T>
+void appendRecords(std::vector<T>& out, const char* data, uint64_t count) {
+    size_t first = out.size();
+    out.resize(first + count);
+    std::memcpy(out.data() + first, data, count * sizeof(T));
+    swapWords(out.data() + first, count * sizeof(T));
+}
+
+class ChunkWriter {
+public:
+    explicit ChunkWriter(std::ofstream& file) : file_(file) {}
+
+    void write(const char (&id)[4], const void* data, uint32_t elementSize, uint64_t count) {
+        ChunkHeader header{};
+        std::memcpy(header.id, id, 4);
+        header.elementSize = elementSize;
+        swapWords(&header.elementSize, 4);
+        header.count = littleEndian(count);
+        file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        uint64_t bytes = count * elementSize;
+        if constexpr (std::endian::native == std::endian::big) {
+            std::vector<char> swapped(static_cast<const char*>(data), static_cast<const char*>(data) + bytes);
+            swapWords(swapped.data(), bytes);
+            file_.write(swapped.data(), bytes);
+        } else {
+            file_.write(static_cast<const char*>(data), bytes);
+        }
+
+        const char padding[ChunkAlignment] = {};
+        file_.write(padding, (ChunkAlignment - bytes % ChunkAlignment) % ChunkAlignment);
+    }
+
+private:
+    std::ofstream& file_;
+};
+
+// True once only whitespace is left, clearing the failure an optional field that was absent leaves behind
+bool atEnd(std::istringstream& in) {
+    in.clear();
+    in >> std::ws;
+    return in.eof();
+}
+
+} // namespace
+
+bool SceneFile::load(const std::string& path, Scene& scene, CameraSettings& camera) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+    auto fail = [&](const char* message) {
+        std::cerr << "Error: " << path << ": " << message << std::endl;
+        return false;
+    };
+
+    FileHeader header;
+    if (file.size() < sizeof(FileHeader)) return fail("not a scene file");
+    std::memcpy(&header, file.data(), sizeof(FileHeader));
+    swapWords(&header.version, 8);
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) return fail("not a scene file");
+    if (header.version != Version) return fail("unsupported scene file version");
+
+    // Fill a fresh scene so a failed load leaves the caller's scene untouched
+    Scene loaded;
+    CameraSettings loadedCamera = camera;
+
+    uint64_t offset = sizeof(FileHeader);
+    for (uint32_t chunk = 0; chunk < header.chunkCount; ++chunk) {
+        ChunkHeader chunkHeader;
+        if (file.size() - offset < sizeof(ChunkHeader)) return fail("truncated chunk header");
+        std::memcpy(&chunkHeader, file.data() + offset, sizeof(ChunkHeader));
+        swapWords(&chunkHeader.elementSize, 4);
+        chunkHeader.count = littleEndian(chunkHeader.count);
+        offset += sizeof(ChunkHeader);
+
+        uint64_t size = chunkHeader.elementSize;
+        if (size == 0 || chunkHeader.count > (file.size() - offset) / size) return fail("truncated chunk");
+        const char* data = file.data() + offset;
+        uint64_t bytes = chunkHeader.count * size;
+        offset += (bytes + ChunkAlignment - 1) / ChunkAlignment * ChunkAlignment;
+        if (offset > file.size()) offset = file.size();
+
+        auto is = [&](const char (&id)[4], size_t elementSize) {
+            return std::memcmp(chunkHeader.id, id, 4) == 0 && size == elementSize;
+        };
+        if (is(SphereChunk, sizeof(Sphere))) {
+            appendRecords(loaded.spheres_, data, chunkHeader.count);
+        } else if (is(PlaneChunk, sizeof(Plane))) {
+            appendRecords(loaded.planes_, data, chunkHeader.count);
+        } else if (is(MaterialChunk, sizeof(MaterialRecord))) {
+            std::vector<MaterialRecord> records;
+            appendRecords(records, data, chunkHeader.count);
+            for (const MaterialRecord& record : records) {
+                if (record.type > static_cast<uint32_t>(MaterialType::Emissive)) return fail("unknown material type");
+                loaded.materials_.push_back({
+                    static_cast<MaterialType>(record.type),
+                    Color{record.color[0], record.color[1], record.color[2]},
+                    record.roughness,
+                    record.metallic,
+                    record.ior,
+                    Color{record.emission[0], record.emission[1], record.emission[2]}
+                });
+            }
+        } else if (is(CameraChunk, sizeof(CameraRecord)) && chunkHeader.count == 1) {
+            CameraRecord record;
+            std::memcpy(&record, data, sizeof(record));
+            swapWords(&record, sizeof(record));
+            if (record.imageWidth <= 0 || record.imageHeight <= 0) return fail("image size must be positive");
+            loadedCamera = {
+                Point3{record.lookFrom[0], record.lookFrom[1], record.lookFrom[2]},
+                Point3{record.lookAt[0], record.lookAt[1], record.lookAt[2]},
+                Vec3{record.vUp[0], record.vUp[1], record.vUp[2]},
+                record.imageWidth,
+                record.imageHeight,
+                record.vFovDegrees,
+                record.aperture,
+                record.focusDistance
+            };
+        }
+        // Anything else is a chunk from a newer writer: skipped
+    }
+
+    // One pass to validate material references and create the primitive list
+    int materialCount = static_cast<int>(loaded.materials_.size());
+    loaded.primitives_.resize(loaded.spheres_.size());
+    for (size_t i = 0; i < loaded.spheres_.size(); ++i) {
+        int material = loaded.spheres_[i].materialIndex;
+        if (material < 0 || material >= materialCount) return fail("sphere refers to a missing material");
+        float radius = loaded.spheres_[i].radius;
+        if (!std::isfinite(radius) || radius <= 0.0f) return fail("sphere radius must be positive");
+        loaded.primitives_[i] = {Scene::PrimitiveType::Sphere, static_cast<int>(i)};
+    }
+    for (const Plane& plane : loaded.planes_) {
+        if (plane.materialIndex < 0 || plane.materialIndex >= materialCount) return fail("plane refers to a missing material");
+    }
+
+    scene = std::move(loaded);
+    camera = loadedCamera;
+    return true;
+}
+
+bool SceneFile::save(const std::string& path, const Scene& scene, const CameraSettings& camera) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+    if (!scene.triangles_.empty() || !scene.objects_.empty()) {
+        std::cerr << "Warning: " << path << ": the format has no triangles or instances, dropping "
+                  << scene.triangles_.size() << " triangles and " << scene.objects_.size() << " objects" << std::endl;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.chunkCount = 4;
+    swapWords(&header.version, 8);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<MaterialRecord> materials;
+    materials.reserve(scene.materials_.size());
+    for (const Material& m : scene.materials_) {
+        materials.push_back({
+            static_cast<uint32_t>(m.type),
+            {m.color.x, m.color.y, m.color.z},
+            m.roughness,
+            m.metallic,
+            m.ior,
+            {m.emission.x, m.emission.y, m.emission.z}
+        });
+    }
+
+    CameraRecord cameraRecord{
+        {camera.lookFrom.x, camera.lookFrom.y, camera.lookFrom.z},
+        {camera.lookAt.x, camera.lookAt.y, camera.lookAt.z},
+        {camera.vUp.x, camera.vUp.y, camera.vUp.z},
+        camera.imageWidth,
+        camera.imageHeight,
+        camera.vFovDegrees,
+        camera.aperture,
+        camera.focusDistance
+    };
+
+    ChunkWriter writer(file);
+    writer.write(CameraChunk, &cameraRecord, sizeof(CameraRecord), 1);
+    writer.write(MaterialChunk, materials.data(), sizeof(MaterialRecord), materials.size());
+    writer.write(SphereChunk, scene.spheres_.data(), sizeof(Sphere), scene.spheres_.size());
+    writer.write(PlaneChunk, scene.planes_.data(), sizeof(Plane), scene.planes_.size());
+
+    if (!file) {
+        std::cerr << "Error: Could not write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SceneFile::loadText(const std::string& path, Scene& scene, CameraSettings& camera) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+
+    Scene loaded;
+    CameraSettings loadedCamera = camera;
+    std::unordered_map<std::string, int> materials;
+
+    std::string line;
+    size_t lineNumber = 0;
+    auto fail = [&](const char* message) {
+        std::cerr << "Error: " << path << ":" << lineNumber << ": " << message << std::endl;
+        return false;
+    };
+    auto material = [&](std::istringstream& in, int& index) {
+        std::string name;
+        if (!(in >> name)) return false;
+        auto it = materials.find(name);
+        if (it == materials.end()) return false;
+        index = it->second;
+        return true;
+    };
+
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        std::istringstream in(line.substr(0, line.find('#')));
+        std::string statement;
+        if (!(in >> statement)) continue;
+
+        if (statement == "camera") {
+            CameraSettings& c = loadedCamera;
+            if (!(in >> c.lookFrom.x >> c.lookFrom.y >> c.lookFrom.z >> c.lookAt.x >> c.lookAt.y >> c.lookAt.z
+                     >> c.vUp.x >> c.vUp.y >> c.vUp.z >> c.imageWidth >> c.imageHeight >> c.vFovDegrees))
+                return fail("expected camera from, at, up, width, height and vfov");
+            c.aperture = 0.0f;
+            c.focusDistance = (c.lookAt - c.lookFrom).length();
+            float value;
+            if (in >> value) {
+                c.aperture = value;
+                if (in >> value) c.focusDistance = value;
+            }
+            if (c.imageWidth <= 0 || c.imageHeight <= 0) return fail("image size must be positive");
+        } else if (statement == "material") {
+            std::string name, type;
+            if (!(in >> name >> type)) return fail("expected material name and type");
+            if (materials.count(name)) return fail("material defined twice");
+
+            Color color{0.0f};
+            float a = 0.0f, b = 0.0f;
+            int index;
+            if (type == "dielectric") {
+                if (!(in >> a)) return fail("expected index of refraction");
+                index = loaded.addDielectric(a);
+            } else {
+                if (!(in >> color.x >> color.y >> color.z)) return fail("expected material color");
+                if (type == "diffuse") {
+                    index = loaded.addDiffuse(color);
+                } else if (type == "metal") {
+                    in >> a;
+                    index = loaded.addMetal(color, a);
+                } else if (type == "physical") {
+                    if (in >> a) in >> b;
+                    index = loaded.addPhysical(color, a, b);
+                } else if (type == "emissive") {
+                    index = loaded.addEmissive(color);
+                } else {
+                    return fail("unknown material type");
+                }
+            }
+            materials[name] = index;
+        } else if (statement == "sphere") {
+            Point3 center;
+            float radius;
+            int index;
+            if (!(in >> center.x >> center.y >> center.z >> radius)) return fail("expected sphere center and radius");
+            if (!std::isfinite(radius) || radius <= 0.0f) return fail("sphere radius must be positive");
+            if (!material(in, index)) return fail("unknown material");
+            loaded.addSphere(center, radius, index);
+        } else if (statement == "plane") {
+            Point3 point;
+            Vec3 normal;
+            int index;
+            if (!(in >> point.x >> point.y >> point.z >> normal.x >> normal.y >> normal.z))
+                return fail("expected plane point and normal");
+            if (!material(in, index)) return fail("unknown material");
+            loaded.addPlane(point, normal, index);
+        } else {
+            return fail("unknown statement");
+        }
+
+        if (!atEnd(in)) return fail("unexpected text at end of line");
+    }
+
+    scene = std::move(loaded);
+    camera = loadedCamera;
+    return true;
+}
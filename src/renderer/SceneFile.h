@@ -0,0 +1,50 @@
+#pragma once
+#include "renderer/Scene.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * CameraSettings - Camera parameters as stored in a scene file, in Camera's constructor order.
+ */
+struct CameraSettings {
+    Point3 lookFrom{0.0f, 0.0f, 1.0f};
+    Point3 lookAt{0.0f, 0.0f, 0.0f};
+    Vec3 vUp{0.0f, 1.0f, 0.0f};
+    int imageWidth = 800;
+    int imageHeight = 600;
+    float vFovDegrees = 50.0f;
+    float aperture = 0.0f;
+    float focusDistance = 0.0f;
+};
+
+/**
+ * SceneFile - Portable scene description: materials, spheres, planes and camera.
+ *
+ * Binary form: a header followed by chunks, each a 4-character id, element size and count, then the packed
+ * little-endian elements. Sphere and plane chunks have the in-memory layout of Sphere and Plane, so loading
+ * maps the file and copies each chunk into the Scene's arrays in one block. Unknown chunks are skipped.
+ *
+ * Text form, one statement per line, '#' starts a comment:
+ *   camera fromX fromY fromZ atX atY atZ upX upY upZ width height vfov [aperture [focusDistance]]
+ *   material name diffuse r g b | metal r g b [roughness] | physical r g b [metallic [roughness]]
+ *                 | dielectric ior | emissive r g b
+ *   sphere x y z radius material
+ *   plane pointX pointY pointZ normalX normalY normalZ material
+ */
+class SceneFile {
+public:
+    static constexpr uint32_t Version = 1;
+
+    /**
+     * Replaces scene with the file's materials and geometry, unbuilt, and reads its camera if it has one.
+     * Returns false, leaving scene untouched, if the file is missing, corrupt, refers to missing materials or holds
+     * a nonpositive image size or sphere radius.
+     */
+    static bool load(const std::string& path, Scene& scene, CameraSettings& camera);
+
+    // Writes the scene's materials, spheres and planes with camera. Triangles and instances are not stored: warns if any
+    static bool save(const std::string& path, const Scene& scene, const CameraSettings& camera);
+
+    // Parses the text form into an unbuilt scene. Prints the offending line and returns false on errors
+    static bool loadText(const std::string& path, Scene& scene, CameraSettings& camera);
+};
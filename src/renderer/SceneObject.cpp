@@ -0,0 +1,132 @@
+#include "SceneObject.h"
+#include <iostream>
+
+int SceneObject::addSphere(const Point3& center, float radius, int materialIndex) {
+    restoreSpheres();
+    int index = static_cast<int>(spheres_.size());
+    spheres_.push_back({
+        center,
+        radius,
+        materialIndex
+    });
+    return index;
+}
+
+void SceneObject::build(const BVHBuildOptions& options, SphereStorage storage) {
+    restoreSpheres();
+    bvh_.build(*this, options);
+
+    if (storage == SphereStorage::Quantized) {
+        // Leaf order makes sphere index and slot the same, so no index array is needed to decode a hit
+        std::vector<int> order = bvh_.renumberPrimitives();
+        std::vector<Sphere> leafOrder(order.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            leafOrder[i] = spheres_[order[i]];
+        spheres_ = std::move(leafOrder);
+
+        if (quantizedSpheres_.build(spheres_)) {
+            storage_ = SphereStorage::Quantized;
+            spheres_ = {};
+            leafSpheres_ = {};
+            bvh_.refit(*this); // Decoded spheres are slightly larger than the ones the tree was built around
+            return;
+        }
+        std::cerr << "Error: Material index too large to quantize, keeping full-precision spheres" << std::endl;
+    }
+    updateLeafData();
+}
+
+// Decoded spheres enclose the originals, so a rebuild stays conservative; each quantization round grows them a little
+void SceneObject::restoreSpheres() {
+    if (storage_ != SphereStorage::Quantized) return;
+
+    spheres_.resize(quantizedSpheres_.size());
+    for (size_t i = 0; i < spheres_.size(); ++i)
+        spheres_[i] = quantizedSpheres_.get(i);
+    quantizedSpheres_ = {};
+    storage_ = SphereStorage::Float;
+}
+
+bool SceneObject::intersect(
+    HitRecord& record,
+    const Ray& ray,
+    float tMin,
+    float tMax
+) const {
+    return bvh_.hit(*this, record, TraversalRay{ray}, tMin, tMax);
+}
+
+bool SceneObject::closestHit(
+    PrimitiveHit& closest,
+    const Ray& ray,
+    float tMin
+) const {
+    return bvh_.closestHit(*this, closest, TraversalRay{ray}, tMin);
+}
+
+bool SceneObject::occluded(
+    const Ray& ray,
+    float tMin,
+    float tMax
+) const {
+    return bvh_.occluded(*this, TraversalRay{ray}, tMin, tMax);
+}
+
+bool SceneObject::hitLeaf(
+    const int* indices,
+    int first,
+    int count,
+    const Ray& ray,
+    float tMin,
+    PrimitiveHit& closest
+) const {
+    if (indices == bvh_.getPrimitiveIndices().data() && storage_ == SphereStorage::Quantized) {
+        int slot = quantizedSpheres_.intersect(ray, first, count, tMin, closest.t);
+        if (slot < 0) return false;
+        closest.primitive = indices[slot];
+        return true;
+    }
+    if (indices == bvh_.getPrimitiveIndices().data() && leafSpheres_.size() >= spheres_.size()) {
+        int slot = leafSpheres_.intersect(ray, first, count, tMin, closest.t);
+        if (slot < 0) return false;
+        closest.primitive = indices[slot];
+        return true;
+    }
+
+    bool hitAnything = false;
+    for (int i = first; i < first + count; ++i) {
+        if (sphereIntersect(sphere(indices[i]), ray, tMin, closest.t)) {
+            closest.primitive = indices[i];
+            hitAnything = true;
+        }
+    }
+    return hitAnything;
+}
+
+bool SceneObject::occludesLeaf(
+    const int* indices,
+    int first,
+    int count,
+    const Ray& ray,
+    float tMin,
+    float tMax
+) const {
+    if (indices == bvh_.getPrimitiveIndices().data() && storage_ == SphereStorage::Quantized)
+        return quantizedSpheres_.occludes(ray, first, count, tMin, tMax);
+    if (indices == bvh_.getPrimitiveIndices().data() && leafSpheres_.size() >= spheres_.size())
+        return leafSpheres_.occludes(ray, first, count, tMin, tMax);
+
+    for (int i = first; i < first + count; ++i) {
+        if (sphereOccludes(sphere(indices[i]), ray, tMin, tMax))
+            return true;
+    }
+    return false;
+}
+
+void SceneObject::updateLeafData() {
+    if (storage_ == SphereStorage::Quantized) return; // quantizedSpheres_ already is the leaf data
+    const std::vector<int>& order = bvh_.getPrimitiveIndices();
+    leafSpheres_.resize(order.size());
+    for (size_t slot = 0; slot < order.size(); ++slot)
+        leafSpheres_.set(slot, spheres_[order[slot]]);
+}
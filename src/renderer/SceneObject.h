@@ -0,0 +1,104 @@
+#pragma once
+#include "accel/BVH.h"
+#include "geometry/QuantizedSpheres.h"
+#include "geometry/Sphere.h"
+#include "geometry/SphereSoA.h"
+#include "core/Vec3.h"
+#include <vector>
+
+// How a built SceneObject keeps its spheres
+enum class SphereStorage : uint8_t {
+    Float,    // Full-precision spheres plus an 8-wide SoA copy for leaf tests
+    Quantized // QuantizedSpheres only, about a third of the memory. Spheres grow slightly and getSpheres() is empty
+};
+
+/**
+ * SceneObject - A reusable group of primitives with its own bottom-level BVH.
+ * Placed into a Scene any number of times through instances. Material indices refer to the Scene's materials.
+ */
+class SceneObject {
+public:
+    int addSphere(const Point3& center, float radius, int materialIndex);
+
+    /**
+     * Builds the bottom-level BVH. Scene::addObject() does this once per object. Quantized storage renumbers the
+     * spheres in leaf order and keeps full precision instead if a material index does not fit in 16 bits.
+     */
+    void build(const BVHBuildOptions& options = {}, SphereStorage storage = SphereStorage::Float);
+
+    bool intersect(
+        HitRecord& record,
+        const Ray& ray,
+        float tMin,
+        float tMax
+    ) const;
+
+    // Two-phase intersect(), as Scene::closestHit() and Scene::finalizeHit()
+    bool closestHit(
+        PrimitiveHit& closest,
+        const Ray& ray,
+        float tMin
+    ) const;
+    void finalizeHit(
+        const PrimitiveHit& closest,
+        HitRecord& record,
+        const Ray& ray
+    ) const {
+        sphereHitRecord(sphere(closest.primitive), record, ray, closest.t);
+    }
+
+    bool occluded(
+        const Ray& ray,
+        float tMin,
+        float tMax
+    ) const;
+
+    // Object-space bounds of the built BVH
+    AABB boundingBox() const { return bvh_.boundingBox(); }
+
+    // Queries used by BVHTree. Leaves of bvh_ are tested as SIMD batches, like Scene::hitLeaf()
+    size_t primitiveCount() const { return storage_ == SphereStorage::Quantized ? quantizedSpheres_.size() : spheres_.size(); }
+    AABB primitiveBounds(int primitiveIndex) const { return sphereBounds(sphere(primitiveIndex)); }
+    bool hitLeaf(
+        const int* indices,
+        int first,
+        int count,
+        const Ray& ray,
+        float tMin,
+        PrimitiveHit& closest
+    ) const;
+    bool occludesLeaf(
+        const int* indices,
+        int first,
+        int count,
+        const Ray& ray,
+        float tMin,
+        float tMax
+    ) const;
+
+    // Decoded, so slightly larger than added, for quantized storage
+    Sphere sphere(int sphereIndex) const {
+        return storage_ == SphereStorage::Quantized ? quantizedSpheres_.get(sphereIndex) : spheres_[sphereIndex];
+    }
+
+    const std::vector<Sphere>& getSpheres() const { return spheres_; }
+    SphereStorage getStorage() const { return storage_; }
+    const QuantizedSpheres& getQuantizedSpheres() const { return quantizedSpheres_; }
+    const BVHTree& getBVH() const { return bvh_; }
+
+private:
+    friend class SceneCache;    // Reads and restores internal arrays
+    friend class PagedGeometry; // Writes and restores pages
+
+    std::vector<Sphere> spheres_;
+    BVHTree bvh_;
+    SphereSoA leafSpheres_; // Spheres in bvh_ primitive index order
+    QuantizedSpheres quantizedSpheres_; // Replaces spheres_ and leafSpheres_ for quantized storage, in leaf order
+    SphereStorage storage_ = SphereStorage::Float;
+
+    // Refreshes leafSpheres_ after a build. Quantized storage has nothing to refresh
+    void updateLeafData();
+
+    // Decodes quantized storage back into spheres_, before a rebuild or addSphere()
+    void restoreSpheres();
+};
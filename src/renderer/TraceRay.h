@@ -4,55 +4,238 @@
 #include "core/Vec3.h"
 #include "core/HitRecord.h"
 #include "materials/BSDF.h"
+#include "materials/Sampling.h"
+#include "renderer/Scene.h"
 #include "util/RNG.h"
+#include <algorithm>
+#include <climits>
 #include <cmath>
 
+// traceRay() rouletteDepth that never ends paths early
+constexpr int NoRoulette = INT_MAX;
+
+constexpr float SHADOW_EPS = 1e-2f; // prevent self intersections
+
+// Power heuristic (beta = 2) weight of a strategy with pdf pdfA against one with pdf pdfB
+inline float powerHeuristic(float pdfA, float pdfB) {
+    float a2 = pdfA * pdfA;
+    float b2 = pdfB * pdfB;
+    return a2 + b2 > 0.0f ? a2 / (a2 + b2) : 0.0f;
+}
+
+// Delta BSDFs scatter into a single direction, which light sampling can never pick
+inline bool isDelta(const Material& material) {
+    return material.type == MaterialType::Dielectric;
+}
+
+// Radiance of rays that leave the scene: a sky gradient from white at the horizon to blue overhead
+inline Color backgroundColor(const Vec3& direction) {
+    float t = 0.5 * (direction.y + 1.0); // Map [-1, 1] to [0, 1]
+    return lerp(Vec3(1.0, 1.0, 1.0), Vec3(0.5, 0.7, 1.0), t);
+}
+
+// Shadow ray towards a light, with the radiance it carries if nothing blocks it within (SHADOW_EPS, tMax)
+struct ShadowRay {
+    Ray ray;
+    float tMax;
+    Color contribution;
+};
+
+/**
+ * Next-event estimation: picks a light uniformly and samples a direction in the cone its sphere subtends from the
+ * hit point. The contribution is MIS-weighted against the BSDF sampling the same direction. Returns false when
+ * the sample cannot contribute, in which case there is no shadow ray to trace.
+ */
+inline bool sampleLightRay(
+    const Scene& scene,
+    const Material& material,
+    const HitRecord& record,
+    const Vec3& wo,
+    RNG& rng,
+    ShadowRay& shadow
+) {
+    const auto& lights = scene.getLights();
+    const Sphere& light = scene.getSpheres()[lights[rng.uniformInt(0, static_cast<int>(lights.size()))]];
+
+    Vec3 wi;
+    float lightPdf = sampleSphereSolidAngle(record.position, light.center, light.radius, rng, wi);
+    if (lightPdf <= 0.0f) return false;
+    lightPdf /= static_cast<float>(lights.size());
+
+    float cosTheta = dot(record.normal, wi);
+    if (cosTheta <= 0.0f) return false;
+
+    Color f = BSDF_Eval(material, record, wo, wi);
+    if (f.x <= 0.0f && f.y <= 0.0f && f.z <= 0.0f) return false;
+
+    // Distance to the near side of the light; the light itself must not count as a blocker
+    Vec3 oc = light.center - record.position;
+    float b = dot(wi, oc);
+    float tLight = b - std::sqrt(std::max(0.0f, light.radius * light.radius - (oc.lengthSquared() - b * b)));
+
+    float weight = powerHeuristic(lightPdf, BSDF_Pdf(material, record, wo, wi));
+    const Color& emission = scene.getMaterials()[light.materialIndex].emission;
+    shadow = {Ray{record.position, wi}, tLight - SHADOW_EPS, f * emission * (cosTheta * weight / lightPdf)};
+    return true;
+}
+
+// sampleLightRay() with its shadow ray traced: the light's contribution, or black if it is blocked
+inline Color sampleDirectLight(
+    const Scene& scene,
+    const Material& material,
+    const HitRecord& record,
+    const Vec3& wo,
+    RNG& rng
+) {
+    ShadowRay shadow;
+    if (!sampleLightRay(scene, material, record, wo, rng, shadow)) return Color(0.0f);
+    if (scene.occluded(shadow.ray, SHADOW_EPS, shadow.tMax)) return Color(0.0f);
+    return shadow.contribution;
+}
+
+/**
+ * MIS weight of emission a BSDF sample from origin found. Emitters light sampling could not have picked
+ * (after camera rays and delta bounces, or outside the light list) keep full weight.
+ */
+inline float emissionWeight(
+    const Scene& scene,
+    const PrimitiveHit& closest,
+    const Point3& origin,
+    float bsdfPdf,
+    bool specular
+) {
+    int light = scene.hitLight(closest);
+    if (specular || light < 0) return 1.0f;
+
+    const auto& lights = scene.getLights();
+    const Sphere& sphere = scene.getSpheres()[lights[light]];
+    float lightPdf = sphereSolidAnglePdf(origin, sphere.center, sphere.radius) / lights.size();
+    return powerHeuristic(bsdfPdf, lightPdf);
+}
+
 /**
- * traceRay - Iterative Monte Carlo path tracing 
- * 
+ * Samples the BSDF for the next direction and folds f * cos / pdf into throughput.
+ * Returns false when the path ends here.
+ */
+inline bool scatter(
+    const Material& material,
+    const HitRecord& record,
+    const Vec3& wo,
+    RNG& rng,
+    Color& throughput,
+    BSDFSample& sample
+) {
+    sample = BSDF_Sample(material, record, wo, rng);
+    if (sample.pdf <= 0.0f) return false;
+
+    float cosTheta = std::abs(dot(record.normal, sample.wi));
+
+    if (material.type == MaterialType::Dielectric)
+        throughput *= sample.f; // just Color(1) — no cos, no pdf division
+    else {
+        if (cosTheta <= 0.0f) return false;
+        throughput *= sample.f * cosTheta / sample.pdf;
+    }
+    return true;
+}
+
+/**
+ * Russian roulette: a path survives with probability min(luminance(throughput), 0.95) and survivors are divided
+ * by it, which keeps the estimate unbiased. The cap makes even full-throughput glass paths end eventually.
+ */
+inline bool survivesRoulette(Color& throughput, RNG& rng) {
+    float survival = std::min(luminance(throughput), 0.95f);
+    if (rng.uniform01() >= survival) return false;
+    throughput /= survival;
+    return true;
+}
+
+/**
+ * traceRay - Iterative Monte Carlo path tracing
+ *
  * Computes the color of a ray by tracing it through the scene, accumulating color from surface interactions
- * and material scattering until hitting the background or reaching max depth. 
+ * and material scattering until hitting the background or reaching max depth.
  * Rendering is probability-weighted energy transport.
- * 
+ *
+ * Emissive spheres in the scene's light list are also sampled directly at every non-delta bounce, and
+ * emission reached by either strategy is combined with multiple importance sampling (power heuristic), so
+ * small lights converge without relying on BSDF samples happening to hit them.
+ *
+ * After rouletteDepth bounces, Russian roulette ends each path with a probability that grows as its throughput
+ * luminance falls, and divides survivors by their survival probability, so the estimate stays unbiased while dim
+ * paths stop early.
+ *
  * @param ray Initial ray to trace
  * @param scene World containing all hittable objects
  * @param RNG Random number generator
  * @param maxDepth Maximum number of bounces allowed
+ * @param rouletteDepth Ray segments every path traces before Russian roulette may end it
+ * @param pathLength If set, receives the number of ray segments traced
+ * @param primaryHit If set, ray's closest hit, already found (primitive -1 for a miss), e.g. by Scene::closestHitPacket()
  * @return Final color accumulated along the ray path
  */
-inline Color traceRay(const Ray& ray, const Scene& scene, RNG& rng, int maxDepth) {
+inline Color traceRay(
+    const Ray& ray,
+    const Scene& scene,
+    RNG& rng,
+    int maxDepth,
+    int rouletteDepth = NoRoulette,
+    int* pathLength = nullptr,
+    const PrimitiveHit* primaryHit = nullptr
+) {
     Ray current = ray;
     Color throughput(1.0f, 1.0f, 1.0f); // Start with full intensity white light
-    float SHADOW_EPS = 1e-2f; // prevent self intersections
+    Color radiance(0.0f, 0.0f, 0.0f);   // Light gathered by next-event estimation along the way
 
     const auto& materials = scene.getMaterials();
+    const bool sampleLights = !scene.getLights().empty();
+
+    float bsdfPdf = 0.0f;  // Pdf of the BSDF sample that produced current
+    bool specular = true;  // Camera rays and delta bounces: light sampling could not have found this path
+
+    int segments = 0; // Rays traced so far, reported through pathLength
+    auto finish = [&](const Color& color) {
+        if (pathLength) *pathLength = segments;
+        return color;
+    };
+
     for (int depth = 0; depth < maxDepth; ++depth) {
-        HitRecord record;
-        if (scene.intersect(record, current, SHADOW_EPS, INFINITY)) {
+        ++segments;
+        PrimitiveHit closest{INFINITY};
+        bool found;
+        if (depth == 0 && primaryHit) {
+            closest = *primaryHit;
+            found = closest.primitive >= 0;
+        } else {
+            found = scene.closestHit(closest, current, SHADOW_EPS);
+        }
+
+        if (found) {
+            HitRecord record;
+            scene.finalizeHit(closest, record, current);
+
             const Material& material = materials[record.materialIndex];
             if (material.type == MaterialType::Emissive) {
-                return throughput * material.emission;
+                float weight = emissionWeight(scene, closest, current.origin, bsdfPdf, specular);
+                return finish(radiance + throughput * material.emission * weight);
             }
 
-            BSDFSample sample = BSDF_Sample(material, record, -current.direction, rng);
-            if (sample.pdf <= 0.0f) break;
+            // Not on the last bounce: its light would sit one bounce past maxDepth, where BSDF paths never get
+            Vec3 wo = -current.direction;
+            if (sampleLights && !isDelta(material) && depth + 1 < maxDepth)
+                radiance += throughput * sampleDirectLight(scene, material, record, wo, rng);
 
-            float cosTheta = std::abs(dot(record.normal, sample.wi));
-
-            if (material.type == MaterialType::Dielectric)
-                throughput *= sample.f; // just Color(1) — no cos, no pdf division
-            else {
-                if (cosTheta <= 0.0f) break;
-                throughput *= sample.f * cosTheta / sample.pdf;
-            }
+            BSDFSample sample;
+            if (!scatter(material, record, wo, rng, throughput, sample)) break;
+            if (depth + 1 >= rouletteDepth && !survivesRoulette(throughput, rng)) break;
 
+            bsdfPdf = sample.pdf;
+            specular = isDelta(material);
             current = Ray{record.position, sample.wi};
         } else {
             // Hit background - compute and return final color
-            float t = 0.5 * (current.direction.y + 1.0); // Map [-1, 1] to [0, 1]
-            Color backgroundColor = lerp(Vec3(1.0, 1.0, 1.0), Vec3(0.5, 0.7, 1.0), t);
-            return throughput * backgroundColor;
+            return finish(radiance + throughput * backgroundColor(current.direction));
         }
     }
-    return Color(0.0f, 0.0f, 0.0f); // Max depth reached - return black (absorbed by bounces)
-}
\ No newline at end of file
+    return finish(radiance); // Max depth reached or path ended - no more light is gathered beyond this point
+}
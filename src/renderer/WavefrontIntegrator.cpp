@@ -0,0 +1,257 @@
+#include "renderer/WavefrontIntegrator.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int MaterialTypeCount = static_cast<int>(MaterialType::Emissive) + 1;
+constexpr int SortKeyBits = 21; // Direction octant above an 18-bit origin Morton code
+constexpr int DigitBits = 11;   // Two radix passes cover a key
+
+// Spreads the low 6 bits of v to every third bit, for 18-bit Morton codes
+uint32_t expandBits6(uint32_t v) {
+    v &= 0x3f;
+    v = (v | (v << 8)) & 0x0000F00F;
+    v = (v | (v << 4)) & 0x000C30C3;
+    v = (v | (v << 2)) & 0x00249249;
+    return v;
+}
+
+} // namespace
+
+void WavefrontIntegrator::PathStates::resize(size_t size) {
+    origin.resize(size);
+    direction.resize(size);
+    throughput.resize(size);
+    bsdfPdf.resize(size);
+    pixel.resize(size);
+    segments.resize(size);
+    specular.resize(size);
+    hit.resize(size);
+    hasHit.resize(size);
+    record.resize(size);
+    alive.resize(size);
+}
+
+// Hit data is not moved: compaction runs after shading, and extend rewrites it
+void WavefrontIntegrator::PathStates::move(size_t from, size_t to) {
+    origin[to] = origin[from];
+    direction[to] = direction[from];
+    throughput[to] = throughput[from];
+    bsdfPdf[to] = bsdfPdf[from];
+    pixel[to] = pixel[from];
+    segments[to] = segments[from];
+    specular[to] = specular[from];
+    alive[to] = alive[from];
+}
+
+WavefrontIntegrator::WavefrontIntegrator(
+    const Scene& scene,
+    const Camera& camera,
+    int maxDepth,
+    int rouletteDepth,
+    size_t batchSize
+) :
+    scene_(scene),
+    camera_(camera),
+    maxDepth_(maxDepth),
+    rouletteDepth_(rouletteDepth),
+    batchSize_(batchSize),
+    sceneBounds_(scene.getBVH().boundingBox())
+{
+    paths_.resize(batchSize_);
+    sortKeys_.resize(batchSize_);
+    sortKeysOut_.resize(batchSize_);
+    extendOrder_.resize(batchSize_);
+    extendOrderOut_.resize(batchSize_);
+    shadows_.rays.reserve(batchSize_);
+    shadows_.pixel.reserve(batchSize_);
+    shadeOrder_.resize(batchSize_);
+}
+
+uint64_t WavefrontIntegrator::renderTile(const Tile& tile, int samplesPerPixel, RNG& rng, std::vector<Color>& pixels) {
+    size_t pixelCount = size_t(tile.x1 - tile.x0) * (tile.y1 - tile.y0);
+    pixels.assign(pixelCount, Color(0.0f));
+
+    uint64_t segments = 0;
+    size_t nextSample = 0;
+    active_ = 0;
+    while (true) {
+        generate(tile, samplesPerPixel, nextSample, rng);
+        if (active_ == 0) break;
+
+        extend();
+        segments += active_;
+        shade(rng, pixels);
+        traceShadows(pixels);
+        compact();
+    }
+
+    for (Color& pixel : pixels)
+        pixel /= static_cast<float>(samplesPerPixel);
+    return segments;
+}
+
+// Samples go out pixel by pixel, so neighbouring slots start as near-identical camera rays
+void WavefrontIntegrator::generate(const Tile& tile, int samplesPerPixel, size_t& nextSample, RNG& rng) {
+    int width = tile.x1 - tile.x0;
+    size_t sampleCount = size_t(width) * (tile.y1 - tile.y0) * samplesPerPixel;
+
+    for (; active_ < batchSize_ && nextSample < sampleCount; ++active_, ++nextSample) {
+        int pixel = static_cast<int>(nextSample / samplesPerPixel);
+        Ray ray = camera_.shootRay(tile.x0 + pixel % width, tile.y0 + pixel / width, rng);
+
+        size_t i = active_;
+        paths_.origin[i] = ray.origin;
+        paths_.direction[i] = ray.direction;
+        paths_.throughput[i] = Color(1.0f);
+        paths_.bsdfPdf[i] = 0.0f;
+        paths_.pixel[i] = pixel;
+        paths_.segments[i] = 0;
+        paths_.specular[i] = 1;
+        paths_.alive[i] = 1;
+    }
+}
+
+// Orders rays by direction octant, then by origin along a Morton curve over a 64^3 grid, so consecutive rays start
+// close together and head the same way, and traversal touches the same nodes one ray after another
+void WavefrontIntegrator::extend() {
+    Vec3 extent = sceneBounds_.max - sceneBounds_.min;
+    for (size_t i = 0; i < active_; ++i) {
+        const Vec3& direction = paths_.direction[i];
+        uint32_t octant = (direction.x < 0.0f) | (direction.y < 0.0f) << 1 | (direction.z < 0.0f) << 2;
+        uint32_t code = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            // Origins on planes outside the tree's bounds clamp to its faces; flat or empty bounds sort by octant only
+            float f = extent[axis] > 0.0f
+                ? std::clamp((paths_.origin[i][axis] - sceneBounds_.min[axis]) / extent[axis], 0.0f, 1.0f) : 0.0f;
+            code |= expandBits6(static_cast<uint32_t>(f * 63.0f)) << axis;
+        }
+        sortKeys_[i] = octant << 18 | code;
+        extendOrder_[i] = static_cast<uint32_t>(i);
+    }
+    sortExtendOrder();
+
+    for (size_t n = 0; n < active_; ++n) {
+        size_t i = extendOrder_[n];
+        Ray ray{paths_.origin[i], paths_.direction[i]};
+        PrimitiveHit& closest = paths_.hit[i];
+        closest = PrimitiveHit{INFINITY};
+        paths_.hasHit[i] = scene_.closestHit(closest, ray, SHADOW_EPS);
+        if (paths_.hasHit[i])
+            scene_.finalizeHit(closest, paths_.record[i], ray);
+        paths_.segments[i]++;
+    }
+}
+
+// Stable LSD radix sort of extendOrder_ by sortKeys_ over [0, active_)
+void WavefrontIntegrator::sortExtendOrder() {
+    constexpr int Buckets = 1 << DigitBits;
+    size_t offsets[Buckets];
+
+    for (int shift = 0; shift < SortKeyBits; shift += DigitBits) {
+        std::fill(offsets, offsets + Buckets, 0);
+        for (size_t i = 0; i < active_; ++i)
+            offsets[(sortKeys_[i] >> shift) & (Buckets - 1)]++;
+
+        size_t sum = 0;
+        for (size_t& offset : offsets) {
+            size_t count = offset;
+            offset = sum;
+            sum += count;
+        }
+
+        for (size_t i = 0; i < active_; ++i) {
+            size_t dest = offsets[(sortKeys_[i] >> shift) & (Buckets - 1)]++;
+            sortKeysOut_[dest] = sortKeys_[i];
+            extendOrderOut_[dest] = extendOrder_[i];
+        }
+        sortKeys_.swap(sortKeysOut_);
+        extendOrder_.swap(extendOrderOut_);
+    }
+}
+
+void WavefrontIntegrator::shade(RNG& rng, std::vector<Color>& radiance) {
+    const auto& materials = scene_.getMaterials();
+    const bool sampleLights = !scene_.getLights().empty();
+
+    // Misses end here; hits are counting-sorted by material type
+    size_t offsets[MaterialTypeCount + 1] = {};
+    for (size_t i = 0; i < active_; ++i) {
+        if (!paths_.hasHit[i]) {
+            radiance[paths_.pixel[i]] += paths_.throughput[i] * backgroundColor(paths_.direction[i]);
+            paths_.alive[i] = 0;
+            continue;
+        }
+        offsets[static_cast<int>(materials[paths_.record[i].materialIndex].type) + 1]++;
+    }
+    for (int type = 0; type < MaterialTypeCount; ++type)
+        offsets[type + 1] += offsets[type];
+    size_t hitCount = offsets[MaterialTypeCount];
+    for (size_t i = 0; i < active_; ++i) {
+        if (paths_.hasHit[i])
+            shadeOrder_[offsets[static_cast<int>(materials[paths_.record[i].materialIndex].type)]++] = static_cast<int>(i);
+    }
+
+    shadows_.rays.clear();
+    shadows_.pixel.clear();
+
+    for (size_t n = 0; n < hitCount; ++n) {
+        int i = shadeOrder_[n];
+        const HitRecord& record = paths_.record[i];
+        const Material& material = materials[record.materialIndex];
+        Color& throughput = paths_.throughput[i];
+        int segments = paths_.segments[i];
+
+        if (material.type == MaterialType::Emissive) {
+            float weight = emissionWeight(scene_, paths_.hit[i], paths_.origin[i], paths_.bsdfPdf[i], paths_.specular[i]);
+            radiance[paths_.pixel[i]] += throughput * material.emission * weight;
+            paths_.alive[i] = 0;
+            continue;
+        }
+
+        // Same depth limits as traceRay(): no light sampling and no further bounce once maxDepth rays are traced
+        if (segments >= maxDepth_) {
+            paths_.alive[i] = 0;
+            continue;
+        }
+
+        Vec3 wo = -paths_.direction[i];
+        ShadowRay shadow;
+        if (sampleLights && !isDelta(material) && sampleLightRay(scene_, material, record, wo, rng, shadow)) {
+            shadow.contribution = throughput * shadow.contribution;
+            shadows_.rays.push_back(shadow);
+            shadows_.pixel.push_back(paths_.pixel[i]);
+        }
+
+        BSDFSample sample;
+        if (!scatter(material, record, wo, rng, throughput, sample)
+            || (segments >= rouletteDepth_ && !survivesRoulette(throughput, rng))) {
+            paths_.alive[i] = 0;
+            continue;
+        }
+
+        paths_.origin[i] = record.position;
+        paths_.direction[i] = sample.wi;
+        paths_.bsdfPdf[i] = sample.pdf;
+        paths_.specular[i] = isDelta(material);
+    }
+}
+
+void WavefrontIntegrator::traceShadows(std::vector<Color>& radiance) {
+    for (size_t i = 0; i < shadows_.rays.size(); ++i) {
+        const ShadowRay& shadow = shadows_.rays[i];
+        if (!scene_.occluded(shadow.ray, SHADOW_EPS, shadow.tMax))
+            radiance[shadows_.pixel[i]] += shadow.contribution;
+    }
+}
+
+// Stable, so surviving paths keep their pixel order and neighbouring rays stay neighbours
+void WavefrontIntegrator::compact() {
+    size_t alive = 0;
+    for (size_t i = 0; i < active_; ++i) {
+        if (!paths_.alive[i]) continue;
+        if (i != alive) paths_.move(i, alive);
+        alive++;
+    }
+    active_ = alive;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "core/HitRecord.h"
+#include "core/Vec3.h"
+#include "renderer/Camera.h"
+#include "renderer/Scene.h"
+#include "renderer/TileQueue.h"
+#include "renderer/TraceRay.h"
+#include "util/RNG.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * WavefrontIntegrator - Alternative to calling traceRay() per sample. Keeps a large batch of in-flight paths in
+ * SoA buffers and advances all of them one bounce at a time through separate stages:
+ *
+ *   generate - fills free slots with camera rays from Camera::shootRay
+ *   extend   - closest-hit traversal for every path, in an order sorted for coherence (direction octant,
+ *              then origin along a coarse Morton curve)
+ *   shade    - emission, light sampling and BSDF sampling, with paths sorted by MaterialType so each
+ *              material's code and data stay hot; queues one shadow ray per light sample
+ *   shadow   - any-hit traversal for the queued shadow rays
+ *   compact  - moves surviving paths to the front, so every stage runs over a dense range
+ *
+ * Slots freed by finished paths are refilled with new samples each round, so the batch stays full.
+ * Computes the same estimator as traceRay() (light sampling with MIS, Russian roulette), drawing random numbers
+ * in a different order. One instance per thread: the buffers are reused across tiles.
+ */
+class WavefrontIntegrator {
+public:
+    static constexpr size_t DefaultBatchSize = 1 << 16;
+
+    WavefrontIntegrator(
+        const Scene& scene,
+        const Camera& camera,
+        int maxDepth,
+        int rouletteDepth = NoRoulette,
+        size_t batchSize = DefaultBatchSize
+    );
+
+    /**
+     * Traces samplesPerPixel paths for every pixel of tile and stores each pixel's average in pixels, row by row
+     * over the tile. Returns the number of ray segments traced (excluding shadow rays).
+     */
+    uint64_t renderTile(const Tile& tile, int samplesPerPixel, RNG& rng, std::vector<Color>& pixels);
+
+private:
+    // One entry per in-flight path, field by field
+    struct PathStates {
+        std::vector<Point3> origin;
+        std::vector<Vec3> direction;
+        std::vector<Color> throughput;
+        std::vector<float> bsdfPdf;     // Pdf of the BSDF sample that produced the current ray
+        std::vector<int> pixel;         // Index into the tile's pixels
+        std::vector<int> segments;      // Rays traced so far
+        std::vector<uint8_t> specular;  // Camera ray or delta bounce, see traceRay()
+
+        // Hit found by the extend stage, finalized before shading
+        std::vector<PrimitiveHit> hit;
+        std::vector<uint8_t> hasHit;
+        std::vector<HitRecord> record;
+
+        std::vector<uint8_t> alive;
+
+        void resize(size_t size);
+        void move(size_t from, size_t to);
+    };
+
+    // Shadow rays queued by shade, each with the path's pixel and its throughput-weighted contribution
+    struct ShadowQueue {
+        std::vector<ShadowRay> rays;
+        std::vector<int> pixel;
+    };
+
+    const Scene& scene_;
+    const Camera& camera_;
+    int maxDepth_;
+    int rouletteDepth_;
+    size_t batchSize_;
+    AABB sceneBounds_; // Frame for the origin Morton codes
+
+    PathStates paths_;
+    size_t active_ = 0;
+    ShadowQueue shadows_;
+    std::vector<uint32_t> sortKeys_, sortKeysOut_;       // Direction octant and origin Morton code per slot
+    std::vector<uint32_t> extendOrder_, extendOrderOut_; // Slots sorted by key
+    std::vector<int> shadeOrder_;                        // Hit paths grouped by MaterialType
+
+    // Stages, each over paths [0, active_)
+    void generate(const Tile& tile, int samplesPerPixel, size_t& nextSample, RNG& rng);
+    void extend();
+    void sortExtendOrder();
+    void shade(RNG& rng, std::vector<Color>& radiance);
+    void traceShadows(std::vector<Color>& radiance);
+    void compact();
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Resolves a requested thread count, where 0 means one per hardware thread
+inline int resolveThreadCount(int requested) {
+    if (requested > 0) return requested;
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+/**
+ * Splits [0, count) into threadCount contiguous chunks and runs fn(chunk, begin, end) for each on its own thread.
+ * Chunk boundaries depend only on count and threadCount (chunks may be empty), so per-chunk results can be
+ * merged deterministically.
+ */
+template <typename Fn>
+void parallelChunks(size_t count, int threadCount, Fn&& fn) {
+    if (threadCount <= 1) {
+        fn(0, size_t{0}, count);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (int chunk = 1; chunk < threadCount; ++chunk) {
+        threads.emplace_back([&fn, chunk, count, threadCount] {
+            fn(chunk, count * chunk / threadCount, count * (chunk + 1) / threadCount);
+        });
+    }
+    fn(0, size_t{0}, count / threadCount); // Calling thread takes the first chunk
+
+    for (auto& t : threads)
+        t.join();
+}
+
+/**
+ * Runs fn(task) for every task in [0, taskCount) on threadCount workers pulling from a shared counter.
+ */
+template <typename Fn>
+void parallelTasks(size_t taskCount, int threadCount, Fn&& fn) {
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t task = next.fetch_add(1, std::memory_order_relaxed); task < taskCount;
+             task = next.fetch_add(1, std::memory_order_relaxed)) {
+            fn(task);
+        }
+    };
+
+    int workers = static_cast<int>(std::min<size_t>(threadCount, taskCount));
+    std::vector<std::thread> threads;
+    for (int i = 1; i < workers; ++i)
+        threads.emplace_back(worker);
+    worker();
+
+    for (auto& t : threads)
+        t.join();
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include "renderer/AdaptiveSampling.h"
+#include "renderer/Camera.h"
+#include "renderer/Renderer.h"
+#include "renderer/Scene.h"
+#include "util/RNG.h"
+#include <filesystem>
+#include <fstream>
+
+// ============================================================================
+// Adaptive Sampling Tests
+// ============================================================================
+
+namespace {
+
+// Reads a P3 file written by Film::output
+std::vector<int> readPPM(const std::filesystem::path& path, int& width, int& height) {
+    std::ifstream file(path);
+    std::string magic;
+    int maxValue;
+    file >> magic >> width >> height >> maxValue;
+    std::vector<int> values(size_t(width) * height * 3);
+    for (int& value : values) file >> value;
+    return values;
+}
+
+// Sky over a grey ground filling the lower half of a 16x16 frame
+void buildGround(Scene& scene) {
+    int grey = scene.addDiffuse(Color(0.6f));
+    scene.addSphere(Point3{0, -100.5f, -1}, 100.0f, grey);
+    scene.build();
+}
+
+} // namespace
+
+TEST(AdaptiveSamplingTest, PixelEstimateMatchesTwoPassStatistics) {
+    RNG rng{71};
+    std::vector<Color> samples;
+    PixelEstimate estimate;
+    for (int i = 0; i < 1000; ++i) {
+        // Large offset, small spread: the case where summing squares loses precision
+        samples.emplace_back(100.0f + rng.uniform01(), 100.0f + rng.uniform01(), 100.0f + rng.uniform01());
+        estimate.add(samples.back());
+    }
+
+    double meanLuminance = 0.0;
+    Color mean(0.0f);
+    for (const Color& sample : samples) {
+        meanLuminance += luminance(sample);
+        mean += sample;
+    }
+    meanLuminance /= samples.size();
+    mean /= static_cast<float>(samples.size());
+    double variance = 0.0;
+    for (const Color& sample : samples)
+        variance += (luminance(sample) - meanLuminance) * (luminance(sample) - meanLuminance);
+    variance /= samples.size() - 1;
+
+    EXPECT_EQ(estimate.count, 1000);
+    EXPECT_NEAR(estimate.mean.x, mean.x, 1e-3f);
+    EXPECT_NEAR(estimate.mean.z, mean.z, 1e-3f);
+    EXPECT_NEAR(estimate.luminanceMean, meanLuminance, 1e-3);
+    EXPECT_NEAR(estimate.variance(), variance, 1e-3 * variance);
+}
+
+TEST(AdaptiveSamplingTest, ConvergesOnceDisplayErrorIsSmall) {
+    AdaptiveSampling settings;
+    settings.maxError = 0.04f;
+    settings.maxSamples = 64;
+
+    PixelEstimate flat;
+    EXPECT_FALSE(flat.converged(settings));
+    flat.add(Color(0.5f));
+    flat.add(Color(0.5f));
+    EXPECT_FLOAT_EQ(flat.displayError(), 0.0f);
+    EXPECT_TRUE(flat.converged(settings));
+
+    // Samples of 0 or 1: display error about 0.35 / sqrt(n) stays above 0.04 right up to the cap
+    PixelEstimate noisy;
+    for (int i = 0; i < 63; ++i) {
+        noisy.add(Color(static_cast<float>(i % 2)));
+        EXPECT_FALSE(noisy.converged(settings));
+    }
+    noisy.add(Color(1.0f));
+    EXPECT_TRUE(noisy.converged(settings));
+}
+
+TEST(AdaptiveSamplingTest, SkyStopsAfterFirstRoundWhileLitGeometryRefines) {
+    Scene scene;
+    buildGround(scene);
+
+    const int width = 16, height = 16;
+    Camera camera{Point3{0, 0, 0}, Point3{0, 0, -1}, Vec3{0, 1, 0}, width, height, 60.0f};
+
+    AdaptiveSampling settings;
+    settings.roundSamples = 8;
+    settings.maxSamples = 64;
+    settings.maxError = 0.002f;
+    Renderer renderer{width, height, 1, 8, 4};
+    renderer.setAdaptiveSampling(settings);
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "adaptive_sampling_test";
+    renderer.render(camera, scene, (dir / "frame.ppm").string());
+    ASSERT_TRUE(std::filesystem::exists(dir / "frame.ppm"));
+
+    int heatmapWidth, heatmapHeight;
+    std::vector<int> heatmap = readPPM(dir / "frame_spp.ppm", heatmapWidth, heatmapHeight);
+    ASSERT_EQ(heatmapWidth, width);
+    ASSERT_EQ(heatmapHeight, height);
+
+    // One round is 8 / 64 of the way up the ramp, half way from black to blue. The sky row stops there; the
+    // ground row keeps refining and climbs past it
+    for (int x = 0; x < width; ++x) {
+        const int* sky = &heatmap[x * 3];
+        EXPECT_EQ(sky[0], 0);
+        EXPECT_EQ(sky[1], 0);
+        EXPECT_EQ(sky[2], 128);
+        const int* ground = &heatmap[((height - 1) * width + x) * 3];
+        EXPECT_GT(ground[0] + ground[1] + ground[2], 128);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(AdaptiveSamplingTest, SampleCapIsAtLeastOneRound) {
+    Scene scene;
+    buildGround(scene);
+    const int width = 16, height = 16;
+    Camera camera{Point3{0, 0, 0}, Point3{0, 0, -1}, Vec3{0, 1, 0}, width, height, 60.0f};
+
+    AdaptiveSampling settings;
+    settings.roundSamples = 4;
+    settings.maxSamples = 0;
+    Renderer renderer{width, height, 1, 8, 4};
+    renderer.setAdaptiveSampling(settings);
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "adaptive_sampling_cap_test";
+    renderer.render(camera, scene, (dir / "frame.ppm").string());
+
+    // Every pixel takes the one round, which is also the cap: traced, and at the red top of the heatmap
+    int imageWidth, imageHeight, heatmapWidth, heatmapHeight;
+    std::vector<int> image = readPPM(dir / "frame.ppm", imageWidth, imageHeight);
+    std::vector<int> heatmap = readPPM(dir / "frame_spp.ppm", heatmapWidth, heatmapHeight);
+    ASSERT_EQ(heatmap.size(), size_t(width * height * 3));
+    for (int pixel = 0; pixel < width * height; ++pixel) {
+        EXPECT_GT(image[pixel * 3 + 2], 0);
+        EXPECT_EQ(heatmap[pixel * 3], 255);
+        EXPECT_EQ(heatmap[pixel * 3 + 1], 0);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(AdaptiveSamplingTest, WavefrontIntegratorIgnoresAdaptiveSampling) {
+    Scene scene;
+    buildGround(scene);
+    const int width = 16, height = 16;
+    Camera camera{Point3{0, 0, 0}, Point3{0, 0, -1}, Vec3{0, 1, 0}, width, height, 60.0f};
+
+    Renderer renderer{width, height, 4, 8, 4};
+    renderer.setIntegrator(Renderer::Integrator::Wavefront);
+    renderer.setAdaptiveSampling(AdaptiveSampling{});
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "adaptive_sampling_wavefront_test";
+    renderer.render(camera, scene, (dir / "frame.ppm").string());
+
+    // The frame is rendered at samplesPerPixel, and no heatmap claims otherwise
+    int imageWidth, imageHeight;
+    std::vector<int> image = readPPM(dir / "frame.ppm", imageWidth, imageHeight);
+    ASSERT_EQ(imageWidth, width);
+    for (int pixel = 0; pixel < width * height; ++pixel)
+        EXPECT_GT(image[pixel * 3 + 2], 0);
+    EXPECT_FALSE(std::filesystem::exists(dir / "frame_spp.ppm"));
+    std::filesystem::remove_all(dir);
+}
@@ -4,6 +4,8 @@
 #include "core/Vec3.h"
 #include "core/Ray.h"
 #include "accel/AABB.h"
+#include "accel/BVH.h"
+#include "accel/QuantizedBVH.h"
 
 template<typename T>
 void analyze_type(const char* name) {
@@ -43,4 +45,13 @@ TEST(MemoryAnalysis, RaySize) {
 TEST(MemoryAnalysis, AABBSize) {
     EXPECT_EQ(sizeof(Ray), 24);
     EXPECT_TRUE(std::is_trivially_copyable<Ray>::value);
-}
\ No newline at end of file
+}
+TEST(MemoryAnalysis, BVHNodeSize) {
+    EXPECT_EQ(sizeof(BVHNode), 32); // Two nodes per 64-byte cache line
+    EXPECT_TRUE(std::is_trivially_copyable<BVHNode>::value);
+}
+TEST(MemoryAnalysis, QuantizedBVHNodeSize) {
+    EXPECT_EQ(sizeof(QuantizedBVHNode), 64); // Four children per cache line
+    EXPECT_EQ(alignof(QuantizedBVHNode), 64);
+    EXPECT_TRUE(std::is_trivially_copyable<QuantizedBVHNode>::value);
+}
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include "renderer/PagedGeometry.h"
+#include "renderer/Scene.h"
+#include "util/RNG.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+// ============================================================================
+// Paged Geometry Tests
+// ============================================================================
+
+static std::string pagePath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static std::vector<Sphere> randomSpheres(int count, uint32_t seed) {
+    RNG rng{seed};
+    std::vector<Sphere> spheres;
+    for (int i = 0; i < count; ++i) {
+        Point3 center{rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)};
+        spheres.push_back({center, rng.uniform(0.05f, 0.3f), i % 3});
+    }
+    return spheres;
+}
+
+static Ray randomRay(RNG& rng) {
+    Vec3 origin{rng.uniform(-15, 15), rng.uniform(-15, 15), rng.uniform(-15, 15)};
+    Vec3 target{rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)};
+    return Ray{origin, (target - origin).normalized()};
+}
+
+TEST(PagedGeometryTest, MatchesInMemoryObjectUnderTinyBudget) {
+    std::vector<Sphere> spheres = randomSpheres(5000, 3);
+    std::string path = pagePath("paged_geometry_match.pages");
+    ASSERT_TRUE(PagedGeometry::write(path, spheres, {.pageSpheres = 300, .pageBuild = {}}));
+
+    // A budget below one page keeps a single page resident, so nearly every page change reads from disk
+    PagedGeometry paged;
+    ASSERT_TRUE(paged.open(path, 1));
+    EXPECT_EQ(paged.sphereCount(), spheres.size());
+    EXPECT_EQ(paged.pageCount(), 17u);
+
+    SceneObject reference;
+    for (const Sphere& s : spheres) reference.addSphere(s.center, s.radius, s.materialIndex);
+    reference.build();
+
+    RNG rng{11};
+    int hits = 0;
+    for (int i = 0; i < 1000; ++i) {
+        Ray ray = randomRay(rng);
+        HitRecord expected, actual;
+        bool hit = reference.intersect(expected, ray, 0.001f, 100.0f);
+
+        PrimitiveHit closest{100.0f};
+        ASSERT_EQ(paged.closestHit(closest, ray, 0.001f), hit);
+        EXPECT_EQ(paged.occluded(ray, 0.001f, 100.0f), hit);
+        if (!hit) continue;
+
+        paged.finalizeHit(closest, actual, ray);
+        EXPECT_FLOAT_EQ(actual.t, expected.t);
+        EXPECT_EQ(actual.materialIndex, expected.materialIndex);
+        EXPECT_NEAR(dot(actual.normal, expected.normal), 1.0f, 1e-5f);
+        hits++;
+    }
+    EXPECT_GT(hits, 300);
+
+    PageCacheStats stats = paged.stats();
+    EXPECT_GT(stats.misses, 17u);
+    EXPECT_GT(stats.evictions, 0u);
+    EXPECT_EQ(stats.evictions, stats.misses - 1);
+
+    std::filesystem::remove(path);
+}
+
+TEST(PagedGeometryTest, LargeBudgetReadsEachPageOnce) {
+    std::vector<Sphere> spheres = randomSpheres(3000, 5);
+    std::string path = pagePath("paged_geometry_budget.pages");
+    ASSERT_TRUE(PagedGeometry::write(path, spheres, {.pageSpheres = 256, .pageBuild = {}}));
+
+    PagedGeometry paged;
+    ASSERT_TRUE(paged.open(path, size_t{1} << 30));
+    EXPECT_EQ(paged.stats().misses, 0u);
+
+    RNG rng{19};
+    std::vector<Ray> rays;
+    for (int i = 0; i < 2000; ++i) rays.push_back(randomRay(rng));
+
+    for (const Ray& ray : rays) {
+        PrimitiveHit closest{100.0f};
+        paged.closestHit(closest, ray, 0.001f);
+    }
+    PageCacheStats first = paged.stats();
+    EXPECT_EQ(first.misses, paged.pageCount());
+    EXPECT_EQ(first.evictions, 0u);
+    EXPECT_GE(first.bytesRead, spheres.size() * sizeof(Sphere));
+
+    // A second frame over the same rays is served from memory
+    for (const Ray& ray : rays) {
+        PrimitiveHit closest{100.0f};
+        paged.closestHit(closest, ray, 0.001f);
+    }
+    PageCacheStats frame = paged.stats() - first;
+    EXPECT_EQ(frame.misses, 0u);
+    EXPECT_EQ(frame.bytesRead, 0u);
+    EXPECT_DOUBLE_EQ(frame.hitRate(), 1.0);
+
+    // A budget of a few pages evicts, but never holds more than it allows
+    PagedGeometry small;
+    ASSERT_TRUE(small.open(path, 3 * 256 * 64));
+    for (const Ray& ray : rays) {
+        PrimitiveHit closest{100.0f};
+        small.closestHit(closest, ray, 0.001f);
+        ASSERT_LE(small.residentBytes(), small.memoryBudget());
+    }
+    EXPECT_GT(small.stats().evictions, 0u);
+
+    std::filesystem::remove(path);
+}
+
+TEST(PagedGeometryTest, ConcurrentReadsCountEachPageOnce) {
+    std::vector<Sphere> spheres = randomSpheres(3000, 11);
+    std::string path = pagePath("paged_geometry_concurrent.pages");
+    ASSERT_TRUE(PagedGeometry::write(path, spheres, {.pageSpheres = 256, .pageBuild = {}}));
+
+    PagedGeometry paged;
+    ASSERT_TRUE(paged.open(path, size_t{1} << 30));
+
+    // Every thread traces the same rays, so threads race to read the same pages. Only the copy kept counts
+    RNG rng{29};
+    std::vector<Ray> rays;
+    for (int i = 0; i < 2000; ++i) rays.push_back(randomRay(rng));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (const Ray& ray : rays) {
+                PrimitiveHit closest{100.0f};
+                paged.closestHit(closest, ray, 0.001f);
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    PageCacheStats stats = paged.stats();
+    EXPECT_EQ(stats.misses, paged.pageCount());
+    uint64_t fileBytes = 0;
+    for (size_t p = 0; p < paged.pageCount(); ++p) {
+        const BVHTree& tree = paged.page(static_cast<int>(p))->getBVH();
+        fileBytes += tree.getNodes().size() * sizeof(BVHNode) + tree.getPrimitiveIndices().size() * (sizeof(int) + sizeof(Sphere));
+    }
+    EXPECT_EQ(stats.bytesRead, fileBytes);
+
+    std::filesystem::remove(path);
+}
+
+TEST(PagedGeometryTest, SceneTracesPagedGeometryWithOtherPrimitives) {
+    std::vector<Sphere> spheres = randomSpheres(2000, 7);
+    std::string path = pagePath("paged_geometry_scene.pages");
+    ASSERT_TRUE(PagedGeometry::write(path, spheres, {.pageSpheres = 200, .pageBuild = {}}));
+
+    auto paged = std::make_shared<PagedGeometry>();
+    ASSERT_TRUE(paged->open(path, 64 * 1024));
+
+    // The same spheres in memory, plus loose spheres and a ground plane shared by both scenes
+    Scene pagedScene, memoryScene;
+    for (Scene* scene : {&pagedScene, &memoryScene}) {
+        scene->addDiffuse(Color(0.5f));
+        scene->addMetal(Color(0.9f));
+        scene->addEmissive(Color(2.0f));
+        scene->addPlane(Point3{0, -11, 0}, Vec3{0, 1, 0}, 0);
+        for (int i = 0; i < 40; ++i) scene->addSphere(Point3{float(i) - 20.0f, 11.0f, 0.0f}, 0.4f, 1);
+    }
+    pagedScene.addPagedGeometry(paged);
+    for (const Sphere& s : spheres) memoryScene.addSphere(s.center, s.radius, s.materialIndex);
+    pagedScene.build();
+    memoryScene.build();
+
+    RNG rng{23};
+    for (int i = 0; i < 1000; ++i) {
+        Ray ray = randomRay(rng);
+        HitRecord expected, actual;
+        bool hit = memoryScene.intersect(expected, ray, 0.001f, 100.0f);
+        ASSERT_EQ(pagedScene.intersect(actual, ray, 0.001f, 100.0f), hit);
+        EXPECT_EQ(pagedScene.occluded(ray, 0.001f, 100.0f), hit);
+        if (hit) {
+            EXPECT_FLOAT_EQ(actual.t, expected.t);
+            EXPECT_EQ(actual.materialIndex, expected.materialIndex);
+        }
+    }
+    EXPECT_GT(paged->stats().misses, 0u);
+
+    std::filesystem::remove(path);
+}
+
+TEST(PagedGeometryTest, RejectsCorruptFiles) {
+    std::string path = pagePath("paged_geometry_corrupt.pages");
+    ASSERT_TRUE(PagedGeometry::write(path, randomSpheres(1000, 9), {.pageSpheres = 100, .pageBuild = {}}));
+    std::filesystem::resize_file(path, 8192);
+
+    PagedGeometry paged;
+    EXPECT_FALSE(paged.open(path, 1 << 20));
+    EXPECT_FALSE(paged.open(pagePath("paged_geometry_missing.pages"), 1 << 20));
+
+    std::filesystem::remove(path);
+}
+
+TEST(PagedGeometryTest, CorruptPageReadsAsEmpty) {
+    std::vector<Sphere> spheres = randomSpheres(1000, 13);
+    std::string path = pagePath("paged_geometry_corrupt_page.pages");
+    ASSERT_TRUE(PagedGeometry::write(path, spheres, {.pageSpheres = 100, .pageBuild = {}}));
+
+    // The ten-entry page table fits in the first 4096-byte block, so page 0 starts at 4096 with its root node.
+    // Point the root's children far past the page's nodes
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        int offset = 1 << 20;
+        file.seekp(4096 + offsetof(BVHNode, offset));
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        ASSERT_TRUE(file.good());
+    }
+
+    // The page table is intact, so the file opens; the damage shows once page 0 is read
+    PagedGeometry paged;
+    ASSERT_TRUE(paged.open(path, 1 << 20));
+    EXPECT_EQ(paged.materialCount(), 3u);
+    EXPECT_TRUE(paged.page(0)->getBVH().getNodes().empty());
+    EXPECT_FALSE(paged.page(1)->getBVH().getNodes().empty());
+
+    RNG rng{31};
+    for (int i = 0; i < 500; ++i) {
+        PrimitiveHit closest{100.0f};
+        if (paged.closestHit(closest, randomRay(rng), 0.001f)) {
+            EXPECT_GE(closest.primitive, 100);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
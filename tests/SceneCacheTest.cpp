@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "renderer/Scene.h"
+#include "renderer/SceneCache.h"
+#include "util/RNG.h"
+#include <filesystem>
+#include <fstream>
+
+// ============================================================================
+// Scene Cache Tests
+// ============================================================================
+
+static std::string cachePath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static Scene makeScene(uint32_t seed) {
+    Scene scene;
+    int diffuse = scene.addDiffuse(Color(0.5f));
+    int metal = scene.addMetal(Color(0.9f), 0.2f);
+
+    RNG rng{seed};
+    for (int i = 0; i < 300; ++i) {
+        scene.addSphere(Vec3{rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)}, 0.3f, i % 2 ? diffuse : metal);
+    }
+
+    for (int i = 0; i < 50; ++i) {
+        Point3 center{rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)};
+        scene.addTriangle(center, center + Vec3{0.5f, 0, 0}, center + Vec3{0, 0.5f, 0.2f}, diffuse);
+    }
+
+    scene.addPlane(Vec3{0, -12, 0}, Vec3{0, 1, 0}, diffuse);
+
+    SceneObject cluster;
+    for (int i = 0; i < 20; ++i) {
+        cluster.addSphere(Vec3{rng.uniform(-1, 1), rng.uniform(-1, 1), rng.uniform(-1, 1)}, 0.2f, metal);
+    }
+    int object = scene.addObject(cluster);
+    for (int i = 0; i < 5; ++i) {
+        scene.addInstance(object, Transform::translate(Vec3{rng.uniform(-10, 10), 12, rng.uniform(-10, 10)}));
+    }
+
+    int quantized = scene.addObject(cluster, {}, SphereStorage::Quantized);
+    for (int i = 0; i < 3; ++i) {
+        scene.addInstance(quantized, Transform::translate(Vec3{rng.uniform(-10, 10), -8, rng.uniform(-10, 10)}));
+    }
+    return scene;
+}
+
+TEST(SceneCacheTest, RoundTripMatchesBuiltScene) {
+    std::string path = cachePath("raytracer_cache_round_trip.bin");
+    Scene scene = makeScene(41);
+    uint64_t hash = SceneCache::hash(scene);
+    scene.build();
+    ASSERT_TRUE(SceneCache::save(scene, path, hash));
+
+    Scene loaded;
+    ASSERT_TRUE(SceneCache::load(loaded, path, hash));
+
+    EXPECT_EQ(loaded.getSpheres().size(), scene.getSpheres().size());
+    EXPECT_EQ(loaded.getTriangles().size(), scene.getTriangles().size());
+    EXPECT_EQ(loaded.getPlanes().size(), scene.getPlanes().size());
+    EXPECT_EQ(loaded.getVertices().size(), scene.getVertices().size());
+    EXPECT_EQ(loaded.getMaterials().size(), scene.getMaterials().size());
+    EXPECT_EQ(loaded.getInstances().size(), scene.getInstances().size());
+    EXPECT_EQ(loaded.getLayout(), scene.getLayout());
+    EXPECT_EQ(loaded.getBVH().getNodes().size(), scene.getBVH().getNodes().size());
+    EXPECT_EQ(loaded.getBVH().getPrimitiveIndices(), scene.getBVH().getPrimitiveIndices());
+    EXPECT_FLOAT_EQ(loaded.getBVH().sahCost(), scene.getBVH().sahCost());
+
+    RNG rng{43};
+    for (int i = 0; i < 500; ++i) {
+        Vec3 origin{rng.uniform(-15, 15), rng.uniform(-15, 15), rng.uniform(-15, 15)};
+        Vec3 target{rng.uniform(-10, 10), rng.uniform(-10, 12), rng.uniform(-10, 10)};
+        Ray ray{origin, target - origin};
+
+        HitRecord expected, actual;
+        bool hit = scene.intersect(expected, ray, 0.001, 100.0);
+        ASSERT_EQ(loaded.intersect(actual, ray, 0.001, 100.0), hit);
+        if (hit) {
+            EXPECT_EQ(actual.t, expected.t);
+            EXPECT_EQ(actual.materialIndex, expected.materialIndex);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(SceneCacheTest, HashTracksSceneInputs) {
+    Scene a = makeScene(7);
+    Scene b = makeScene(7);
+    EXPECT_EQ(SceneCache::hash(a), SceneCache::hash(b));
+
+    b.updateSphere(10, b.getSpheres()[10].center + Vec3{0, 0.001f, 0}, b.getSpheres()[10].radius);
+    EXPECT_NE(SceneCache::hash(a), SceneCache::hash(b));
+
+    EXPECT_NE(SceneCache::hash(a), SceneCache::hash(a, {.method = BVHBuildMethod::Median}));
+    EXPECT_NE(SceneCache::hash(a, {}, Scene::BVHLayout::Binary), SceneCache::hash(a, {}, Scene::BVHLayout::Wide4));
+    EXPECT_EQ(SceneCache::hash(a, {.threadCount = 1}), SceneCache::hash(a, {.threadCount = 4}));
+}
+
+TEST(SceneCacheTest, RejectsStaleMissingOrTruncatedCache) {
+    std::string path = cachePath("raytracer_cache_stale.bin");
+    Scene scene = makeScene(5);
+    uint64_t hash = SceneCache::hash(scene);
+    scene.build();
+    ASSERT_TRUE(SceneCache::save(scene, path, hash));
+
+    Scene target;
+    target.addSphere(Vec3{0, 0, 0}, 1.0f, 0);
+    EXPECT_FALSE(SceneCache::load(target, path, hash + 1));
+    EXPECT_EQ(target.getSpheres().size(), 1u); // Untouched
+
+    EXPECT_FALSE(SceneCache::load(target, cachePath("raytracer_cache_missing.bin"), hash));
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    EXPECT_FALSE(SceneCache::load(target, path, hash));
+    EXPECT_EQ(target.getSpheres().size(), 1u);
+    std::filesystem::remove(path);
+}
+
+TEST(SceneCacheTest, RejectsOutOfRangeNodeOffset) {
+    std::string path = cachePath("raytracer_cache_corrupt.bin");
+    Scene scene = makeScene(9);
+    uint64_t hash = SceneCache::hash(scene);
+    scene.build();
+    ASSERT_TRUE(SceneCache::save(scene, path, hash));
+
+    // Point the root's child offset past the node array. The nodes section is the sixth entry of the table that
+    // follows the 24-byte header; each entry is 24 bytes, with the section's file offset in its last 8
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t nodesOffset = 0;
+        file.seekg(24 + 5 * 24 + 16);
+        file.read(reinterpret_cast<char*>(&nodesOffset), sizeof(nodesOffset));
+        int offset = static_cast<int>(scene.getBVH().getNodes().size()) + 100;
+        file.seekp(static_cast<std::streamoff>(nodesOffset + offsetof(BVHNode, offset)));
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+        ASSERT_TRUE(file.good());
+    }
+
+    Scene target;
+    target.addSphere(Vec3{0, 0, 0}, 1.0f, 0);
+    EXPECT_FALSE(SceneCache::load(target, path, hash));
+    EXPECT_EQ(target.getSpheres().size(), 1u);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include "renderer/Scene.h"
+#include "renderer/SceneFile.h"
+#include "util/RNG.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+// ============================================================================
+// Scene File Tests
+// ============================================================================
+
+static std::string scenePath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static void writeText(const std::string& path, const char* text) {
+    std::ofstream file(path);
+    file << text;
+}
+
+TEST(SceneFileTest, BinaryRoundTripPreservesSceneAndCamera) {
+    Scene scene;
+    scene.addDiffuse(Color(0.5f));
+    scene.addMetal(Color(0.9f, 0.8f, 0.7f), 0.2f);
+    scene.addDielectric(1.5f);
+    scene.addEmissive(Color(4.0f));
+    scene.addPhysical(Color(0.3f), 0.6f, 0.4f);
+
+    RNG rng{7};
+    for (int i = 0; i < 1001; ++i) {
+        Point3 center{rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)};
+        scene.addSphere(center, rng.uniform(0.1f, 0.5f), i % 5);
+    }
+    scene.addPlane(Point3{0, -1, 0}, Vec3{0, 2, 0}, 0);
+
+    CameraSettings camera{Point3{1, 2, 3}, Point3{0, 0, -1}, Vec3{0, 1, 0}, 320, 200, 35.0f, 0.1f, 4.5f};
+
+    std::string path = scenePath("scene_file_round_trip.rtscene");
+    ASSERT_TRUE(SceneFile::save(path, scene, camera));
+
+    Scene loaded;
+    CameraSettings loadedCamera;
+    ASSERT_TRUE(SceneFile::load(path, loaded, loadedCamera));
+
+    ASSERT_EQ(loaded.getSpheres().size(), scene.getSpheres().size());
+    ASSERT_EQ(loaded.getMaterials().size(), scene.getMaterials().size());
+    ASSERT_EQ(loaded.getPlanes().size(), 1u);
+    EXPECT_EQ(0, std::memcmp(loaded.getSpheres().data(), scene.getSpheres().data(),
+                             scene.getSpheres().size() * sizeof(Sphere)));
+    for (size_t i = 0; i < scene.getMaterials().size(); ++i) {
+        const Material& a = scene.getMaterials()[i];
+        const Material& b = loaded.getMaterials()[i];
+        EXPECT_EQ(a.type, b.type);
+        EXPECT_EQ(a.color.y, b.color.y);
+        EXPECT_EQ(a.roughness, b.roughness);
+        EXPECT_EQ(a.metallic, b.metallic);
+        EXPECT_EQ(a.ior, b.ior);
+        EXPECT_EQ(a.emission.x, b.emission.x);
+    }
+    EXPECT_EQ(loaded.getPlanes()[0].normal.y, 1.0f);
+    EXPECT_EQ(loadedCamera.lookFrom.z, 3.0f);
+    EXPECT_EQ(loadedCamera.imageWidth, 320);
+    EXPECT_EQ(loadedCamera.imageHeight, 200);
+    EXPECT_EQ(loadedCamera.focusDistance, 4.5f);
+
+    // The loaded scene builds and renders the same hits as the original
+    scene.build();
+    loaded.build();
+    for (int r = 0; r < 200; ++r) {
+        Ray ray{Point3{0, 0, 15}, Vec3{rng.uniform(-0.5f, 0.5f), rng.uniform(-0.5f, 0.5f), -1.0f}.normalized()};
+        HitRecord a, b;
+        bool hitA = scene.intersect(a, ray, 0.001f, 100.0f);
+        ASSERT_EQ(hitA, loaded.intersect(b, ray, 0.001f, 100.0f));
+        if (hitA) {
+            EXPECT_EQ(a.t, b.t);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(SceneFileTest, RejectsCorruptFilesAndKeepsScene) {
+    Scene scene;
+    int diffuse = scene.addDiffuse(Color(0.5f));
+    for (int i = 0; i < 10; ++i) scene.addSphere(Point3{float(i), 0, 0}, 0.5f, diffuse);
+    CameraSettings camera;
+
+    std::string path = scenePath("scene_file_corrupt.rtscene");
+    ASSERT_TRUE(SceneFile::save(path, scene, camera));
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    Scene target;
+    target.addDiffuse(Color(0.1f));
+    target.addSphere(Point3{0, 0, 0}, 1.0f, 0);
+
+    // Cut off inside the sphere chunk
+    std::ofstream(path, std::ios::binary).write(bytes.data(), bytes.size() - 60);
+    EXPECT_FALSE(SceneFile::load(path, target, camera));
+
+    // Wrong magic
+    std::vector<char> badMagic = bytes;
+    badMagic[0] = 'X';
+    std::ofstream(path, std::ios::binary).write(badMagic.data(), badMagic.size());
+    EXPECT_FALSE(SceneFile::load(path, target, camera));
+
+    EXPECT_FALSE(SceneFile::load(scenePath("scene_file_missing.rtscene"), target, camera));
+
+    // Well-formed files with values no renderer can use
+    CameraSettings emptyImage;
+    emptyImage.imageWidth = 0;
+    ASSERT_TRUE(SceneFile::save(path, scene, emptyImage));
+    EXPECT_FALSE(SceneFile::load(path, target, camera));
+
+    for (float radius : {-1.0f, 0.0f, NAN, INFINITY}) {
+        Scene badSphere;
+        badSphere.addDiffuse(Color(0.5f));
+        badSphere.addSphere(Point3{0, 0, 0}, radius, 0);
+        ASSERT_TRUE(SceneFile::save(path, badSphere, camera));
+        EXPECT_FALSE(SceneFile::load(path, target, camera)) << radius;
+    }
+    EXPECT_EQ(camera.imageWidth, CameraSettings{}.imageWidth);
+    EXPECT_EQ(target.getSpheres().size(), 1u);
+    EXPECT_EQ(target.getMaterials().size(), 1u);
+
+    std::filesystem::remove(path);
+}
+
+TEST(SceneFileTest, SkipsUnknownChunks) {
+    Scene scene;
+    int diffuse = scene.addDiffuse(Color(0.5f));
+    scene.addSphere(Point3{0, 0, -2}, 0.5f, diffuse);
+    CameraSettings camera;
+
+    std::string path = scenePath("scene_file_unknown_chunk.rtscene");
+    ASSERT_TRUE(SceneFile::save(path, scene, camera));
+
+    // Append a chunk from a hypothetical newer writer and bump the chunk count in the header
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        uint32_t chunkCount = 5;
+        file.seekp(12);
+        file.write(reinterpret_cast<const char*>(&chunkCount), 4);
+        file.seekp(0, std::ios::end);
+        uint32_t elementSize = 3;
+        uint64_t count = 2;
+        file.write("XTRA", 4);
+        file.write(reinterpret_cast<const char*>(&elementSize), 4);
+        file.write(reinterpret_cast<const char*>(&count), 8);
+        file.write("abcdef\0\0", 8);
+    }
+
+    Scene loaded;
+    ASSERT_TRUE(SceneFile::load(path, loaded, camera));
+    EXPECT_EQ(loaded.getSpheres().size(), 1u);
+
+    std::filesystem::remove(path);
+}
+
+TEST(SceneFileTest, ParsesTextScenes) {
+    std::string path = scenePath("scene_file_text.txt");
+    writeText(path,
+        "# Test scene\n"
+        "camera 0 1 5  0 0 -1  0 1 0  640 480 40\n"
+        "material floor diffuse 0.5 0.5 0.5\n"
+        "material mirror metal 0.9 0.9 0.9 0.05\n"
+        "material glass dielectric 1.5\n"
+        "material lamp emissive 4 4 4   # Bright\n"
+        "\n"
+        "sphere 0 1 -2 1 glass\n"
+        "sphere 2 1 -2 0.5 mirror\n"
+        "sphere 0 4 0 0.3 lamp\n"
+        "plane 0 0 0  0 3 0 floor\n");
+
+    Scene scene;
+    CameraSettings camera;
+    ASSERT_TRUE(SceneFile::loadText(path, scene, camera));
+    ASSERT_EQ(scene.getMaterials().size(), 4u);
+    ASSERT_EQ(scene.getSpheres().size(), 3u);
+    ASSERT_EQ(scene.getPlanes().size(), 1u);
+    EXPECT_EQ(scene.getSpheres()[1].materialIndex, 1);
+    EXPECT_FLOAT_EQ(scene.getMaterials()[1].roughness, 0.05f);
+    EXPECT_EQ(scene.getMaterials()[2].type, MaterialType::Dielectric);
+    EXPECT_FLOAT_EQ(scene.getPlanes()[0].normal.y, 1.0f);
+    EXPECT_EQ(camera.imageWidth, 640);
+    EXPECT_FLOAT_EQ(camera.aperture, 0.0f);
+    EXPECT_FLOAT_EQ(camera.focusDistance, (camera.lookAt - camera.lookFrom).length());
+
+    std::filesystem::remove(path);
+}
+
+TEST(SceneFileTest, RejectsMalformedText) {
+    std::string path = scenePath("scene_file_bad_text.txt");
+    const char* bad[] = {
+        "sphere 0 0 0 1 missing\n",
+        "material red diffuse 1 0 0\nsphere 0 0 0 1 red extra\n",
+        "material red diffuse 1 0\n",
+        "material red velvet 1 0 0\n",
+        "material red diffuse 1 0 0\nmaterial red diffuse 0 1 0\n",
+        "camera 0 0 0 0 0 -1 0 1 0 0 480 40\n",
+        "material red diffuse 1 0 0\nsphere 0 0 0 -1 red\n",
+        "cube 0 0 0 1\n",
+    };
+
+    for (const char* text : bad) {
+        writeText(path, text);
+        Scene scene;
+        CameraSettings camera;
+        EXPECT_FALSE(SceneFile::loadText(path, scene, camera)) << text;
+    }
+
+    std::filesystem::remove(path);
+}
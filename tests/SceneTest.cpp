@@ -3,6 +3,7 @@
 #include "geometry/Sphere.h"
 #include "core/Ray.h"
 #include "core/HitRecord.h"
+#include "util/RNG.h"
 #include <memory>
 
 // ============================================================================
@@ -81,3 +82,434 @@ TEST(SceneTest, RespectsTMinAndTMax) {
     EXPECT_FALSE(scene.intersect(record, ray, 0.001, 3.0)); // tMax before hit
     EXPECT_TRUE(scene.intersect(record, ray, 0.001, 100.0));
 }
+
+TEST(SceneTest, OccludedFindsBlocker) {
+    Scene scene;
+    scene.addSphere(Vec3{0, 0, -5}, 1.0, 0);
+    scene.addSphere(Vec3{0, 0, -10}, 1.0, 0);
+    scene.build();
+
+    Ray ray{Vec3{0, 0, 0}, Vec3{0, 0, -1}};
+
+    EXPECT_TRUE(scene.occluded(ray, 0.001, 100.0));
+    EXPECT_FALSE(scene.occluded(ray, 0.001, 3.0));  // Light placed before the first sphere
+    EXPECT_FALSE(scene.occluded(Ray{Vec3{0, 5, 0}, Vec3{0, 0, -1}}, 0.001, 100.0));
+}
+
+TEST(SceneTest, OccludedAgreesWithIntersectForEveryLayout) {
+    Scene scene;
+    RNG rng{17};
+    for (int i = 0; i < 300; ++i) {
+        scene.addSphere(Vec3{rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)}, 0.4, 0);
+    }
+
+    for (Scene::BVHLayout layout : {Scene::BVHLayout::Binary, Scene::BVHLayout::Wide4, Scene::BVHLayout::Wide8,
+                                    Scene::BVHLayout::Quantized4}) {
+        scene.build({}, layout);
+        for (int i = 0; i < 500; ++i) {
+            Vec3 origin{rng.uniform(-12, 12), rng.uniform(-12, 12), rng.uniform(-12, 12)};
+            Vec3 target{rng.uniform(-12, 12), rng.uniform(-12, 12), rng.uniform(-12, 12)};
+            Ray ray{origin, target - origin};
+            float distance = (target - origin).length();
+
+            HitRecord record;
+            EXPECT_EQ(scene.occluded(ray, 0.001, distance), scene.intersect(record, ray, 0.001, distance));
+        }
+    }
+}
+
+TEST(SceneTest, RefitMatchesFreshBuild) {
+    Scene scene;
+    RNG rng{23};
+    for (int i = 0; i < 400; ++i) {
+        scene.addSphere(Vec3{rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)}, 0.3, 0);
+    }
+
+    for (Scene::BVHLayout layout : {Scene::BVHLayout::Binary, Scene::BVHLayout::Wide4, Scene::BVHLayout::Wide8}) {
+        scene.build({}, layout);
+
+        // Small per-frame motion keeps the tree close to a fresh build
+        for (int i = 0; i < 400; ++i) {
+            const Sphere& sphere = scene.getSpheres()[i];
+            Vec3 offset{rng.uniform(-0.5, 0.5), rng.uniform(-0.5, 0.5), rng.uniform(-0.5, 0.5)};
+            scene.updateSphere(i, sphere.center + offset, sphere.radius * rng.uniform(0.8, 1.2));
+        }
+        EXPECT_FALSE(scene.refit());
+
+        Scene fresh = scene;
+        fresh.build({}, layout);
+
+        for (int i = 0; i < 300; ++i) {
+            Vec3 origin{rng.uniform(-12, 12), rng.uniform(-12, 12), rng.uniform(-12, 12)};
+            Vec3 target{rng.uniform(-12, 12), rng.uniform(-12, 12), rng.uniform(-12, 12)};
+            Ray ray{origin, target - origin};
+
+            HitRecord refitRecord, freshRecord;
+            bool refitHit = scene.intersect(refitRecord, ray, 0.001, 100.0);
+            ASSERT_EQ(refitHit, fresh.intersect(freshRecord, ray, 0.001, 100.0));
+            if (refitHit) {
+                EXPECT_FLOAT_EQ(refitRecord.t, freshRecord.t);
+            }
+        }
+    }
+}
+
+TEST(SceneTest, RefitRebuildsOnceQualityDegrades) {
+    Scene scene;
+    RNG rng{29};
+    for (int i = 0; i < 500; ++i) {
+        scene.addSphere(Vec3{rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)}, 0.2, 0);
+    }
+    scene.build({.rebuildThreshold = 1.5f});
+
+    // Scattering every sphere makes each refitted box span most of the scene
+    for (int i = 0; i < 500; ++i) {
+        scene.updateSphere(i, Vec3{rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)}, 0.2);
+    }
+    EXPECT_TRUE(scene.refit());
+    EXPECT_FLOAT_EQ(scene.getBVH().sahDegradation(), 1.0f);
+
+    // New primitives are not in the tree yet, so refitting alone is not enough
+    scene.addSphere(Vec3{0, 0, 0}, 1.0, 0);
+    EXPECT_TRUE(scene.refit());
+    EXPECT_EQ(scene.getBVH().getPrimitiveIndices().size(), 501u);
+}
+
+TEST(SceneTest, InstancesMatchFlattenedGeometry) {
+    RNG rng{37};
+    SceneObject cluster;
+    for (int i = 0; i < 50; ++i) {
+        cluster.addSphere(Vec3{rng.uniform(-2, 2), rng.uniform(-2, 2), rng.uniform(-2, 2)}, rng.uniform(0.1, 0.4), i % 3);
+    }
+
+    // The same cluster placed with rigid motion and uniform scale, so every copy is still made of spheres
+    Scene instanced, flat;
+    int object = instanced.addObject(cluster);
+    for (int copy = 0; copy < 20; ++copy) {
+        float scale = rng.uniform(0.5, 2.0);
+        Transform transform = Transform::translate(Vec3{rng.uniform(-20, 20), rng.uniform(-5, 5), rng.uniform(-20, 20)})
+                            * Transform::rotate(Vec3{rng.uniform(-1, 1), 1, rng.uniform(-1, 1)}, rng.uniform(0, 6))
+                            * Transform::scale(Vec3{scale});
+        instanced.addInstance(object, transform);
+        for (const Sphere& sphere : cluster.getSpheres())
+            flat.addSphere(transform.applyPoint(sphere.center), sphere.radius * scale, sphere.materialIndex);
+    }
+    instanced.addSphere(Vec3{0, -1005, 0}, 1000, 0); // Loose spheres share the top level with instances
+    flat.addSphere(Vec3{0, -1005, 0}, 1000, 0);
+    instanced.build();
+    flat.build();
+
+    for (int i = 0; i < 1000; ++i) {
+        Vec3 origin{rng.uniform(-30, 30), rng.uniform(-8, 8), rng.uniform(-30, 30)};
+        Vec3 target{rng.uniform(-25, 25), rng.uniform(-6, 6), rng.uniform(-25, 25)};
+        Ray ray{origin, target - origin};
+
+        HitRecord instancedRecord, flatRecord;
+        bool instancedHit = instanced.intersect(instancedRecord, ray, 0.001, 100.0);
+        ASSERT_EQ(instancedHit, flat.intersect(flatRecord, ray, 0.001, 100.0));
+        EXPECT_EQ(instanced.occluded(ray, 0.001, 100.0), instancedHit);
+        if (!instancedHit) continue;
+
+        // Float error in the transformed ray is amplified on grazing hits, so compare relative to distance
+        EXPECT_NEAR(instancedRecord.t, flatRecord.t, 1e-3f * flatRecord.t);
+        EXPECT_NEAR(dot(instancedRecord.normal, flatRecord.normal), 1.0f, 1e-3f);
+        EXPECT_EQ(instancedRecord.frontFace, flatRecord.frontFace);
+        EXPECT_EQ(instancedRecord.materialIndex, flatRecord.materialIndex);
+    }
+}
+
+TEST(SceneTest, MovingAnInstanceOnlyRebuildsTopLevel) {
+    SceneObject object;
+    object.addSphere(Vec3{0, 0, 0}, 1.0, 0);
+
+    Scene scene;
+    int objectIndex = scene.addObject(object);
+    int instance = scene.addInstance(objectIndex, Transform::translate(Vec3{0, 0, -5}));
+    scene.build();
+
+    const BVHNode* objectNodes = scene.getObjects()[objectIndex].getBVH().getNodes().data();
+
+    scene.setInstanceTransform(instance, Transform::translate(Vec3{3, 0, -5}) * Transform::scale(Vec3{2}));
+    scene.build();
+    EXPECT_EQ(scene.getObjects()[objectIndex].getBVH().getNodes().data(), objectNodes);
+
+    HitRecord record;
+    EXPECT_FALSE(scene.intersect(record, Ray{Vec3{0, 0, 0}, Vec3{0, 0, -1}}, 0.001, 100.0));
+    ASSERT_TRUE(scene.intersect(record, Ray{Vec3{3, 0, 0}, Vec3{0, 0, -1}}, 0.001, 100.0));
+    EXPECT_NEAR(record.t, 3.0, 1e-4f);
+    EXPECT_NEAR(record.normal.z, 1.0, 1e-4f);
+}
+
+TEST(SceneTest, ClosestHitNamesPrimitiveBeforeFinalizing) {
+    SceneObject object;
+    object.addSphere(Vec3{0, 0, 0}, 0.5, 1);
+    object.addSphere(Vec3{0, 2, 0}, 0.5, 2);
+
+    Scene scene;
+    for (int i = 0; i < 30; ++i)
+        scene.addSphere(Vec3{static_cast<float>(i) * 3.0f, 0, 0}, 1.0, 0);
+    int objectIndex = scene.addObject(object);
+    scene.addInstance(objectIndex, Transform::translate(Vec3{0, 0, -10}));
+    scene.build();
+
+    // Behind sphere 0 along -z sits the instance; its second sphere is at y = 2
+    Ray ray{Vec3{0, 2, 5}, Vec3{0, 0, -1}};
+    PrimitiveHit closest{100.0f};
+    ASSERT_TRUE(scene.closestHit(closest, ray, 0.001f));
+    EXPECT_EQ(scene.getPrimitives()[closest.primitive].type, Scene::PrimitiveType::Instance);
+    EXPECT_EQ(closest.subPrimitive, 1);
+    EXPECT_NEAR(closest.t, 14.5f, 1e-4f);
+
+    HitRecord record;
+    scene.finalizeHit(closest, record, ray);
+    EXPECT_EQ(record.materialIndex, 2);
+    EXPECT_NEAR(record.normal.z, 1.0f, 1e-4f);
+
+    HitRecord direct;
+    ASSERT_TRUE(scene.intersect(direct, ray, 0.001f, 100.0f));
+    EXPECT_EQ(direct.position, record.position);
+
+    // A sphere hit carries only the top-level primitive
+    closest = PrimitiveHit{100.0f};
+    ASSERT_TRUE(scene.closestHit(closest, Ray{Vec3{9, 0, 5}, Vec3{0, 0, -1}}, 0.001f));
+    EXPECT_EQ(scene.getSpheres()[scene.getPrimitives()[closest.primitive].index].center.x, 9.0f);
+    EXPECT_NEAR(closest.t, 4.0f, 1e-4f);
+}
+
+TEST(SceneTest, MixedPrimitivesMatchBruteForceForEveryLayout) {
+    RNG rng{53};
+    Scene scene;
+
+    // A closed box mesh, loose triangles and spheres in the same top-level tree, plus one instance
+    TriangleMesh box;
+    box.vertices = {{-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1}, {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}};
+    box.indices = {0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4, 2, 3, 7, 2, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5};
+    EXPECT_EQ(scene.addMesh(box, 1), 0);
+    for (int i = 0; i < 200; ++i) {
+        Point3 center{rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)};
+        if (i % 2) {
+            scene.addSphere(center, 0.4, 0);
+        } else {
+            auto corner = [&] { return center + Vec3{rng.uniform(-1, 1), rng.uniform(-1, 1), rng.uniform(-1, 1)}; };
+            scene.addTriangle(corner(), corner(), corner(), 2);
+        }
+    }
+    SceneObject object;
+    object.addSphere(Vec3{0, 0, 0}, 1.0, 3);
+    scene.addInstance(scene.addObject(object), Transform::translate(Vec3{0, 12, 0}));
+    ASSERT_EQ(scene.getTriangles().size(), 112u);
+
+    for (Scene::BVHLayout layout : {Scene::BVHLayout::Binary, Scene::BVHLayout::Wide4, Scene::BVHLayout::Wide8,
+                                    Scene::BVHLayout::Quantized4}) {
+        scene.build({}, layout);
+        for (int i = 0; i < 500; ++i) {
+            Vec3 origin{rng.uniform(-12, 12), rng.uniform(-12, 14), rng.uniform(-12, 12)};
+            Vec3 target{rng.uniform(-10, 10), rng.uniform(-10, 13), rng.uniform(-10, 10)};
+            Ray ray{origin, (target - origin).normalized()};
+
+            PrimitiveHit expected{100.0f};
+            for (int p = 0; p < static_cast<int>(scene.primitiveCount()); ++p)
+                scene.intersectPrimitive(p, ray, 0.001f, expected);
+
+            HitRecord record;
+            bool hit = scene.intersect(record, ray, 0.001f, 100.0f);
+            ASSERT_EQ(hit, expected.primitive >= 0);
+            EXPECT_EQ(scene.occluded(ray, 0.001f, 100.0f), hit);
+            if (!hit) continue;
+
+            EXPECT_NEAR(record.t, expected.t, 1e-4f * expected.t);
+            HitRecord expectedRecord;
+            scene.finalizeHit(expected, expectedRecord, ray);
+            EXPECT_EQ(record.materialIndex, expectedRecord.materialIndex);
+        }
+    }
+
+    // Rays starting inside the box hit its back faces
+    HitRecord record;
+    ASSERT_TRUE(scene.intersect(record, Ray{Vec3{0, 0, 0}, Vec3{1, 0, 0}}, 0.001f, 100.0f));
+    EXPECT_NEAR(record.t, 1.0f, 1e-5f);
+    EXPECT_FALSE(record.frontFace);
+    EXPECT_EQ(record.materialIndex, 1);
+}
+
+TEST(SceneTest, GroundPlaneStaysOutOfBVH) {
+    Scene scene;
+    scene.addPlane(Vec3{0, 0, 0}, Vec3{0, 2, 0}, 1); // Normal is normalized on insertion
+    RNG rng{61};
+    for (int i = 0; i < 100; ++i) {
+        scene.addSphere(Vec3{rng.uniform(-5, 5), rng.uniform(0.5, 3), rng.uniform(-5, 5)}, 0.3, 0);
+    }
+    scene.addSphere(Vec3{0, -2, 0}, 0.5, 2); // Below the ground
+    scene.build();
+
+    // Root bounds cover only the spheres
+    AABB root = scene.getBVH().boundingBox();
+    EXPECT_GT(root.min.x, -6.0f);
+    EXPECT_LT(root.max.x, 6.0f);
+    EXPECT_EQ(scene.getPlanes()[0].normal, Vec3(0, 1, 0));
+
+    // A ray straight down between the spheres lands on the plane, never on the buried sphere
+    HitRecord record;
+    Ray down{Vec3{0, 10, 0}, Vec3{0, -1, 0}};
+    ASSERT_TRUE(scene.intersect(record, Ray{Vec3{20, 10, 0}, Vec3{0, -1, 0}}, 0.001, 100.0));
+    EXPECT_NEAR(record.t, 10.0, 1e-5f);
+    EXPECT_EQ(record.materialIndex, 1);
+    EXPECT_TRUE(record.frontFace);
+
+    ASSERT_TRUE(scene.intersect(record, down, 0.001, 100.0));
+    EXPECT_NE(record.materialIndex, 2);
+    EXPECT_LE(record.t, 10.0f);
+
+    // From below, the buried sphere is closer than the plane
+    ASSERT_TRUE(scene.intersect(record, Ray{Vec3{0, -10, 0}, Vec3{0, 1, 0}}, 0.001, 100.0));
+    EXPECT_EQ(record.materialIndex, 2);
+
+    EXPECT_TRUE(scene.occluded(Ray{Vec3{20, 10, 0}, Vec3{0, -1, 0}}, 0.001, 11.0));
+    EXPECT_FALSE(scene.occluded(Ray{Vec3{20, 10, 0}, Vec3{0, -1, 0}}, 0.001, 9.0));
+    EXPECT_FALSE(scene.occluded(Ray{Vec3{20, 10, 0}, Vec3{1, 0, 0}}, 0.001, 100.0));
+}
+
+TEST(SceneTest, ClosestHitPacketMatchesSingleRays) {
+    RNG rng{67};
+    Scene scene;
+    scene.addPlane(Vec3{0, -1, 0}, Vec3{0, 1, 0}, 1);
+    for (int i = 0; i < 300; ++i)
+        scene.addSphere(Vec3{rng.uniform(-8, 8), rng.uniform(-1, 4), rng.uniform(-20, -4)}, rng.uniform(0.1, 0.6), 0);
+    scene.build();
+
+    auto check = [&](const Ray* rays, int count) {
+        PrimitiveHit hits[RayPacket::Size];
+        for (int lane = 0; lane < count; ++lane) hits[lane] = PrimitiveHit{100.0f};
+        int mask = scene.closestHitPacket(hits, RayPacket{rays, count}, 0.001f);
+        EXPECT_EQ(mask & ~((1 << count) - 1), 0);
+
+        for (int lane = 0; lane < count; ++lane) {
+            PrimitiveHit expected{100.0f};
+            bool hit = scene.closestHit(expected, rays[lane], 0.001f);
+            ASSERT_EQ(((mask >> lane) & 1) != 0, hit);
+            EXPECT_EQ(hits[lane].primitive, expected.primitive);
+            EXPECT_FLOAT_EQ(hits[lane].t, expected.t);
+        }
+    };
+
+    // Camera-like packets: one origin, directions through neighbouring points of a distant image plane
+    Vec3 eye{0, 1, 2};
+    for (int i = 0; i < 200; ++i) {
+        // Kept off the eye's x and y so every ray in the packet heads into the same octant
+        Vec3 start{i % 2 ? rng.uniform(0.1, 6) : rng.uniform(-6, -0.5), i % 3 ? rng.uniform(1.1, 4) : rng.uniform(-1, 0.9), -10};
+        Ray rays[RayPacket::Size];
+        for (int lane = 0; lane < RayPacket::Size; ++lane)
+            rays[lane] = Ray{eye, (start + Vec3{0.05f * lane, 0, 0} - eye).normalized()};
+        RayPacket packet{rays, RayPacket::Size};
+        EXPECT_GE(packet.octant, 0);
+        check(rays, RayPacket::Size);
+        check(rays, 1 + i % RayPacket::Size); // Partial packets
+    }
+
+    // Incoherent packets, mostly with mixed direction signs
+    for (int i = 0; i < 100; ++i) {
+        Ray rays[RayPacket::Size];
+        for (int lane = 0; lane < RayPacket::Size; ++lane) {
+            Vec3 origin{rng.uniform(-8, 8), rng.uniform(-1, 4), rng.uniform(-20, 0)};
+            rays[lane] = Ray{origin, Vec3{rng.uniform(-1, 1), rng.uniform(-1, 1), rng.uniform(-1, 1)}.normalized()};
+        }
+        check(rays, RayPacket::Size);
+    }
+}
+
+TEST(SceneTest, QuantizedObjectsCoverFullPrecisionHits) {
+    RNG rng{31};
+    SceneObject particles;
+    for (int i = 0; i < 2000; ++i) {
+        Point3 center{rng.uniform(-3, 3), rng.uniform(-3, 3), rng.uniform(-3, 3)};
+        particles.addSphere(center, 0.04f * float(1 + i % 3), i % 4);
+    }
+
+    Scene scene;
+    int full = scene.addObject(particles);
+    int quantized = scene.addObject(particles, {}, SphereStorage::Quantized);
+    scene.addInstance(full, Transform::translate(Vec3{-10, 0, 0}));
+    scene.addInstance(quantized, Transform::translate(Vec3{10, 0, 0}));
+    scene.build();
+
+    const SceneObject& object = scene.getObjects()[quantized];
+    EXPECT_EQ(object.getStorage(), SphereStorage::Quantized);
+    EXPECT_TRUE(object.getSpheres().empty());
+    EXPECT_EQ(object.primitiveCount(), 2000u);
+    EXPECT_TRUE(object.getQuantizedSpheres().hasPalette());
+
+    // The same ray offset to each instance: the quantized copy hits whenever the original does. Distances agree up
+    // to the float noise of small spheres seen from afar, which is larger than the quantization error
+    int hits = 0;
+    for (int i = 0; i < 2000; ++i) {
+        Point3 origin{rng.uniform(-3, 3), rng.uniform(-3, 3), 8.0f};
+        Vec3 direction = Vec3{rng.uniform(-0.3f, 0.3f), rng.uniform(-0.3f, 0.3f), -1.0f}.normalized();
+
+        HitRecord expected, actual;
+        if (!scene.intersect(expected, Ray{origin + Vec3{-10, 0, 0}, direction}, 0.001, 100.0)) continue;
+        ASSERT_TRUE(scene.intersect(actual, Ray{origin + Vec3{10, 0, 0}, direction}, 0.001, 100.0));
+        EXPECT_NEAR(actual.t, expected.t, 5e-3f);
+        hits++;
+    }
+    EXPECT_GT(hits, 500);
+}
+
+TEST(SceneTest, QuantizedObjectSurvivesRebuild) {
+    RNG rng{37};
+    SceneObject particles;
+    for (int i = 0; i < 500; ++i)
+        particles.addSphere(Point3{rng.uniform(-3, 3), rng.uniform(-3, 3), rng.uniform(-3, 3)}, 0.1f, i % 4);
+    particles.build({}, SphereStorage::Quantized);
+
+    std::vector<Ray> rays;
+    std::vector<PrimitiveHit> before;
+    for (int i = 0; i < 500; ++i) {
+        Point3 origin{rng.uniform(-3, 3), rng.uniform(-3, 3), 8.0f};
+        rays.push_back(Ray{origin, Vec3{0, 0, -1}});
+        before.push_back(PrimitiveHit{100.0f});
+        particles.closestHit(before.back(), rays.back(), 0.001f);
+    }
+
+    // A copy, as Scene::addObject() makes, built again with the same storage
+    SceneObject rebuilt = particles;
+    rebuilt.build({}, SphereStorage::Quantized);
+    EXPECT_EQ(rebuilt.getStorage(), SphereStorage::Quantized);
+    ASSERT_EQ(rebuilt.primitiveCount(), 500u);
+    for (size_t i = 0; i < rays.size(); ++i) {
+        PrimitiveHit after{100.0f};
+        EXPECT_EQ(rebuilt.closestHit(after, rays[i], 0.001f), before[i].primitive >= 0);
+        if (before[i].primitive >= 0) {
+            EXPECT_NEAR(after.t, before[i].t, 1e-2f);
+        }
+    }
+
+    // Adding to a quantized object keeps what it already held
+    rebuilt.addSphere(Point3{0, 0, 20}, 1.0f, 0);
+    rebuilt.build();
+    EXPECT_EQ(rebuilt.getStorage(), SphereStorage::Float);
+    EXPECT_EQ(rebuilt.primitiveCount(), 501u);
+}
+
+TEST(SceneTest, BuildCollectsEmissiveSpheresAsLights) {
+    Scene scene;
+    int diffuse = scene.addDiffuse(Color(0.5f));
+    int light = scene.addEmissive(Color(4.0f));
+    scene.addSphere(Vec3{0, 0, 0}, 1.0f, diffuse);
+    scene.addSphere(Vec3{0, 3, 0}, 0.5f, light);
+    scene.addTriangle(Vec3{-1, 5, 0}, Vec3{1, 5, 0}, Vec3{0, 5, 1}, light);
+    scene.addSphere(Vec3{3, 3, 0}, 0.5f, light);
+    scene.build();
+
+    // Only loose spheres are sampled as lights
+    ASSERT_EQ(scene.getLights().size(), 2u);
+    EXPECT_EQ(scene.getLights()[0], 1);
+    EXPECT_EQ(scene.getLights()[1], 2);
+
+    PrimitiveHit closest{INFINITY};
+    ASSERT_TRUE(scene.closestHit(closest, Ray{Vec3{3, 0, 0}, Vec3{0, 1, 0}}, 0.001f));
+    EXPECT_EQ(scene.hitLight(closest), 1);
+
+    closest = PrimitiveHit{INFINITY};
+    ASSERT_TRUE(scene.closestHit(closest, Ray{Vec3{0, 0, -5}, Vec3{0, 0, 1}}, 0.001f));
+    EXPECT_EQ(scene.hitLight(closest), -1);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "renderer/TraceRay.h"
+#include "renderer/Scene.h"
+#include "materials/Sampling.h"
+#include "geometry/Sphere.h"
+#include "util/RNG.h"
+
+// ============================================================================
+// Light Sampling and Integrator Tests
+// ============================================================================
+
+TEST(TraceRayTest, SolidAngleSamplesHitTheSphere) {
+    RNG rng{7};
+    Sphere light{Point3{1, 4, -2}, 0.3f, 0};
+    Point3 p{0, 0, 0};
+
+    float expectedPdf = sphereSolidAnglePdf(p, light.center, light.radius);
+    for (int i = 0; i < 1000; ++i) {
+        Vec3 wi;
+        float pdf = sampleSphereSolidAngle(p, light.center, light.radius, rng, wi);
+        ASSERT_GT(pdf, 0.0f);
+        EXPECT_FLOAT_EQ(pdf, expectedPdf);
+        EXPECT_NEAR(wi.length(), 1.0f, 1e-5f);
+
+        float tClosest = INFINITY;
+        EXPECT_TRUE(sphereIntersect(Sphere{light.center, light.radius * 1.001f, 0}, Ray{p, wi}, 0.0f, tClosest));
+    }
+
+    // No cone from inside the sphere
+    Vec3 wi;
+    EXPECT_EQ(sampleSphereSolidAngle(light.center, light.center, light.radius, rng, wi), 0.0f);
+    EXPECT_EQ(sphereSolidAnglePdf(light.center, light.center, light.radius), 0.0f);
+}
+
+TEST(TraceRayTest, DirectLightingMatchesAnalyticIrradiance) {
+    // A diffuse floor lit by one small sphere, inside a black enclosure that hides the background
+    Scene scene;
+    float albedo = 0.5f, emission = 4.0f;
+    int floor = scene.addDiffuse(Color(albedo));
+    int black = scene.addDiffuse(Color(0.0f));
+    int light = scene.addEmissive(Color(emission));
+    scene.addPlane(Point3{0, 0, 0}, Vec3{0, 1, 0}, floor);
+    scene.addSphere(Point3{0, 0, 0}, 100.0f, black);
+    Sphere lightSphere{Point3{0, 2, 0}, 0.25f, light};
+    scene.addSphere(lightSphere.center, lightSphere.radius, light);
+    scene.build();
+
+    // A Lambertian point sees L = albedo * Le * sin^2(thetaMax) * cos(theta) from a sphere fully above its horizon
+    Point3 p{0.5f, 0, 0};
+    Vec3 toLight = lightSphere.center - p;
+    float sinThetaMax2 = lightSphere.radius * lightSphere.radius / toLight.lengthSquared();
+    float expected = albedo * emission * sinThetaMax2 * toLight.normalized().y;
+
+    // Two bounces: the floor, then the light or the enclosure, reached by light sampling and BSDF sampling alike
+    RNG rng{11};
+    double sum = 0.0;
+    const int samples = 50000;
+    for (int i = 0; i < samples; ++i)
+        sum += traceRay(Ray{Point3{0.5f, 1, 0}, Vec3{0, -1, 0}}, scene, rng, 2).x;
+
+    EXPECT_NEAR(sum / samples, expected, 0.02f * expected);
+}
+
+TEST(TraceRayTest, RussianRouletteKeepsTheMeanAndShortensPaths) {
+    // Grey room: light bounces many times before it fades, so deep paths matter
+    Scene scene;
+    int grey = scene.addDiffuse(Color(0.5f));
+    int light = scene.addEmissive(Color(4.0f));
+    scene.addPlane(Point3{0, 0, 0}, Vec3{0, 1, 0}, grey);
+    scene.addSphere(Point3{0, 0, 0}, 10.0f, grey);
+    scene.addSphere(Point3{0, 2, 0}, 0.5f, light);
+    scene.build();
+
+    Ray ray{Point3{1, 1, 0}, Vec3{0, -1, 0}};
+    const int samples = 100000;
+    auto estimate = [&](int rouletteDepth, double& averageLength) {
+        RNG rng{3};
+        double sum = 0.0;
+        long segments = 0;
+        for (int i = 0; i < samples; ++i) {
+            int pathLength = 0;
+            sum += traceRay(ray, scene, rng, 8, rouletteDepth, &pathLength).x;
+            segments += pathLength;
+        }
+        averageLength = static_cast<double>(segments) / samples;
+        return sum / samples;
+    };
+
+    double fullLength, rouletteLength;
+    double full = estimate(NoRoulette, fullLength);
+    double roulette = estimate(2, rouletteLength);
+
+    EXPECT_GT(fullLength, 7.0); // Nothing escapes the room, only hitting the light ends a path early
+    EXPECT_LT(rouletteLength, 4.0);
+    EXPECT_NEAR(roulette, full, 0.03 * full);
+}
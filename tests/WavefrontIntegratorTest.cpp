@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "renderer/WavefrontIntegrator.h"
+#include "renderer/TraceRay.h"
+#include "renderer/Camera.h"
+#include "renderer/Scene.h"
+#include "util/RNG.h"
+
+// ============================================================================
+// Wavefront Integrator Tests
+// ============================================================================
+
+namespace {
+
+// Grey room with one of every material type, lit by a small light and through an opening by the sky
+void buildRoom(Scene& scene) {
+    int grey = scene.addDiffuse(Color(0.6f));
+    int metal = scene.addMetal(Color(0.9f, 0.8f, 0.5f), 0.2f);
+    int plastic = scene.addPhysical(Color(0.2f, 0.4f, 0.8f), 0.0f, 0.4f);
+    int glass = scene.addDielectric(1.5f);
+    int light = scene.addEmissive(Color(8.0f));
+
+    scene.addPlane(Point3{0, 0, 0}, Vec3{0, 1, 0}, grey);
+    scene.addTriangle(Point3{-4, 0, -4}, Point3{4, 0, -4}, Point3{0, 6, -4}, grey);
+    scene.addSphere(Point3{-1.2f, 0.6f, -1}, 0.6f, metal);
+    scene.addSphere(Point3{0, 0.6f, -1.5f}, 0.6f, plastic);
+    scene.addSphere(Point3{1.2f, 0.6f, -1}, 0.6f, glass);
+    scene.addSphere(Point3{0, 2.5f, -1}, 0.3f, light);
+    scene.build();
+}
+
+} // namespace
+
+TEST(WavefrontIntegratorTest, MatchesTraceRay) {
+    Scene scene;
+    buildRoom(scene);
+
+    const int width = 12, height = 8, samples = 400;
+    Camera camera{Point3{0, 1, 3}, Point3{0, 0.8f, -1}, Vec3{0, 1, 0}, width, height, 50.0f};
+    Tile tile{0, 0, width, height};
+
+    // A batch far smaller than the tile's samples, so finished slots are refilled many times
+    WavefrontIntegrator wavefront{scene, camera, 6, 3, 256};
+    RNG rng{5};
+    std::vector<Color> pixels;
+    uint64_t segments = wavefront.renderTile(tile, samples, rng, pixels);
+    ASSERT_EQ(pixels.size(), size_t(width * height));
+
+    RNG referenceRng{9};
+    Color sum(0.0f), referenceSum(0.0f);
+    uint64_t referenceSegments = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            for (int s = 0; s < samples; ++s) {
+                int pathLength;
+                referenceSum += traceRay(camera.shootRay(x, y, referenceRng), scene, referenceRng, 6, 3, &pathLength);
+                referenceSegments += pathLength;
+            }
+            sum += pixels[y * width + x];
+        }
+    }
+    referenceSum /= static_cast<float>(samples);
+
+    for (int c = 0; c < 3; ++c)
+        EXPECT_NEAR(sum[c], referenceSum[c], 0.03f * referenceSum[c]);
+    EXPECT_NEAR(static_cast<double>(segments), static_cast<double>(referenceSegments), 0.02 * referenceSegments);
+}
+
+TEST(WavefrontIntegratorTest, CoversPartialTiles) {
+    Scene scene;
+    buildRoom(scene);
+
+    Camera camera{Point3{0, 1, 3}, Point3{0, 0.8f, -1}, Vec3{0, 1, 0}, 40, 30, 50.0f};
+    WavefrontIntegrator wavefront{scene, camera, 4};
+    RNG rng{1};
+    std::vector<Color> pixels;
+
+    // Each path traces at least its camera ray and at most maxDepth rays
+    Tile tile{32, 16, 40, 30};
+    uint64_t segments = wavefront.renderTile(tile, 3, rng, pixels);
+    ASSERT_EQ(pixels.size(), size_t(8 * 14));
+    EXPECT_GE(segments, uint64_t(8 * 14 * 3));
+    EXPECT_LE(segments, uint64_t(8 * 14 * 3 * 4));
+    for (const Color& pixel : pixels)
+        EXPECT_TRUE(std::isfinite(pixel.x) && pixel.x >= 0.0f);
+}
@@ -56,3 +56,28 @@ TEST(AABBTest, OperatorStream) {
     ss << box;
     EXPECT_EQ(ss.str(), "[[1, 2, 3], [4, 5, 6]]");
 }
+
+TEST(AABBTest, TraversalRayMatchesScalarTest) {
+    AABB box(Vec3{-1,-1,-1}, Vec3{1,1,1});
+
+    Ray rays[] = {
+        Ray(Vec3{-5, 0, 0}, Vec3{1, 0, 0}),     // Axis aligned hit
+        Ray(Vec3{-5, 2, 0}, Vec3{1, 0, 0}),     // Axis aligned miss
+        Ray(Vec3{5, 5, 5}, Vec3{-1, -1, -1}),   // Diagonal hit with negative direction
+        Ray(Vec3{5, 5, 5}, Vec3{1, 1, 1}),      // Pointing away
+        Ray(Vec3{0, 0, 0}, Vec3{0, 1, 0}),      // Origin inside
+    };
+
+    for (const Ray& ray : rays) {
+        EXPECT_EQ(box.hit(TraversalRay{ray}, 0.0f, 100.0f), box.hit(ray, 0.0f, 100.0f));
+    }
+}
+
+TEST(AABBTest, TraversalRaySignBits) {
+    TraversalRay ray{Ray(Vec3{0, 0, 0}, Vec3{-1, 2, 0})};
+
+    EXPECT_EQ(ray.sign[0], 1);
+    EXPECT_EQ(ray.sign[1], 0);
+    EXPECT_EQ(ray.sign[2], 0);
+    EXPECT_TRUE(std::isfinite(ray.invDirection.z)); // Zero component stays finite
+}
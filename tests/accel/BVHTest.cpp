@@ -6,9 +6,11 @@
 #include "core/Ray.h"
 #include "core/HitRecord.h"
 #include "core/Vec3.h"
+#include "util/RNG.h"
 #include <memory>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 // ============================================================================
 // Test Fixtures
@@ -224,6 +226,250 @@ TEST_F(BVHTest, LargeScenePerformance) {
     EXPECT_TRUE(hit);
 }
 
+// ============================================================================
+// Build Method Tests
+// ============================================================================
+
+TEST_F(BVHTest, BuildMethodsAgreeOnClosestHit) {
+    RNG rng{7};
+    for (int i = 0; i < 200; ++i) {
+        addSphere(Vec3(rng.uniform(-20, 20), rng.uniform(-2, 2), rng.uniform(-20, 20)), rng.uniform(0.1f, 1.0f));
+    }
+
+    Scene medianScene = *scene;
+    scene->build({.method = BVHBuildMethod::SAH});
+    medianScene.build({.method = BVHBuildMethod::Median});
+
+    for (int i = 0; i < 500; ++i) {
+        Vec3 origin(rng.uniform(-25, 25), rng.uniform(-5, 5), rng.uniform(-25, 25));
+        Vec3 target(rng.uniform(-20, 20), rng.uniform(-2, 2), rng.uniform(-20, 20));
+        Ray ray(origin, target - origin);
+
+        HitRecord sahRecord, medianRecord;
+        bool sahHit = scene->intersect(sahRecord, ray, 0.001f, 100.0f);
+        bool medianHit = medianScene.intersect(medianRecord, ray, 0.001f, 100.0f);
+
+        ASSERT_EQ(sahHit, medianHit);
+        if (sahHit) {
+            EXPECT_FLOAT_EQ(sahRecord.t, medianRecord.t);
+        }
+    }
+}
+
+TEST_F(BVHTest, SAHBuildLowersCostOnClusteredScene) {
+    // Two tight clusters far apart plus one large outlier, similar to a ground sphere with props
+    RNG rng{3};
+    for (int i = 0; i < 100; ++i) {
+        addSphere(Vec3(rng.uniform(-1, 1), 0, rng.uniform(-1, 1)), 0.1f);
+        addSphere(Vec3(50 + rng.uniform(-1, 1), 0, rng.uniform(-1, 1)), 0.1f);
+    }
+    addSphere(Vec3(0, -1000, 0), 1000.0f);
+
+    BVHTree median;
+    median.build(*scene, {.method = BVHBuildMethod::Median});
+    BVHTree sah;
+    sah.build(*scene, {.method = BVHBuildMethod::SAH});
+
+    EXPECT_LT(sah.sahCost(), median.sahCost());
+}
+
+TEST_F(BVHTest, SAHBuildHandlesCoincidentCentroids) {
+    for (int i = 0; i < 16; ++i) {
+        addSphere(Vec3(0, 0, -5), 0.5f + 0.1f * i);
+    }
+    scene->build({.method = BVHBuildMethod::SAH});
+
+    Ray ray(Vec3(0, 0, 0), Vec3(0, 0, -1));
+    HitRecord record;
+    ASSERT_TRUE(scene->intersect(record, ray, 0.001f, 100.0f));
+    EXPECT_NEAR(record.t, 5.0f - 2.0f, 1e-4f);  // Largest radius is 2.0
+}
+
+// ============================================================================
+// Leaf Range Tests
+// ============================================================================
+
+TEST_F(BVHTest, LeavesRespectMaxLeafSize) {
+    RNG rng{11};
+    for (int i = 0; i < 300; ++i) {
+        addSphere(Vec3(rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)), 0.2f);
+    }
+
+    for (BVHBuildMethod method : {BVHBuildMethod::Median, BVHBuildMethod::SAH, BVHBuildMethod::LBVH}) {
+        BVHTree tree;
+        tree.build(*scene, {.method = method, .maxLeafSize = 6});
+
+        int covered = 0;
+        for (const BVHNode& node : tree.getNodes()) {
+            if (!node.isLeaf()) continue;
+            EXPECT_LE(node.primitiveCount, 6);
+            covered += node.primitiveCount;
+        }
+        EXPECT_EQ(covered, 300);
+    }
+
+    // The median builder fills leaves up to the limit; SAH only does so when it pays off
+    BVHTree median;
+    median.build(*scene, {.method = BVHBuildMethod::Median, .maxLeafSize = 6});
+    EXPECT_LT(median.getNodes().size(), 300u);
+}
+
+TEST_F(BVHTest, PrimitiveIndicesArePermutation) {
+    for (int i = 0; i < 50; ++i) {
+        addSphere(Vec3(i * 1.5f, 0, 0), 0.5f);
+    }
+    scene->build({.maxLeafSize = 8});
+
+    std::vector<int> indices = scene->getBVH().getPrimitiveIndices();
+    std::sort(indices.begin(), indices.end());
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(indices[i], i);
+    }
+}
+
+TEST_F(BVHTest, LeafBoxesContainTheirPrimitives) {
+    RNG rng{5};
+    for (int i = 0; i < 100; ++i) {
+        addSphere(Vec3(rng.uniform(-5, 5), rng.uniform(-5, 5), 0), rng.uniform(0.1f, 0.5f));
+    }
+    scene->build();
+
+    const BVHTree& tree = scene->getBVH();
+    for (const BVHNode& node : tree.getNodes()) {
+        if (!node.isLeaf()) continue;
+        for (int i = node.offset; i < node.offset + node.primitiveCount; ++i) {
+            AABB box = scene->primitiveBounds(tree.getPrimitiveIndices()[i]);
+            EXPECT_EQ(surroundingBox(node.box, box).min, node.box.min);
+            EXPECT_EQ(surroundingBox(node.box, box).max, node.box.max);
+        }
+    }
+}
+
+// ============================================================================
+// Parallel Build Tests
+// ============================================================================
+
+static void expectSameTree(const BVHTree& expected, const BVHTree& actual) {
+    ASSERT_EQ(expected.getNodes().size(), actual.getNodes().size());
+    for (size_t i = 0; i < expected.getNodes().size(); ++i) {
+        const BVHNode& a = expected.getNodes()[i];
+        const BVHNode& b = actual.getNodes()[i];
+        ASSERT_EQ(a.box.min, b.box.min) << "node " << i;
+        ASSERT_EQ(a.box.max, b.box.max) << "node " << i;
+        ASSERT_EQ(a.offset, b.offset) << "node " << i;
+        ASSERT_EQ(a.primitiveCount, b.primitiveCount) << "node " << i;
+        ASSERT_EQ(a.axis, b.axis) << "node " << i;
+    }
+    EXPECT_EQ(expected.getPrimitiveIndices(), actual.getPrimitiveIndices());
+}
+
+TEST_F(BVHTest, ParallelBuildMatchesSerial) {
+    // Large enough to take the parallel path, with clusters so the top splits are uneven
+    RNG rng{99};
+    for (int i = 0; i < 40000; ++i) {
+        Vec3 cluster(rng.uniformInt(0, 4) * 50.0f, 0, rng.uniformInt(0, 3) * 50.0f);
+        addSphere(cluster + Vec3(rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)), rng.uniform(0.05f, 0.5f));
+    }
+
+    for (BVHBuildMethod method : {BVHBuildMethod::SAH, BVHBuildMethod::Median, BVHBuildMethod::LBVH}) {
+        BVHTree serial;
+        serial.build(*scene, {.method = method, .threadCount = 1});
+
+        for (int threads : {2, 3, 8}) {
+            BVHTree parallel;
+            parallel.build(*scene, {.method = method, .threadCount = threads});
+            expectSameTree(serial, parallel);
+        }
+    }
+}
+
+TEST_F(BVHTest, LBVHAgreesWithSAHOnClosestHit) {
+    RNG rng{21};
+    for (int i = 0; i < 500; ++i) {
+        addSphere(Vec3(rng.uniform(-20, 20), rng.uniform(-2, 2), rng.uniform(-20, 20)), rng.uniform(0.1f, 1.0f));
+    }
+    // Coincident centroids share a Morton code and must still be split
+    for (int i = 0; i < 20; ++i) {
+        addSphere(Vec3(3, 0, 3), 0.2f + 0.05f * i);
+    }
+
+    Scene linearScene = *scene;
+    scene->build({.method = BVHBuildMethod::SAH});
+    linearScene.build({.method = BVHBuildMethod::LBVH});
+
+    for (int i = 0; i < 500; ++i) {
+        Vec3 origin(rng.uniform(-25, 25), rng.uniform(-5, 5), rng.uniform(-25, 25));
+        Vec3 target(rng.uniform(-20, 20), rng.uniform(-2, 2), rng.uniform(-20, 20));
+        Ray ray(origin, target - origin);
+
+        HitRecord sahRecord, linearRecord;
+        bool sahHit = scene->intersect(sahRecord, ray, 0.001f, 100.0f);
+        bool linearHit = linearScene.intersect(linearRecord, ray, 0.001f, 100.0f);
+
+        ASSERT_EQ(sahHit, linearHit);
+        if (sahHit) {
+            EXPECT_FLOAT_EQ(sahRecord.t, linearRecord.t);
+        }
+    }
+}
+
+TEST_F(BVHTest, LBVHSplitsAlongMortonOrder) {
+    // Points on a line: the first split must separate the two halves of the x range
+    for (int i = 0; i < 64; ++i) {
+        addSphere(Vec3(static_cast<float>(i), 0, 0), 0.25f);
+    }
+
+    BVHTree tree;
+    tree.build(*scene, {.method = BVHBuildMethod::LBVH, .maxLeafSize = 1});
+
+    const auto& nodes = tree.getNodes();
+    const BVHNode& root = nodes[0];
+    ASSERT_FALSE(root.isLeaf());
+    EXPECT_EQ(root.axis, 0);
+    EXPECT_LT(nodes[root.left()].box.max.x, nodes[root.right()].box.min.x);
+    EXPECT_EQ(nodes.size(), 127u);
+}
+
+TEST_F(BVHTest, RefitTracksMovedPrimitives) {
+    // Large enough for refit to split into parallel subtree tasks
+    RNG rng{31};
+    for (int i = 0; i < 20000; ++i) {
+        addSphere(Vec3(rng.uniform(-30, 30), rng.uniform(-30, 30), rng.uniform(-30, 30)), 0.5f);
+    }
+
+    BVHTree serial, parallel;
+    serial.build(*scene, {.threadCount = 1});
+    parallel.build(*scene, {.threadCount = 4});
+
+    for (int i = 0; i < 20000; ++i) {
+        const Sphere& sphere = scene->getSpheres()[i];
+        scene->updateSphere(i, sphere.center + Vec3(rng.uniform(-2, 2), rng.uniform(-2, 2), rng.uniform(-2, 2)), 0.75f);
+    }
+    serial.refit(*scene);
+    parallel.refit(*scene);
+    expectSameTree(serial, parallel);
+
+    // Every node box must again enclose the primitives below it
+    const auto& nodes = serial.getNodes();
+    const auto& indices = serial.getPrimitiveIndices();
+    for (const BVHNode& node : nodes) {
+        if (!node.isLeaf()) {
+            AABB children = surroundingBox(nodes[node.left()].box, nodes[node.right()].box);
+            EXPECT_EQ(node.box.min, children.min);
+            EXPECT_EQ(node.box.max, children.max);
+            continue;
+        }
+        for (int i = node.offset; i < node.offset + node.primitiveCount; ++i) {
+            AABB box = scene->primitiveBounds(indices[i]);
+            for (int a = 0; a < 3; ++a) {
+                EXPECT_LE(node.box.min[a], box.min[a]);
+                EXPECT_GE(node.box.max[a], box.max[a]);
+            }
+        }
+    }
+    EXPECT_GT(serial.sahDegradation(), 1.0f);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "accel/QuantizedBVH.h"
+#include "renderer/Scene.h"
+#include "util/RNG.h"
+
+// ============================================================================
+// Quantization Tests
+// ============================================================================
+
+// Every decoded child box must contain the exact one, and be at most one grid step larger per side
+static void expectConservative(const Scene& scene) {
+    BVH4 wide;
+    wide.build(scene.getBVH());
+    const auto& exact = wide.getNodes();
+    const auto& quantized = scene.getQuantizedBVH().getNodes();
+    ASSERT_EQ(exact.size(), quantized.size());
+
+    for (size_t i = 0; i < exact.size(); ++i) {
+        ASSERT_EQ(exact[i].childCount, quantized[i].childCount);
+        for (int lane = 0; lane < exact[i].childCount; ++lane) {
+            AABB box = quantized[i].childBounds(lane);
+            const float mins[3] = {exact[i].minX[lane], exact[i].minY[lane], exact[i].minZ[lane]};
+            const float maxs[3] = {exact[i].maxX[lane], exact[i].maxY[lane], exact[i].maxZ[lane]};
+
+            for (int a = 0; a < 3; ++a) {
+                float step = std::ldexp(1.0f, quantized[i].exponent[a]);
+                EXPECT_LE(box.min[a], mins[a]) << "node " << i << " lane " << lane;
+                EXPECT_GE(box.max[a], maxs[a]) << "node " << i << " lane " << lane;
+                EXPECT_LE(mins[a] - box.min[a], 2 * step);
+                EXPECT_LE(box.max[a] - maxs[a], 2 * step);
+            }
+            EXPECT_EQ(quantized[i].child[lane], exact[i].child[lane]);
+            EXPECT_EQ(quantized[i].primitiveCount[lane], exact[i].primitiveCount[lane]);
+        }
+    }
+}
+
+TEST(QuantizedBVHTest, DecodedBoundsAreConservative) {
+    Scene scene;
+    RNG rng{51};
+    for (int i = 0; i < 2000; ++i) {
+        scene.addSphere(Vec3(rng.uniform(-50, 50), rng.uniform(-50, 50), rng.uniform(-50, 50)), rng.uniform(0.01f, 2.0f), 0);
+    }
+    scene.build({}, Scene::BVHLayout::Quantized4);
+    expectConservative(scene);
+}
+
+TEST(QuantizedBVHTest, TinyPrimitivesFarFromOrigin) {
+    // Node extents near float precision at the coordinate magnitude stress the rounding guards
+    Scene scene;
+    RNG rng{52};
+    for (int i = 0; i < 500; ++i) {
+        Vec3 center(1.0e5f + rng.uniform(0, 1), -3.0e4f + rng.uniform(0, 1), 7.0e4f);
+        scene.addSphere(center, rng.uniform(0.001f, 0.01f), 0);
+    }
+    scene.addSphere(Vec3(0, 0, 0), 1.0f, 0);
+    scene.build({}, Scene::BVHLayout::Quantized4);
+    expectConservative(scene);
+
+    // Flat along z: one axis has zero extent
+    Scene flat;
+    for (int i = 0; i < 64; ++i)
+        flat.addSphere(Vec3(static_cast<float>(i % 8), static_cast<float>(i / 8), 0), 0.0f, 0);
+    flat.build({}, Scene::BVHLayout::Quantized4);
+    expectConservative(flat);
+}
+
+TEST(QuantizedBVHTest, HalfOfUncompressedNodeMemory) {
+    Scene scene;
+    RNG rng{53};
+    for (int i = 0; i < 1000; ++i) {
+        scene.addSphere(Vec3(rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)), 0.1f, 0);
+    }
+    scene.build({}, Scene::BVHLayout::Quantized4);
+
+    BVH4 wide;
+    wide.build(scene.getBVH());
+    size_t quantizedBytes = scene.getQuantizedBVH().getNodes().size() * sizeof(QuantizedBVHNode);
+    size_t wideBytes = wide.getNodes().size() * sizeof(BVH4::Node);
+    size_t binaryBytes = scene.getBVH().getNodes().size() * sizeof(BVHNode);
+
+    EXPECT_LE(quantizedBytes * 2, wideBytes);
+    EXPECT_LE(quantizedBytes * 2, binaryBytes);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "accel/WideBVH.h"
+#include "renderer/Scene.h"
+#include "core/Ray.h"
+#include "core/HitRecord.h"
+#include "util/RNG.h"
+
+// ============================================================================
+// Test Fixtures
+// ============================================================================
+
+class WideBVHTest : public ::testing::TestWithParam<Scene::BVHLayout> {
+protected:
+    void SetUp() override {
+        defaultMat = scene.addDiffuse(Vec3(0.5f, 0.5f, 0.5f));
+    }
+
+    void addRandomSpheres(int count, uint64_t seed) {
+        RNG rng{seed};
+        for (int i = 0; i < count; ++i) {
+            Vec3 center(rng.uniform(-20, 20), rng.uniform(-20, 20), rng.uniform(-20, 20));
+            scene.addSphere(center, rng.uniform(0.1f, 1.5f), defaultMat);
+        }
+    }
+
+    Scene scene;
+    int defaultMat;
+};
+
+// ============================================================================
+// Traversal Tests
+// ============================================================================
+
+TEST_P(WideBVHTest, EmptySceneMisses) {
+    scene.build({}, GetParam());
+
+    Ray ray(Vec3(0, 0, 0), Vec3(0, 0, -1));
+    HitRecord record;
+    EXPECT_FALSE(scene.intersect(record, ray, 0.001f, 100.0f));
+}
+
+TEST_P(WideBVHTest, SingleSphereRootLeaf) {
+    scene.addSphere(Vec3(0, 0, -5), 1.0f, defaultMat);
+    scene.build({}, GetParam());
+
+    Ray ray(Vec3(0, 0, 0), Vec3(0, 0, -1));
+    HitRecord record;
+    ASSERT_TRUE(scene.intersect(record, ray, 0.001f, 100.0f));
+    EXPECT_NEAR(record.t, 4.0f, 1e-4f);
+}
+
+TEST_P(WideBVHTest, AxisAlignedRaysThroughGrid) {
+    // Axis-aligned rays exercise the zero-direction path of the slab test
+    for (int x = 0; x < 6; ++x)
+        for (int y = 0; y < 6; ++y)
+            scene.addSphere(Vec3(x * 3.0f, y * 3.0f, -10), 1.0f, defaultMat);
+    scene.build({}, GetParam());
+
+    for (int x = 0; x < 6; ++x) {
+        Ray ray(Vec3(x * 3.0f, 3.0f, 0), Vec3(0, 0, -1));
+        HitRecord record;
+        ASSERT_TRUE(scene.intersect(record, ray, 0.001f, 100.0f));
+        EXPECT_NEAR(record.t, 9.0f, 1e-4f);
+    }
+}
+
+TEST_P(WideBVHTest, MatchesBinaryTree) {
+    addRandomSpheres(1000, 9);
+
+    Scene binary = scene;
+    binary.build({}, Scene::BVHLayout::Binary);
+    scene.build({}, GetParam());
+
+    RNG rng{21};
+    for (int i = 0; i < 2000; ++i) {
+        Vec3 origin(rng.uniform(-30, 30), rng.uniform(-30, 30), rng.uniform(-30, 30));
+        Vec3 target(rng.uniform(-20, 20), rng.uniform(-20, 20), rng.uniform(-20, 20));
+        Ray ray(origin, target - origin);
+
+        HitRecord expected, actual;
+        bool expectedHit = binary.intersect(expected, ray, 0.001f, 100.0f);
+        bool actualHit = scene.intersect(actual, ray, 0.001f, 100.0f);
+
+        ASSERT_EQ(expectedHit, actualHit);
+        if (expectedHit) {
+            EXPECT_FLOAT_EQ(expected.t, actual.t);
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Layouts,
+    WideBVHTest,
+    ::testing::Values(Scene::BVHLayout::Wide4, Scene::BVHLayout::Wide8, Scene::BVHLayout::Quantized4)
+);
+
+// ============================================================================
+// Collapse Tests
+// ============================================================================
+
+TEST(WideBVHCollapseTest, EveryPrimitiveReachableOnce) {
+    Scene scene;
+    int mat = scene.addDiffuse(Vec3(0.5f));
+    RNG rng{4};
+    for (int i = 0; i < 500; ++i)
+        scene.addSphere(Vec3(rng.uniform(-10, 10), rng.uniform(-10, 10), rng.uniform(-10, 10)), 0.2f, mat);
+    scene.build({}, Scene::BVHLayout::Wide8);
+
+    const BVH8& tree = scene.getBVH8();
+    int leafPrimitives = 0;
+    for (const BVH8::Node& node : tree.getNodes()) {
+        EXPECT_GE(node.childCount, 1);
+        EXPECT_LE(node.childCount, 8);
+        for (int lane = 0; lane < node.childCount; ++lane)
+            if (node.isLeaf(lane)) leafPrimitives += node.primitiveCount[lane];
+    }
+    EXPECT_EQ(leafPrimitives, 500);
+    EXPECT_LT(tree.getNodes().size(), scene.getBVH().getNodes().size() / 4);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "core/Transform.h"
+
+static void expectNear(const Vec3& a, const Vec3& b, float tolerance = 1e-5f) {
+    EXPECT_NEAR(a.x, b.x, tolerance);
+    EXPECT_NEAR(a.y, b.y, tolerance);
+    EXPECT_NEAR(a.z, b.z, tolerance);
+}
+
+TEST(TransformTest, IdentityLeavesPointsUnchanged) {
+    Point3 p{1, 2, 3};
+    EXPECT_EQ(Transform::identity().applyPoint(p), p);
+    EXPECT_EQ(Transform::identity().applyVector(p), p);
+}
+
+TEST(TransformTest, TranslateMovesPointsButNotVectors) {
+    Transform t = Transform::translate(Vec3{1, -2, 3});
+    EXPECT_EQ(t.applyPoint(Point3{0, 0, 0}), Point3(1, -2, 3));
+    EXPECT_EQ(t.applyVector(Vec3{0, 0, 1}), Vec3(0, 0, 1));
+}
+
+TEST(TransformTest, RotateQuarterTurnAroundY) {
+    Transform t = Transform::rotate(Vec3{0, 1, 0}, 3.14159265f / 2);
+    expectNear(t.applyVector(Vec3{1, 0, 0}), Vec3(0, 0, -1));
+    expectNear(t.applyVector(Vec3{0, 1, 0}), Vec3(0, 1, 0));
+}
+
+TEST(TransformTest, CompositionAppliesRightOperandFirst) {
+    Transform t = Transform::translate(Vec3{5, 0, 0}) * Transform::scale(Vec3{2});
+    expectNear(t.applyPoint(Point3{1, 1, 1}), Point3(7, 2, 2));
+}
+
+TEST(TransformTest, InverseUndoesTransform) {
+    Transform t = Transform::translate(Vec3{1, 2, 3})
+                * Transform::rotate(Vec3{1, 1, 0}, 0.7f)
+                * Transform::scale(Vec3{2, 0.5f, 3});
+    Transform inv = t.inverse();
+
+    Point3 p{-4, 0.5f, 9};
+    expectNear(inv.applyPoint(t.applyPoint(p)), p, 1e-4f);
+    expectNear(t.applyPoint(inv.applyPoint(p)), p, 1e-4f);
+}
+
+TEST(TransformTest, NormalsStayPerpendicularUnderNonUniformScale) {
+    Transform t = Transform::scale(Vec3{4, 1, 1}) * Transform::rotate(Vec3{0, 0, 1}, 0.3f);
+    Vec3 tangent{1, 1, 0};
+    Vec3 normal{1, -1, 0};
+
+    Vec3 worldTangent = t.applyVector(tangent);
+    Vec3 worldNormal = t.inverse().applyTransposed(normal);
+    EXPECT_NEAR(dot(worldTangent, worldNormal), 0.0f, 1e-5f);
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "geometry/OBJLoader.h"
+#include <sstream>
+
+TEST(OBJLoaderTest, ReadsVerticesAndTriangulatesFaces) {
+    std::istringstream obj(
+        "# unit quad and a triangle\n"
+        "o quad\n"
+        "v 0 0 0\n"
+        "v 1 0 0\r\n"
+        "v 1 1 0\n"
+        "v 0 1 0\n"
+        "vt 0 0\n"
+        "vn 0 0 1\n"
+        "usemtl gray\n"
+        "f 1/1/1 2/1/1 3/1/1 4/1/1\n"
+        "v +2.5 -1e1 .5\n"
+        "f -3 -2 -1\n");
+
+    TriangleMesh mesh;
+    ASSERT_TRUE(loadOBJ(obj, mesh));
+    ASSERT_EQ(mesh.vertices.size(), 5u);
+    EXPECT_EQ(mesh.vertices[4], Vec3(2.5f, -10.0f, 0.5f));
+
+    // Quad fans from its first vertex, then the relative triangle
+    std::vector<int> expected{0, 1, 2, 0, 2, 3, 2, 3, 4};
+    EXPECT_EQ(mesh.indices, expected);
+}
+
+TEST(OBJLoaderTest, RejectsMalformedInput) {
+    TriangleMesh mesh;
+
+    std::istringstream badVertex("v 1 2\n");
+    EXPECT_FALSE(loadOBJ(badVertex, mesh));
+
+    std::istringstream shortFace("v 0 0 0\nv 1 0 0\nf 1 2\n");
+    EXPECT_FALSE(loadOBJ(shortFace, mesh));
+
+    std::istringstream outOfRange("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n");
+    EXPECT_FALSE(loadOBJ(outOfRange, mesh));
+    EXPECT_TRUE(mesh.indices.empty());
+
+    std::istringstream relativeOutOfRange("v 0 0 0\nf -1 -2 -3\n");
+    EXPECT_FALSE(loadOBJ(relativeOutOfRange, mesh));
+
+    EXPECT_FALSE(loadOBJ("/nonexistent/mesh.obj", mesh));
+}
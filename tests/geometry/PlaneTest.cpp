@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include "geometry/Plane.h"
+#include "core/HitRecord.h"
+#include "core/Ray.h"
+
+TEST(PlaneTest, RayHitsGroundFromAbove) {
+    Plane ground{Point3{0, 0, 0}, Vec3{0, 1, 0}, 2};
+    Ray ray{Point3{3, 4, -1}, Vec3{0, -1, 0}};
+
+    float t = 100.0f;
+    ASSERT_TRUE(planeIntersect(ground, ray, 0.001f, t));
+    EXPECT_FLOAT_EQ(t, 4.0f);
+
+    HitRecord record;
+    planeHitRecord(ground, record, ray, t);
+    EXPECT_EQ(record.position, Vec3(3, 0, -1));
+    EXPECT_EQ(record.normal, Vec3(0, 1, 0));
+    EXPECT_TRUE(record.frontFace);
+    EXPECT_EQ(record.materialIndex, 2);
+}
+
+TEST(PlaneTest, UndersideFacesAwayFromNormal) {
+    Plane ground{Point3{0, 0, 0}, Vec3{0, 1, 0}, 0};
+    Ray ray{Point3{0, -2, 0}, Vec3{0, 1, 0}};
+
+    float t = 100.0f;
+    ASSERT_TRUE(planeIntersect(ground, ray, 0.001f, t));
+
+    HitRecord record;
+    planeHitRecord(ground, record, ray, t);
+    EXPECT_EQ(record.normal, Vec3(0, -1, 0));
+    EXPECT_FALSE(record.frontFace);
+}
+
+TEST(PlaneTest, MissesParallelBehindAndBeyondTMax) {
+    Plane ground{Point3{0, 0, 0}, Vec3{0, 1, 0}, 0};
+
+    float t = 100.0f;
+    EXPECT_FALSE(planeIntersect(ground, Ray{Point3{0, 1, 0}, Vec3{1, 0, 0}}, 0.001f, t));
+    EXPECT_FALSE(planeIntersect(ground, Ray{Point3{0, 1, 0}, Vec3{0, 1, 0}}, 0.001f, t));
+    EXPECT_FLOAT_EQ(t, 100.0f);
+
+    EXPECT_FALSE(planeOccludes(ground, Ray{Point3{0, 5, 0}, Vec3{0, -1, 0}}, 0.001f, 4.0f));
+    EXPECT_TRUE(planeOccludes(ground, Ray{Point3{0, 5, 0}, Vec3{0, -1, 0}}, 0.001f, 6.0f));
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "geometry/QuantizedSpheres.h"
+#include "core/Ray.h"
+#include "util/RNG.h"
+#include <cmath>
+
+// Spatially sorted clusters, as BVH leaf order would give, with few or many distinct radii
+static std::vector<Sphere> makeSpheres(int count, bool fewRadii, uint32_t seed) {
+    RNG rng(seed);
+    std::vector<Sphere> spheres;
+    for (int i = 0; i < count; ++i) {
+        Point3 cluster{float(i / 8) * 3.0f - 50.0f, rng.uniform(-2.0f, 2.0f), rng.uniform(-2.0f, 2.0f)};
+        Point3 center = cluster + Vec3{rng.uniform(0.0f, 1.3f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f)};
+        float radius = fewRadii ? 0.1f * float(1 + i % 4) : rng.uniform(0.05f, 0.6f);
+        spheres.push_back({center, radius, i % 5});
+    }
+    return spheres;
+}
+
+static Vec3 randomUnitVector(RNG& rng) {
+    Vec3 v{rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f)};
+    return v.length() > 1e-3f ? v.normalized() : Vec3{0, 0, 1};
+}
+
+TEST(QuantizedSpheresTest, DecodedSpheresEncloseOriginals) {
+    for (bool fewRadii : {true, false}) {
+        std::vector<Sphere> spheres = makeSpheres(1003, fewRadii, 5);
+        QuantizedSpheres quantized;
+        ASSERT_TRUE(quantized.build(spheres));
+        EXPECT_EQ(quantized.size(), spheres.size());
+        EXPECT_EQ(quantized.hasPalette(), fewRadii);
+        EXPECT_LT(quantized.memoryBytes(), spheres.size() * 15);
+
+        for (size_t i = 0; i < spheres.size(); ++i) {
+            Sphere decoded = quantized.get(i);
+            EXPECT_EQ(decoded.materialIndex, spheres[i].materialIndex);
+
+            // Distance between centers plus the original radius must fit inside the decoded radius
+            double distance = 0.0;
+            for (int axis = 0; axis < 3; ++axis) {
+                double d = double(decoded.center[axis]) - spheres[i].center[axis];
+                distance += d * d;
+            }
+            EXPECT_LE(std::sqrt(distance) + spheres[i].radius, decoded.radius);
+            EXPECT_LT(decoded.radius - spheres[i].radius, 1e-3f); // 16 bits over a few units
+        }
+    }
+}
+
+TEST(QuantizedSpheresTest, NoRayMissesOriginalGeometry) {
+    for (bool fewRadii : {true, false}) {
+        std::vector<Sphere> spheres = makeSpheres(517, fewRadii, 9);
+        QuantizedSpheres quantized;
+        ASSERT_TRUE(quantized.build(spheres));
+
+        // Ranges start and end inside batches, as leaves of a BVH do
+        const int ranges[][2] = {{0, 1}, {0, 8}, {3, 5}, {5, 11}, {13, 4}, {500, 17}, {0, 517}};
+        RNG rng(17);
+        int hits = 0;
+        for (int r = 0; r < 3000; ++r) {
+            Point3 origin{rng.uniform(-55.0f, 55.0f), rng.uniform(-4.0f, 4.0f), 10.0f};
+            Ray ray{origin, (randomUnitVector(rng) * 0.5f + Vec3{0, 0, -1}).normalized()};
+
+            for (const auto& range : ranges) {
+                int expected = -1;
+                float expectedT = 100.0f;
+                for (int i = range[0]; i < range[0] + range[1]; ++i) {
+                    if (sphereIntersect(spheres[i], ray, 0.001f, expectedT)) expected = i;
+                }
+
+                float t = 100.0f;
+                int slot = quantized.intersect(ray, range[0], range[1], 0.001f, t);
+                if (slot >= 0) {
+                    EXPECT_GE(slot, range[0]);
+                    EXPECT_LT(slot, range[0] + range[1]);
+                }
+                if (expected < 0) continue;
+
+                // The quantized spheres enclose the originals: a hit is never lost, only found slightly sooner
+                // (up to float noise in t, and by more near grazing angles)
+                ASSERT_GE(slot, 0);
+                EXPECT_LE(t, expectedT + 1e-3f);
+                EXPECT_GT(t, expectedT - 1e-2f);
+                EXPECT_TRUE(quantized.occludes(ray, range[0], range[1], 0.001f, 100.0f));
+                hits++;
+            }
+        }
+        EXPECT_GT(hits, 100);
+    }
+}
+
+TEST(QuantizedSpheresTest, RejectsMaterialsBeyondSixteenBits) {
+    std::vector<Sphere> spheres = makeSpheres(20, true, 3);
+    spheres[7].materialIndex = 70000;
+
+    QuantizedSpheres quantized;
+    EXPECT_FALSE(quantized.build(spheres));
+    EXPECT_EQ(quantized.size(), 0u);
+}
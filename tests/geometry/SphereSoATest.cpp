@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "geometry/SphereSoA.h"
+#include "core/HitRecord.h"
+#include "core/Ray.h"
+#include "util/RNG.h"
+#include <cmath>
+
+namespace {
+
+// Nearest hit over spheres[first, first + count) one sphere at a time, as the per-primitive path does
+int scalarClosest(const std::vector<Sphere>& spheres, const Ray& ray, int first, int count, float tMin, float& tClosest) {
+    int best = -1;
+    HitRecord record;
+    for (int i = first; i < first + count; ++i) {
+        if (sphereHit(spheres[i], record, ray, tMin, tClosest)) {
+            best = i;
+            tClosest = record.t;
+        }
+    }
+    return best;
+}
+
+Vec3 randomUnitVector(RNG& rng) {
+    Vec3 v{rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f)};
+    return v.length() > 1e-3f ? v.normalized() : Vec3{0, 0, 1};
+}
+
+} // namespace
+
+TEST(SphereSoATest, MatchesScalarSphereHit) {
+    RNG rng(42);
+    std::vector<Sphere> spheres;
+    for (int i = 0; i < 37; ++i) {
+        Point3 center{rng.uniform(-5.0f, 5.0f), rng.uniform(-5.0f, 5.0f), rng.uniform(-5.0f, 5.0f)};
+        spheres.push_back({center, rng.uniform(0.2f, 1.7f), i});
+    }
+
+    SphereSoA soa;
+    soa.resize(spheres.size());
+    for (size_t i = 0; i < spheres.size(); ++i)
+        soa.set(i, spheres[i]);
+
+    // Ranges cover single spheres, partial batches, batches straddling lanes and the padded tail
+    const int ranges[][2] = {{0, 1}, {0, 8}, {3, 5}, {5, 11}, {8, 16}, {30, 7}, {36, 1}, {0, 37}};
+    int hits = 0;
+    for (int r = 0; r < 2000; ++r) {
+        Point3 origin = randomUnitVector(rng) * 8.0f;
+        Ray ray{origin, (randomUnitVector(rng) * 2.0f - origin * 0.1f).normalized()};
+
+        for (const auto& range : ranges) {
+            float expectedT = 100.0f;
+            int expected = scalarClosest(spheres, ray, range[0], range[1], 0.001f, expectedT);
+
+            float t = 100.0f;
+            int slot = soa.intersect(ray, range[0], range[1], 0.001f, t);
+
+            ASSERT_EQ(slot, expected);
+            EXPECT_EQ(soa.occludes(ray, range[0], range[1], 0.001f, 100.0f), expected >= 0);
+            if (expected >= 0) {
+                EXPECT_NEAR(t, expectedT, 1e-4f * expectedT);
+                hits++;
+            }
+        }
+    }
+    EXPECT_GT(hits, 1000);
+}
+
+TEST(SphereSoATest, EmptySlotsNeverHit) {
+    SphereSoA soa;
+    soa.resize(4);
+    soa.set(0, Sphere{Point3{0, 0, 10}, 1.0f, 0});
+    soa.setEmpty(1);
+    soa.set(2, Sphere{Point3{0, 0, 5}, 1.0f, 2});
+    soa.setEmpty(3);
+
+    EXPECT_FALSE(soa.isEmpty(0));
+    EXPECT_TRUE(soa.isEmpty(1));
+    EXPECT_EQ(soa.get(2).materialIndex, 2);
+    EXPECT_FLOAT_EQ(soa.get(2).radius, 1.0f);
+
+    // An empty slot sits at the origin, so a ray through it would hit any real sphere there
+    Ray ray{Point3{0, 0, -5}, Vec3{0, 0, 1}};
+    float t = 100.0f;
+    EXPECT_EQ(soa.intersect(ray, 0, 4, 0.001f, t), 2);
+    EXPECT_FLOAT_EQ(t, 9.0f);
+
+    t = 100.0f;
+    EXPECT_EQ(soa.intersect(ray, 1, 1, 0.001f, t), -1);
+    EXPECT_FALSE(soa.occludes(ray, 3, 1, 0.001f, 100.0f));
+}
+
+TEST(SphereSoATest, RespectsTClosest) {
+    SphereSoA soa;
+    soa.resize(2);
+    soa.set(0, Sphere{Point3{0, 0, 3}, 1.0f, 0});
+    soa.set(1, Sphere{Point3{0, 0, 8}, 1.0f, 1});
+
+    Ray ray{Point3{0, 0, 0}, Vec3{0, 0, 1}};
+    float t = 1.5f; // Closer than both
+    EXPECT_EQ(soa.intersect(ray, 0, 2, 0.001f, t), -1);
+    EXPECT_FLOAT_EQ(t, 1.5f);
+
+    // Starting inside the first sphere returns its exit point
+    Ray inside{Point3{0, 0, 3}, Vec3{0, 0, 1}};
+    t = 100.0f;
+    EXPECT_EQ(soa.intersect(inside, 0, 2, 0.001f, t), 0);
+    EXPECT_FLOAT_EQ(t, 1.0f);
+}
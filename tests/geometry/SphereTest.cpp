@@ -94,3 +94,27 @@ TEST(SphereTest, RejectsSelfIntersection) {
 
     EXPECT_FALSE(sphereHit(sphere, record, ray, 0.001, 100.0));
 }
+
+TEST(SphereTest, OccludesMatchesHit) {
+    Sphere sphere{Vec3{0, 0, 0}, 1.0, 0};
+    Ray ray{Vec3{-5, 0, 0}, Vec3{1, 0, 0}};
+
+    EXPECT_TRUE(sphereOccludes(sphere, ray, 0.0, 100.0));
+    EXPECT_TRUE(sphereOccludes(sphere, ray, 5.0, 100.0));  // Exit point at t = 6
+    EXPECT_FALSE(sphereOccludes(sphere, ray, 0.0, 3.0));   // Stops short of the sphere
+    EXPECT_FALSE(sphereOccludes(sphere, Ray{Vec3{-5, 5, 0}, Vec3{1, 0, 0}}, 0.0, 100.0));
+}
+
+TEST(SphereTest, IntersectOnlyLowersTClosest) {
+    Sphere sphere{Vec3{0, 0, 0}, 1.0, 0};
+    Ray ray{Vec3{-5, 0, 0}, Vec3{1, 0, 0}};
+
+    float tClosest = 100.0f;
+    EXPECT_TRUE(sphereIntersect(sphere, ray, 0.001f, tClosest));
+    EXPECT_FLOAT_EQ(tClosest, 4.0f);
+
+    // Already closer than the sphere: no hit, tClosest untouched
+    tClosest = 3.0f;
+    EXPECT_FALSE(sphereIntersect(sphere, ray, 0.001f, tClosest));
+    EXPECT_FLOAT_EQ(tClosest, 3.0f);
+}
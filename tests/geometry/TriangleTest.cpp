@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "geometry/Triangle.h"
+#include "geometry/TriangleSoA.h"
+#include "core/HitRecord.h"
+#include "core/Ray.h"
+#include "util/RNG.h"
+
+// Unit right triangle in the z = 0 plane, counterclockwise seen from +z
+static const Point3 P0{0, 0, 0}, P1{1, 0, 0}, P2{0, 1, 0};
+
+TEST(TriangleTest, RayHitsInsideTriangle) {
+    Ray ray{Point3{0.25f, 0.25f, 5}, Vec3{0, 0, -1}};
+
+    float t = 100.0f;
+    ASSERT_TRUE(triangleIntersect(P0, P1, P2, ray, 0.001f, t));
+    EXPECT_FLOAT_EQ(t, 5.0f);
+
+    HitRecord record;
+    triangleHitRecord(P0, P1, P2, 3, record, ray, t);
+    EXPECT_EQ(record.position, Vec3(0.25f, 0.25f, 0));
+    EXPECT_EQ(record.normal, Vec3(0, 0, 1));
+    EXPECT_TRUE(record.frontFace);
+    EXPECT_EQ(record.materialIndex, 3);
+}
+
+TEST(TriangleTest, BackFaceIsHitWithFlippedNormal) {
+    Ray ray{Point3{0.25f, 0.25f, -5}, Vec3{0, 0, 1}};
+
+    float t = 100.0f;
+    ASSERT_TRUE(triangleIntersect(P0, P1, P2, ray, 0.001f, t));
+
+    HitRecord record;
+    triangleHitRecord(P0, P1, P2, 0, record, ray, t);
+    EXPECT_EQ(record.normal, Vec3(0, 0, -1));
+    EXPECT_FALSE(record.frontFace);
+}
+
+TEST(TriangleTest, MissesOutsideParallelAndBeyondTMax) {
+    float t = 100.0f;
+    EXPECT_FALSE(triangleIntersect(P0, P1, P2, Ray{Point3{0.6f, 0.6f, 5}, Vec3{0, 0, -1}}, 0.001f, t));
+    EXPECT_FALSE(triangleIntersect(P0, P1, P2, Ray{Point3{-0.1f, 0.5f, 5}, Vec3{0, 0, -1}}, 0.001f, t));
+    EXPECT_FALSE(triangleIntersect(P0, P1, P2, Ray{Point3{-1, 0.2f, 0}, Vec3{1, 0, 0}}, 0.001f, t));
+    EXPECT_FLOAT_EQ(t, 100.0f);
+
+    t = 4.0f;
+    EXPECT_FALSE(triangleIntersect(P0, P1, P2, Ray{Point3{0.25f, 0.25f, 5}, Vec3{0, 0, -1}}, 0.001f, t));
+    EXPECT_FALSE(triangleOccludes(P0, P1, P2, Ray{Point3{0.25f, 0.25f, 5}, Vec3{0, 0, -1}}, 0.001f, 4.0f));
+    EXPECT_TRUE(triangleOccludes(P0, P1, P2, Ray{Point3{0.25f, 0.25f, 5}, Vec3{0, 0, -1}}, 0.001f, 6.0f));
+}
+
+TEST(TriangleTest, BoundsCoverVertices) {
+    AABB box = triangleBounds(Point3{1, -2, 3}, Point3{-1, 4, 3}, Point3{0, 0, -5});
+    EXPECT_EQ(box.min, Vec3(-1, -2, -5));
+    EXPECT_EQ(box.max, Vec3(1, 4, 3));
+}
+
+TEST(TriangleTest, SoAKernelMatchesScalar) {
+    RNG rng(11);
+    struct Corners { Point3 p0, p1, p2; };
+    std::vector<Corners> triangles;
+    for (int i = 0; i < 29; ++i) {
+        Point3 center{rng.uniform(-4, 4), rng.uniform(-4, 4), rng.uniform(-4, 4)};
+        auto corner = [&] { return center + Vec3{rng.uniform(-1.5f, 1.5f), rng.uniform(-1.5f, 1.5f), rng.uniform(-1.5f, 1.5f)}; };
+        triangles.push_back({corner(), corner(), corner()});
+    }
+
+    // One empty slot in the middle, as a sphere would leave in a mixed leaf
+    TriangleSoA soa;
+    soa.resize(triangles.size());
+    for (size_t i = 0; i < triangles.size(); ++i)
+        soa.set(i, triangles[i].p0, triangles[i].p1, triangles[i].p2);
+    soa.setEmpty(12);
+
+    const int ranges[][2] = {{0, 1}, {0, 8}, {3, 5}, {9, 11}, {8, 16}, {25, 4}, {0, 29}};
+    int hits = 0;
+    for (int r = 0; r < 2000; ++r) {
+        Point3 origin{rng.uniform(-8, 8), rng.uniform(-8, 8), rng.uniform(-8, 8)};
+        Point3 target{rng.uniform(-4, 4), rng.uniform(-4, 4), rng.uniform(-4, 4)};
+        Ray ray{origin, (target - origin).normalized()};
+
+        for (const auto& range : ranges) {
+            float expectedT = 100.0f;
+            int expected = -1;
+            for (int i = range[0]; i < range[0] + range[1]; ++i) {
+                if (i != 12 && triangleIntersect(triangles[i].p0, triangles[i].p1, triangles[i].p2, ray, 0.001f, expectedT))
+                    expected = i;
+            }
+
+            float t = 100.0f;
+            int slot = soa.intersect(ray, range[0], range[1], 0.001f, t);
+
+            // Edge hits may round differently with fused multiply-adds, so compare distances first
+            EXPECT_EQ(slot >= 0, expected >= 0);
+            EXPECT_EQ(soa.occludes(ray, range[0], range[1], 0.001f, 100.0f), slot >= 0);
+            if (slot >= 0 && expected >= 0) {
+                EXPECT_NEAR(t, expectedT, 1e-4f * expectedT);
+                hits++;
+            }
+        }
+    }
+    EXPECT_GT(hits, 1000);
+}
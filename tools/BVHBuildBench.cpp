@@ -0,0 +1,64 @@
+#include "accel/BVH.h"
+#include "renderer/Scene.h"
+#include "util/Parallel.h"
+#include "util/RNG.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * bvh_build_bench - Times BVHTree::build on a random sphere scene for increasing thread counts
+ * and reports the speedup over a single-threaded build.
+ *
+ * Usage: bvh_build_bench [sphereCount = 2000000] [repeats = 3] [sah | median | lbvh]
+ */
+int main(int argc, char** argv) {
+    using namespace std::chrono;
+
+    int sphereCount = argc > 1 ? std::atoi(argv[1]) : 2000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+    std::string methodName = argc > 3 ? argv[3] : "sah";
+    BVHBuildMethod method = methodName == "median" ? BVHBuildMethod::Median
+                          : methodName == "lbvh"   ? BVHBuildMethod::LBVH
+                          : BVHBuildMethod::SAH;
+
+    Scene scene;
+    int material = scene.addDiffuse(Color(0.5f));
+    RNG rng{42};
+    for (int i = 0; i < sphereCount; ++i) {
+        Point3 center{rng.uniform(-1000.0f, 1000.0f), rng.uniform(-50.0f, 50.0f), rng.uniform(-1000.0f, 1000.0f)};
+        scene.addSphere(center, rng.uniform(0.1f, 2.0f), material);
+    }
+
+    int maxThreads = resolveThreadCount(0);
+    std::cout << sphereCount << " spheres, " << methodName
+              << " build, best of " << repeats << ", up to " << maxThreads << " threads" << std::endl;
+
+    // Powers of two below maxThreads, then maxThreads itself
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    double serialMs = 0.0;
+    for (int threads : threadCounts) {
+        double bestMs = INFINITY;
+        BVHTree tree;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = high_resolution_clock::now();
+            tree.build(scene, {.method = method, .threadCount = threads});
+            bestMs = std::min(bestMs, duration<double, std::milli>(high_resolution_clock::now() - start).count());
+        }
+        if (threads == 1) serialMs = bestMs;
+
+        std::cout << std::setw(4) << threads << " threads: "
+                  << std::fixed << std::setprecision(1) << std::setw(9) << bestMs << " ms  "
+                  << std::setprecision(2) << serialMs / bestMs << "x  "
+                  << tree.getNodes().size() << " nodes" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
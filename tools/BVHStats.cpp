@@ -0,0 +1,208 @@
+#include "accel/BVH.h"
+#include "accel/QuantizedBVH.h"
+#include "accel/WideBVH.h"
+#include "renderer/Camera.h"
+#include "renderer/Scene.h"
+#include "util/RNG.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * bvh_stats - Reports the structure and traversal cost of a BVH built over a sphere scene:
+ * node counts, leaf size and depth histograms, SAH cost, sibling overlap, memory footprint per layout,
+ * and average nodes visited / primitives tested per ray for camera and random rays.
+ *
+ * The scene is a large ground sphere with clusters of small spheres on it, similar to main.cpp but scalable.
+ *
+ * Usage: bvh_stats [sphereCount = 100000] [sah | median | lbvh] [maxLeafSize = 4] [cameraRays = 100000] [randomRays = 100000]
+ */
+
+struct TreeStats {
+    size_t interiorNodes = 0;
+    size_t leafNodes = 0;
+    std::map<int, size_t> leafSizes;
+    std::map<int, size_t> leafDepths;
+    double overlapArea = 0.0;     // Sum of sibling box intersection areas
+    double relativeOverlap = 0.0; // Sum of intersection area / parent area, for the average
+    double leafOverlapArea = 0.0; // Same, restricted to sibling pairs of leaves
+    size_t leafPairs = 0;
+};
+
+static float intersectionArea(const AABB& a, const AABB& b) {
+    AABB overlap{
+        Vec3{std::max(a.min.x, b.min.x), std::max(a.min.y, b.min.y), std::max(a.min.z, b.min.z)},
+        Vec3{std::min(a.max.x, b.max.x), std::min(a.max.y, b.max.y), std::min(a.max.z, b.max.z)}
+    };
+    for (int axis = 0; axis < 3; ++axis)
+        if (overlap.min[axis] > overlap.max[axis]) return 0.0f;
+    return overlap.surfaceArea();
+}
+
+static TreeStats collectStats(const BVHTree& tree) {
+    TreeStats stats;
+    const auto& nodes = tree.getNodes();
+    if (nodes.empty()) return stats;
+
+    std::vector<std::pair<int, int>> stack{{0, 0}}; // Node, depth
+    while (!stack.empty()) {
+        auto [index, depth] = stack.back();
+        stack.pop_back();
+        const BVHNode& node = nodes[index];
+
+        if (node.isLeaf()) {
+            stats.leafNodes++;
+            stats.leafSizes[node.primitiveCount]++;
+            stats.leafDepths[depth]++;
+            continue;
+        }
+
+        stats.interiorNodes++;
+        const BVHNode& left = nodes[node.left()];
+        const BVHNode& right = nodes[node.right()];
+        float area = intersectionArea(left.box, right.box);
+        stats.overlapArea += area;
+        if (node.box.surfaceArea() > 0.0f) stats.relativeOverlap += area / node.box.surfaceArea();
+        if (left.isLeaf() && right.isLeaf()) {
+            stats.leafOverlapArea += area;
+            stats.leafPairs++;
+        }
+
+        stack.push_back({node.left(), depth + 1});
+        stack.push_back({node.right(), depth + 1});
+    }
+    return stats;
+}
+
+static void printHistogram(const std::string& title, const std::map<int, size_t>& histogram, size_t total) {
+    std::cout << title << std::endl;
+    for (auto [value, count] : histogram) {
+        double share = 100.0 * count / total;
+        std::cout << "  " << std::setw(4) << value << ": " << std::setw(9) << count << "  "
+                  << std::fixed << std::setprecision(1) << std::setw(5) << share << "%  "
+                  << std::string(static_cast<size_t>(share / 2), '#') << std::endl;
+    }
+}
+
+template <typename Tree>
+static void traceRays(const char* name, const Scene& scene, const Tree& tree, const std::vector<Ray>& rays) {
+    TraversalStats stats;
+    size_t hits = 0;
+    for (const Ray& ray : rays) {
+        HitRecord record;
+        hits += tree.hit(scene, record, TraversalRay{ray}, 0.001f, INFINITY, &stats);
+    }
+
+    double n = static_cast<double>(rays.size());
+    std::cout << "  " << std::left << std::setw(11) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(9) << stats.nodesVisited / n << " nodes/ray "
+              << std::setw(8) << stats.primitivesTested / n << " prims/ray "
+              << std::setw(6) << std::setprecision(1) << 100.0 * hits / n << "% hit" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    int sphereCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::string methodName = argc > 2 ? argv[2] : "sah";
+    int maxLeafSize = argc > 3 ? std::atoi(argv[3]) : 4;
+    int cameraRayCount = argc > 4 ? std::atoi(argv[4]) : 100000;
+    int randomRayCount = argc > 5 ? std::atoi(argv[5]) : 100000;
+
+    BVHBuildMethod method = methodName == "median" ? BVHBuildMethod::Median
+                          : methodName == "lbvh"   ? BVHBuildMethod::LBVH
+                          : BVHBuildMethod::SAH;
+
+    // Scene: ground sphere plus clusters of props spread over a field that grows with the sphere count
+    Scene scene;
+    int material = scene.addDiffuse(Color(0.5f));
+    scene.addSphere(Point3(0.0f, -1000.0f, 0.0f), 1000.0f, material);
+
+    RNG rng{42};
+    float field = 10.0f * std::sqrt(static_cast<float>(sphereCount) / 100.0f);
+    int clusterCount = std::max(1, sphereCount / 200);
+    std::vector<Point3> clusters(clusterCount);
+    for (Point3& cluster : clusters)
+        cluster = Point3(rng.uniform(-field, field), 0.0f, rng.uniform(-field, field));
+
+    for (int i = 0; i < sphereCount; ++i) {
+        const Point3& cluster = clusters[rng.uniformInt(0, clusterCount)];
+        float radius = rng.uniform(0.1f, 0.5f);
+        Point3 center = cluster + Vec3(rng.uniform(-8.0f, 8.0f), 0.0f, rng.uniform(-8.0f, 8.0f));
+        center.y = radius + rng.uniform(0.0f, 2.0f);
+        scene.addSphere(center, radius, material);
+    }
+
+    BVHBuildOptions options{.method = method, .maxLeafSize = maxLeafSize};
+    scene.build(options, Scene::BVHLayout::Binary);
+    const BVHTree& tree = scene.getBVH();
+
+    // Structure
+    TreeStats stats = collectStats(tree);
+    size_t primitiveCount = tree.getPrimitiveIndices().size();
+    float rootArea = tree.boundingBox().surfaceArea();
+
+    std::cout << primitiveCount << " primitives, " << methodName << " build, max leaf size " << maxLeafSize << std::endl;
+    std::cout << "Nodes: " << tree.getNodes().size() << " (" << stats.interiorNodes << " interior, "
+              << stats.leafNodes << " leaves, " << std::fixed << std::setprecision(2)
+              << static_cast<double>(primitiveCount) / std::max<size_t>(stats.leafNodes, 1) << " primitives/leaf)" << std::endl;
+    std::cout << "SAH cost: " << tree.sahCost() << std::endl;
+    std::cout << "Sibling overlap: total " << std::setprecision(3) << stats.overlapArea / rootArea
+              << " of root area, average " << stats.relativeOverlap / std::max<size_t>(stats.interiorNodes, 1)
+              << " of parent area" << std::endl;
+    std::cout << "Leaf overlap: total " << stats.leafOverlapArea / rootArea << " of root area over "
+              << stats.leafPairs << " leaf pairs, average "
+              << stats.leafOverlapArea / rootArea / std::max<size_t>(stats.leafPairs, 1) << std::endl;
+
+    printHistogram("Leaf sizes:", stats.leafSizes, stats.leafNodes);
+    printHistogram("Leaf depths:", stats.leafDepths, stats.leafNodes);
+
+    // Memory per layout
+    BVH4 bvh4;
+    bvh4.build(tree);
+    BVH8 bvh8;
+    bvh8.build(tree);
+    QuantizedBVH quantized;
+    quantized.build(tree);
+
+    size_t indexBytes = primitiveCount * sizeof(int);
+    auto printMemory = [&](const char* name, size_t nodes, size_t nodeSize) {
+        std::cout << "  " << std::left << std::setw(11) << name << std::right << std::setw(9) << nodes << " nodes x "
+                  << std::setw(3) << nodeSize << " B + indices = " << std::fixed << std::setprecision(2)
+                  << (nodes * nodeSize + indexBytes) / (1024.0 * 1024.0) << " MiB" << std::endl;
+    };
+    std::cout << "Memory:" << std::endl;
+    printMemory("binary", tree.getNodes().size(), sizeof(BVHNode));
+    printMemory("BVH4", bvh4.getNodes().size(), sizeof(BVH4::Node));
+    printMemory("BVH8", bvh8.getNodes().size(), sizeof(BVH8::Node));
+    printMemory("quantized", quantized.getNodes().size(), sizeof(QuantizedBVH::Node));
+
+    // Traversal: primary rays from a camera above the field, and random rays through the scene bounds
+    std::vector<Ray> cameraRays;
+    cameraRays.reserve(cameraRayCount);
+    int width = 800, height = 600;
+    Camera camera{Point3(0.0f, 0.6f * field, 1.2f * field), Point3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), width, height, 50.0f};
+    for (int i = 0; i < cameraRayCount; ++i)
+        cameraRays.push_back(camera.shootRay(rng.uniformInt(0, width), rng.uniformInt(0, height), rng));
+
+    std::vector<Ray> randomRays;
+    randomRays.reserve(randomRayCount);
+    for (int i = 0; i < randomRayCount; ++i) {
+        Point3 origin(rng.uniform(-field, field), rng.uniform(0.0f, 3.0f), rng.uniform(-field, field));
+        Vec3 direction(rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f));
+        randomRays.push_back(Ray(origin, direction));
+    }
+
+    for (auto& [label, rays] : {std::pair{"Camera rays:", &cameraRays}, std::pair{"Random rays:", &randomRays}}) {
+        if (rays->empty()) continue;
+        std::cout << label << std::endl;
+        traceRays("binary", scene, tree, *rays);
+        traceRays("BVH4", scene, bvh4, *rays);
+        traceRays("BVH8", scene, bvh8, *rays);
+        traceRays("quantized", scene, quantized, *rays);
+    }
+
+    return EXIT_SUCCESS;
+}
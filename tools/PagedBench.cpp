@@ -0,0 +1,107 @@
+#include "renderer/Camera.h"
+#include "renderer/PagedGeometry.h"
+#include "renderer/Scene.h"
+#include "util/Parallel.h"
+#include "util/RNG.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * paged_bench - Traces camera frames through a point-cloud-like sphere set paged from disk and reports,
+ * per frame, trace time, page cache hit rate, bytes read and evictions. The same spheres are then traced
+ * in memory for comparison; pass in-memory = 0 to skip that and stay within the budget.
+ *
+ * The camera flies over a rolling terrain sampled by small spheres, so consecutive frames share most pages.
+ *
+ * Usage: paged_bench [sphereCount = 4000000] [budgetMiB = 64] [pageSpheres = 16384] [frames = 6] [in-memory = 1]
+ */
+
+static std::vector<Sphere> terrainSpheres(int count) {
+    RNG rng{7};
+    std::vector<Sphere> spheres;
+    spheres.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        float x = rng.uniform(-200.0f, 200.0f);
+        float z = rng.uniform(-200.0f, 200.0f);
+        float y = 3.0f * std::sin(x * 0.05f) * std::cos(z * 0.07f) + rng.uniform(-0.2f, 0.2f);
+        spheres.push_back({Point3{x, y, z}, 0.15f, 0});
+    }
+    return spheres;
+}
+
+// Traces one primary ray per pixel with every hardware thread; returns seconds
+static double traceFrame(const Scene& scene, const Camera& camera, int width, int height) {
+    auto start = std::chrono::steady_clock::now();
+    parallelTasks(height, resolveThreadCount(0), [&](size_t y) {
+        RNG rng{static_cast<uint32_t>(y)};
+        for (int x = 0; x < width; ++x) {
+            HitRecord record;
+            scene.intersect(record, camera.shootRay(x, static_cast<int>(y), rng), 0.001f, 1000.0f);
+        }
+    });
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int sphereCount = argc > 1 ? std::atoi(argv[1]) : 4000000;
+    size_t budget = (argc > 2 ? std::atoll(argv[2]) : 64) << 20;
+    int pageSpheres = argc > 3 ? std::atoi(argv[3]) : 16384;
+    int frames = argc > 4 ? std::atoi(argv[4]) : 6;
+    bool inMemory = argc > 5 ? std::atoi(argv[5]) != 0 : true;
+
+    const int width = 640, height = 360;
+    std::string path = (std::filesystem::temp_directory_path() / "paged_bench.pages").string();
+
+    std::vector<Sphere> spheres = terrainSpheres(sphereCount);
+    auto start = std::chrono::steady_clock::now();
+    if (!PagedGeometry::write(path, spheres, {.pageSpheres = pageSpheres, .pageBuild = {}})) return EXIT_FAILURE;
+    std::cout << "Wrote " << sphereCount << " spheres in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s, "
+              << std::filesystem::file_size(path) / (1024.0 * 1024.0) << " MiB on disk" << std::endl;
+
+    auto paged = std::make_shared<PagedGeometry>();
+    if (!paged->open(path, budget)) return EXIT_FAILURE;
+    std::cout << paged->pageCount() << " pages, budget " << (budget >> 20) << " MiB" << std::endl;
+
+    Scene pagedScene;
+    pagedScene.addDiffuse(Color(0.5f));
+    pagedScene.addPagedGeometry(paged);
+    pagedScene.build();
+
+    auto frameCamera = [&](int frame) {
+        Point3 from{-60.0f + 12.0f * frame, 25.0f, 60.0f};
+        return Camera{from, from + Vec3{20.0f, -18.0f, -40.0f}, Vec3{0, 1, 0}, width, height, 60.0f};
+    };
+
+    double pagedTotal = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        PageCacheStats before = paged->stats();
+        double seconds = traceFrame(pagedScene, frameCamera(frame), width, height);
+        PageCacheStats stats = paged->stats() - before;
+        pagedTotal += seconds;
+        std::cout << "Frame " << frame << ": " << seconds * 1000.0 << " ms, hit rate " << 100.0 * stats.hitRate()
+                  << "%, " << stats.bytesRead / (1024.0 * 1024.0) << " MiB read, " << stats.evictions
+                  << " evictions, " << (paged->residentBytes() >> 20) << " MiB resident" << std::endl;
+    }
+
+    if (inMemory) {
+        Scene memoryScene;
+        memoryScene.addDiffuse(Color(0.5f));
+        for (const Sphere& s : spheres) memoryScene.addSphere(s.center, s.radius, s.materialIndex);
+        memoryScene.build();
+
+        double memoryTotal = 0.0;
+        for (int frame = 0; frame < frames; ++frame)
+            memoryTotal += traceFrame(memoryScene, frameCamera(frame), width, height);
+        std::cout << "Paged " << pagedTotal * 1000.0 << " ms, in memory " << memoryTotal * 1000.0 << " ms" << std::endl;
+    }
+
+    std::filesystem::remove(path);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,35 @@
+#include "renderer/SceneFile.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+/**
+ * scene_convert - Converts a text scene description into the binary scene file format,
+ * then loads the result back to check it and report the load time.
+ *
+ * Usage: scene_convert input.txt output.rtscene
+ */
+int main(int argc, char** argv) {
+    using namespace std::chrono;
+
+    if (argc != 3) {
+        std::cerr << "Usage: scene_convert input.txt output.rtscene" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Scene scene;
+    CameraSettings camera;
+    if (!SceneFile::loadText(argv[1], scene, camera)) return EXIT_FAILURE;
+    if (!SceneFile::save(argv[2], scene, camera)) return EXIT_FAILURE;
+
+    auto start = steady_clock::now();
+    Scene loaded;
+    if (!SceneFile::load(argv[2], loaded, camera)) return EXIT_FAILURE;
+    double loadMs = duration<double, std::milli>(steady_clock::now() - start).count();
+
+    std::cout << "Wrote " << argv[2] << ": " << loaded.getMaterials().size() << " materials, "
+              << loaded.getSpheres().size() << " spheres, " << loaded.getPlanes().size() << " planes"
+              << " (loads in " << loadMs << " ms)" << std::endl;
+    return EXIT_SUCCESS;
+}